@@ -0,0 +1,81 @@
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
+
+#include "bam_pwm.h"
+
+bam_pwm::bam_pwm (
+    mcp23s17 & gpio_x_,
+    const uint16_t pin_mask_,
+    const uint8_t bit_depth_
+) :
+    _gpio_x(gpio_x_),
+    _pin_mask(pin_mask_),
+    _bit_depth(( !bit_depth_ || bit_depth_ > MAX_BIT_DEPTH ) ? MAX_BIT_DEPTH : bit_depth_),
+    _bit_planes{ { 0 }, { 0 } },
+    _active_buffer(0),
+    _commit_pending(false),
+    _plane(0)
+{}
+
+void
+bam_pwm::analogWrite (
+    const uint8_t pin_,
+    const uint16_t duty_
+) {
+    if ( pin_ >= mcp23s17::PIN_COUNT ) { return; }
+    const uint16_t pin_mask(static_cast<uint16_t>(1) << pin_);
+    uint16_t * const staged_planes(_bit_planes[_active_buffer ^ 1]);
+
+    if ( !(_pin_mask & pin_mask) ) { return; }
+
+    // Decompose the duty cycle into its bit planes
+    for ( uint8_t bit = 0 ; bit < _bit_depth ; ++bit ) {
+        if ( (duty_ >> bit) & 0x01 ) {
+            staged_planes[bit] |= pin_mask;
+        } else {
+            staged_planes[bit] &= ~pin_mask;
+        }
+    }
+
+    return;
+}
+
+void
+bam_pwm::begin (
+    void
+) {
+    _gpio_x.pinModes(_pin_mask, mcp23s17::PinMode::OUTPUT);
+
+    return;
+}
+
+void
+bam_pwm::commit (
+    void
+) {
+    _commit_pending = true;
+
+    return;
+}
+
+uint16_t
+bam_pwm::update (
+    void
+) {
+    const uint8_t plane(_plane);
+
+    // Swap buffers at the frame boundary, then carry the presented planes into the staging buffer
+    if ( !plane && _commit_pending ) {
+        _active_buffer ^= 1;
+        for ( uint8_t bit = 0 ; bit < _bit_depth ; ++bit ) {
+            _bit_planes[_active_buffer ^ 1][bit] = _bit_planes[_active_buffer][bit];
+        }
+        _commit_pending = false;
+    }
+
+    _gpio_x.digitalWritePorts(_bit_planes[_active_buffer][plane], _pin_mask);
+    _plane = (( (plane + 1) < _bit_depth ) ? (plane + 1) : 0);
+
+    return (static_cast<uint16_t>(1) << plane);
+}
+
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
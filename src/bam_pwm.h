@@ -0,0 +1,111 @@
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
+
+#ifndef BAM_PWM_H
+#define BAM_PWM_H
+
+#include <cstdint>
+
+#include "mcp23s17.h"
+
+/// \brief Bit Angle Modulation (software PWM) on MCP23S17 outputs
+/// \detail Duty cycles are decomposed into bit planes, each plane being
+/// a 16-bit image of both ports. `update` latches one plane per call
+/// (see `mcp23s17::digitalWritePorts`), so the bus cost of a PWM frame
+/// scales with the bit depth rather than the number of pins.
+/// \n Duty cycles are staged in a back buffer and only take effect at
+/// the next frame boundary after `commit`, so updates never glitch.
+class bam_pwm {
+  public:
+    // Constructor and destructor method(s)
+
+    /// \brief Object Constructor
+    /// \param [in] gpio_x_ The expander driving the outputs
+    /// \param [in] pin_mask_ The pins participating in modulation
+    /// \param [in] bit_depth_ The resolution of each duty cycle (1-8 bits)
+    bam_pwm (
+        mcp23s17 & gpio_x_,
+        const uint16_t pin_mask_,
+        const uint8_t bit_depth_ = MAX_BIT_DEPTH
+    );
+
+    // Accessor method(s)
+
+    /// \brief The number of ticks in a complete PWM frame
+    /// \return (2 ^ bit depth) - 1
+    inline
+    uint16_t
+    getFrameLength (
+        void
+    ) const {
+        return ((static_cast<uint16_t>(1) << _bit_depth) - 1);
+    }
+
+    /// \brief Whether a commit is still waiting on a frame boundary
+    inline
+    bool
+    isCommitPending (
+        void
+    ) const {
+        return _commit_pending;
+    }
+
+    // Public instance variable(s)
+    static const uint8_t MAX_BIT_DEPTH = 8;
+
+    // Public method(s)
+
+    /// \brief Stage the duty cycle of a pin
+    /// \param [in] pin_ The number associated with the pin
+    /// \param [in] duty_ The duty cycle (0 => off, `getFrameLength()` => on)
+    /// \note Staged values take effect after `commit`
+    /// \note Staged values should not be modified while a commit is pending
+    void
+    analogWrite (
+        const uint8_t pin_,
+        const uint16_t duty_
+    );
+
+    /// \brief Configure the participating pins as outputs
+    void
+    begin (
+        void
+    );
+
+    /// \brief Present the staged duty cycles at the next frame boundary
+    void
+    commit (
+        void
+    );
+
+    /// \brief Latch the next bit plane
+    /// \return The number of ticks to wait before the next call
+    /// \note Intended to be called from a timer interrupt
+    uint16_t
+    update (
+        void
+    );
+
+  protected:
+    // Protected method(s)
+    inline
+    uint16_t const *
+    getBitPlanes (
+        const bool staged_
+    ) const {
+        return _bit_planes[_active_buffer ^ staged_];
+    }
+
+  private:
+    // Private instance variable(s)
+    mcp23s17 & _gpio_x;
+    const uint16_t _pin_mask;
+    const uint8_t _bit_depth;
+    uint16_t _bit_planes[2][MAX_BIT_DEPTH];
+    volatile uint8_t _active_buffer;
+    volatile bool _commit_pending;
+    uint8_t _plane;
+};
+
+#endif
+
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
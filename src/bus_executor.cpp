@@ -0,0 +1,199 @@
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
+
+#include "bus_executor.h"
+
+#if defined(MCP23S17_HOST)
+
+#include <chrono>
+
+#if defined(__linux__)
+  #include <pthread.h>
+  #include <sched.h>
+#endif
+
+namespace {
+
+uint64_t
+elapsedNs (
+    const std::chrono::steady_clock::time_point & start_
+) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count());
+}
+
+} // namespace
+
+bus_executor::bus_executor (
+    const Bus * const buses_,
+    const size_t count_
+) :
+    _lane{},
+    _bus_count(( count_ > MAX_BUSES ) ? MAX_BUSES : count_),
+    _busy(0),
+    _stop(false)
+{
+    for ( size_t bus = 0 ; bus < _bus_count ; ++bus ) {
+        Lane & lane(_lane[bus]);
+
+        lane.bus = buses_[bus];
+        if ( lane.bus.count > DEVICES_PER_BUS ) { lane.bus.count = DEVICES_PER_BUS; }
+        lane.worker = std::thread(&bus_executor::run, this, std::ref(lane));
+#if defined(__linux__)
+        // Pinning is best effort, an unavailable CPU leaves the worker unpinned
+        if ( lane.bus.cpu >= 0 && lane.bus.cpu < CPU_SETSIZE ) {
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET(lane.bus.cpu, &cpus);
+            ::pthread_setaffinity_np(lane.worker.native_handle(), sizeof(cpus), &cpus);
+        }
+#endif
+    }
+}
+
+bus_executor::~bus_executor (
+    void
+) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _started.notify_all();
+    for ( size_t bus = 0 ; bus < _bus_count ; ++bus ) { _lane[bus].worker.join(); }
+}
+
+uint64_t
+bus_executor::execute (
+    const Write * const writes_,
+    const size_t count_
+) {
+    // Split the batch into one sub-batch per bus, merging the writes to each device
+    for ( size_t i = 0 ; writes_ && i < count_ ; ++i ) {
+        const Write & write(writes_[i]);
+
+        if ( write.bus >= _bus_count || write.device >= _lane[write.bus].bus.count ) { continue; }
+        PendingWrite & pending(_lane[write.bus].pending[write.device]);
+        pending.values = ((pending.values & ~write.mask) | (write.values & write.mask));
+        pending.mask |= write.mask;
+    }
+
+    return dispatch();
+}
+
+bus_executor::Timing
+bus_executor::getTiming (
+    const size_t bus_
+) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    return (( bus_ < _bus_count ) ? _lane[bus_].timing : Timing{});
+}
+
+uint64_t
+bus_executor::writeImage (
+    const uint16_t * const image_,
+    const uint16_t * const masks_
+) {
+    size_t index(0);
+
+    if ( !image_ ) { return 0; }
+    for ( size_t bus = 0 ; bus < _bus_count ; ++bus ) {
+        for ( size_t device = 0 ; device < _lane[bus].bus.count ; ++device, ++index ) {
+            PendingWrite & pending(_lane[bus].pending[device]);
+            pending.values = image_[index];
+            pending.mask = (masks_ ? masks_[index] : 0xFFFF);
+        }
+    }
+
+    return dispatch();
+}
+
+uint64_t
+bus_executor::dispatch (
+    void
+) {
+    const std::chrono::steady_clock::time_point start(std::chrono::steady_clock::now());
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    // Only the buses with writes pending are woken
+    for ( size_t bus = 0 ; bus < _bus_count ; ++bus ) {
+        Lane & lane(_lane[bus]);
+
+        for ( size_t device = 0 ; device < lane.bus.count ; ++device ) {
+            if ( !lane.pending[device].mask ) { continue; }
+            lane.ready = true;
+            ++_busy;
+            break;
+        }
+    }
+    if ( !_busy ) { return 0; }
+
+    _started.notify_all();
+    _finished.wait(lock, [this](){ return !_busy; });
+
+    return elapsedNs(start);
+}
+
+uint32_t
+bus_executor::exchange (
+    Lane & lane_
+) {
+    bool in_flight[DEVICES_PER_BUS] = { false };
+    uint32_t refused(0);
+    bool waiting(true);
+
+    for ( size_t device = 0 ; device < lane_.bus.count ; ++device ) {
+        PendingWrite & pending(lane_.pending[device]);
+
+        if ( !pending.mask ) { continue; }
+        if ( lane_.bus.devices[device]->digitalWritePortsAsync(lane_.operations[device], pending.values, pending.mask) ) {
+            in_flight[device] = true;
+        } else {
+            ++refused;
+        }
+        pending.mask = 0x0000;
+    }
+
+    // The sub-batch is complete once every frame of the bus has been exchanged
+    while ( waiting ) {
+        if ( lane_.bus.transport ) { lane_.bus.transport->poll(); }
+        waiting = false;
+        for ( size_t device = 0 ; device < lane_.bus.count ; ++device ) {
+            if ( in_flight[device] && !lane_.operations[device].isComplete() ) { waiting = true; }
+        }
+        if ( waiting ) { std::this_thread::yield(); }
+    }
+
+    return refused;
+}
+
+void
+bus_executor::run (
+    Lane & lane_
+) {
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    for (;;) {
+        _started.wait(lock, [this, &lane_](){ return (_stop || lane_.ready); });
+        if ( !lane_.ready ) { break; }
+
+        // The pending writes belong to this worker until it reports completion, so the lock is released
+        lock.unlock();
+        const std::chrono::steady_clock::time_point start(std::chrono::steady_clock::now());
+        const uint32_t refused(exchange(lane_));
+        const uint64_t duration_ns(elapsedNs(start));
+        lock.lock();
+
+        lane_.timing.last_ns = duration_ns;
+        if ( duration_ns > lane_.timing.max_ns ) { lane_.timing.max_ns = duration_ns; }
+        lane_.timing.total_ns += duration_ns;
+        ++lane_.timing.batches;
+        lane_.timing.refused += refused;
+        lane_.ready = false;
+        if ( !--_busy ) { _finished.notify_one(); }
+    }
+
+    return;
+}
+
+#endif // MCP23S17_HOST
+
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
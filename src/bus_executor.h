@@ -0,0 +1,172 @@
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
+
+#ifndef BUS_EXECUTOR_H
+#define BUS_EXECUTOR_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "mcp23s17_async.h"
+#include "spi_transport.h"
+
+#if defined(MCP23S17_HOST)
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+/// \brief Drives independent SPI buses concurrently, one worker per bus
+/// \detail Each bus (a transport and the devices attached to it) is given
+/// its own worker thread. A batch of writes addressed to the whole system
+/// is split into one sub-batch per bus, the writes to each device are
+/// merged (later writes taking precedence pin by pin), and every bus
+/// exchanges its frames at the same time as the others. A batch therefore
+/// takes as long as its slowest bus, instead of the sum of all buses.
+/// The time each bus spent on its sub-batch is recorded (see `getTiming`).
+/// \note Devices must not be written by other threads while a batch runs
+/// \note Host platforms only
+class bus_executor {
+  public:
+    // Definition(s)
+
+    /// \brief An independent bus
+    struct Bus {
+        spi_transport * transport;  ///< The transport of the bus (polled by its worker)
+        mcp23s17_async * const * devices;  ///< The devices attached to the bus (using `transport`)
+        size_t count;  ///< The number of entries in `devices` (up to `DEVICES_PER_BUS`)
+        int cpu;  ///< The CPU the worker is pinned to (-1 for none, Linux only)
+    };
+
+    /// \brief Completion timing of a bus
+    struct Timing {
+        uint64_t last_ns;  ///< Duration of the most recent sub-batch
+        uint64_t max_ns;  ///< Longest sub-batch
+        uint64_t total_ns;  ///< Sum of every sub-batch
+        uint32_t batches;  ///< Sub-batches completed
+        uint32_t refused;  ///< Writes refused by the transport
+    };
+
+    /// \brief A write addressed to a device of a bus
+    struct Write {
+        uint8_t bus;  ///< The index of the bus
+        uint8_t device;  ///< The index of the device on the bus
+        uint16_t values;  ///< The latch values (see `mcp23s17::digitalWritePorts`)
+        uint16_t mask;  ///< The pins to be updated
+    };
+
+    // Public instance variable(s)
+    static const size_t DEVICES_PER_BUS = 8;  ///< Devices per bus (the devices sharing one chip select)
+    static const size_t MAX_BUSES = 4;  ///< Buses driven at once
+
+    // Constructor and destructor method(s)
+
+    /// \brief Object Constructor
+    /// \param [in] buses_ The buses, in system order
+    /// \param [in] count_ The number of entries in `buses_` (up to `MAX_BUSES`)
+    /// \note The workers are started, and pinned when requested
+    bus_executor (
+        const Bus * const buses_,
+        const size_t count_
+    );
+
+    /// \brief Object Destructor
+    /// \note Waits for the workers to exit
+    ~bus_executor (
+        void
+    );
+
+    // Public method(s)
+
+    /// \brief Run a batch of writes, each bus on its own worker
+    /// \param [in] writes_ The writes (in any order)
+    /// \param [in] count_ The number of entries in `writes_`
+    /// \return The duration of the batch, from submission until the slowest
+    /// bus completed (nanoseconds)
+    /// \note Blocks until every bus has completed its sub-batch. Writes
+    /// addressed to an unknown bus or device are ignored.
+    /// \note Single caller only (as is `writeImage`)
+    uint64_t
+    execute (
+        const Write * const writes_,
+        const size_t count_
+    );
+
+    /// \brief The number of buses
+    inline
+    size_t
+    getBusCount (
+        void
+    ) const {
+        return _bus_count;
+    }
+
+    /// \brief The completion timing of a bus
+    /// \param [in] bus_ The index of the bus
+    Timing
+    getTiming (
+        const size_t bus_
+    ) const;
+
+    /// \brief Refresh the output image of the whole system
+    /// \param [in] image_ The latch values of every device, bus by bus in
+    /// system order (the devices of bus 0, then those of bus 1, ...)
+    /// \param [in] masks_ The pins to be updated on each device (nullptr
+    /// updates every pin)
+    /// \return The duration of the refresh (see `execute`)
+    uint64_t
+    writeImage (
+        const uint16_t * const image_,
+        const uint16_t * const masks_ = nullptr
+    );
+
+  private:
+    // Private definition(s)
+    struct PendingWrite {
+        uint16_t values;
+        uint16_t mask;
+    };
+
+    struct Lane {
+        Bus bus;
+        PendingWrite pending[DEVICES_PER_BUS];
+        mcp23s17_async::Operation operations[DEVICES_PER_BUS];
+        Timing timing;
+        bool ready;
+        std::thread worker;
+    };
+
+    // Private instance variable(s)
+    Lane _lane[MAX_BUSES];
+    const size_t _bus_count;
+    mutable std::mutex _mutex;
+    std::condition_variable _started;
+    std::condition_variable _finished;
+    size_t _busy;
+    bool _stop;
+
+    // Private method(s)
+
+    /// \brief Hand the pending writes to the workers, and wait for them
+    uint64_t
+    dispatch (
+        void
+    );
+
+    /// \brief Exchange the pending writes of a lane
+    /// \return The number of writes refused by the transport
+    uint32_t
+    exchange (
+        Lane & lane_
+    );
+
+    void
+    run (
+        Lane & lane_
+    );
+};
+
+#endif // MCP23S17_HOST
+
+#endif
+
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
@@ -0,0 +1,160 @@
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
+
+#include "command_queue.h"
+
+#if defined(MCP23S17_HOST)
+
+#include <chrono>
+
+command_queue::command_queue (
+    void
+) :
+    _enqueue_position(0),
+    _dequeue_position(0)
+{
+    for ( size_t i = 0 ; i < CAPACITY ; ++i ) {
+        _cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+bool
+command_queue::digitalWrite (
+    mcp23s17 & gpio_x_,
+    const uint8_t pin_,
+    const mcp23s17::PinLatchValue value_
+) {
+    if ( pin_ >= mcp23s17::PIN_COUNT ) { return false; }
+    return digitalWritePorts(gpio_x_, (( mcp23s17::PinLatchValue::HIGH == value_ ) ? 0xFFFF : 0x0000), (static_cast<uint16_t>(1) << pin_));
+}
+
+bool
+command_queue::digitalWritePorts (
+    mcp23s17 & gpio_x_,
+    const uint16_t values_,
+    const uint16_t mask_
+) {
+    const Command command{ &gpio_x_, values_, mask_ };
+
+    if ( !mask_ ) { return true; }
+    return push(command);
+}
+
+size_t
+command_queue::drain (
+    void
+) {
+    Command pending[DEVICE_COUNT];
+    size_t device_count(0);
+    size_t dequeued(0);
+    Command command;
+
+    for ( ; dequeued < CAPACITY && pop(command) ; ++dequeued ) {
+        size_t device(0);
+
+        while ( device < device_count && pending[device].gpio_x != command.gpio_x ) { ++device; }
+        if ( device == device_count ) {
+            // Make room by sending the oldest image
+            if ( device_count == DEVICE_COUNT ) {
+                pending[0].gpio_x->digitalWritePorts(pending[0].values, pending[0].mask);
+                for ( size_t i = 1 ; i < DEVICE_COUNT ; ++i ) { pending[i - 1] = pending[i]; }
+                device = --device_count;
+            }
+            pending[device] = Command{ command.gpio_x, 0x0000, 0x0000 };
+            ++device_count;
+        }
+
+        // Later writes take precedence, pin by pin
+        pending[device].values = ((pending[device].values & ~command.mask) | (command.values & command.mask));
+        pending[device].mask |= command.mask;
+    }
+
+    for ( size_t device = 0 ; device < device_count ; ++device ) {
+        pending[device].gpio_x->digitalWritePorts(pending[device].values, pending[device].mask);
+    }
+
+    return dequeued;
+}
+
+bool
+command_queue::pop (
+    Command & command_
+) {
+    Cell & cell(_cells[_dequeue_position & (CAPACITY - 1)]);
+    const size_t sequence(cell.sequence.load(std::memory_order_acquire));
+
+    // The cell has not been published by its producer yet
+    if ( sequence != (_dequeue_position + 1) ) { return false; }
+
+    command_ = cell.command;
+    cell.sequence.store((_dequeue_position + CAPACITY), std::memory_order_release);
+    ++_dequeue_position;
+
+    return true;
+}
+
+bool
+command_queue::push (
+    const Command & command_
+) {
+    size_t position(_enqueue_position.load(std::memory_order_relaxed));
+    Cell * cell;
+
+    // Claim a cell, whose sequence equals the position while it is free
+    for (;;) {
+        cell = &_cells[position & (CAPACITY - 1)];
+        const size_t sequence(cell->sequence.load(std::memory_order_acquire));
+        const intptr_t difference(static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position));
+
+        if ( !difference ) {
+            if ( _enqueue_position.compare_exchange_weak(position, (position + 1), std::memory_order_relaxed) ) { break; }
+        } else if ( difference < 0 ) {
+            return false;
+        } else {
+            position = _enqueue_position.load(std::memory_order_relaxed);
+        }
+    }
+
+    // Publish the command to the consumer
+    cell->command = command_;
+    cell->sequence.store((position + 1), std::memory_order_release);
+
+    return true;
+}
+
+bus_owner::bus_owner (
+    command_queue & queue_,
+    const uint32_t period_us_
+) :
+    _queue(queue_),
+    _period_us(period_us_),
+    _stop(false),
+    _worker(&bus_owner::run, this)
+{}
+
+bus_owner::~bus_owner (
+    void
+) {
+    _stop.store(true, std::memory_order_relaxed);
+    _worker.join();
+    _queue.drain();
+}
+
+void
+bus_owner::run (
+    void
+) {
+    while ( !_stop.load(std::memory_order_relaxed) ) {
+        _queue.drain();
+        if ( _period_us ) {
+            std::this_thread::sleep_for(std::chrono::microseconds(_period_us));
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    return;
+}
+
+#endif // MCP23S17_HOST
+
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
@@ -0,0 +1,137 @@
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
+
+#ifndef COMMAND_QUEUE_H
+#define COMMAND_QUEUE_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "mcp23s17.h"
+
+#if defined(MCP23S17_HOST)
+
+#include <atomic>
+#include <thread>
+
+/// \brief Lock-free queue of output writes, coalesced before transmission
+/// \detail Any number of producer threads queue writes without locking
+/// (a bounded ring with per-cell sequence numbers), and a single consumer
+/// (see `bus_owner`) drains them. Before anything is sent, the pending
+/// writes of each device are merged into a single image, with later writes
+/// taking precedence pin by pin. Fifty queued writes to GPIOA therefore
+/// become one frame carrying the final value, and bus traffic is bounded
+/// by the drain rate rather than by the producers.
+/// \note Host platforms only
+class command_queue {
+  public:
+    // Public instance variable(s)
+    static const size_t CAPACITY = 256;  ///< Writes that may be pending (a power of two)
+    static const size_t DEVICE_COUNT = 8;  ///< Devices coalesced at once (the devices sharing one chip select)
+
+    // Constructor and destructor method(s)
+    command_queue (
+        void
+    );
+
+    // Public method(s)
+
+    /// \brief Queue a pin write (see `mcp23s17::digitalWrite`)
+    /// \return false if the queue is full
+    /// \note Safe to call from any thread
+    bool
+    digitalWrite (
+        mcp23s17 & gpio_x_,
+        const uint8_t pin_,
+        const mcp23s17::PinLatchValue value_
+    );
+
+    /// \brief Queue a write of both ports (see `mcp23s17::digitalWritePorts`)
+    /// \return false if the queue is full
+    /// \note Safe to call from any thread
+    bool
+    digitalWritePorts (
+        mcp23s17 & gpio_x_,
+        const uint16_t values_,
+        const uint16_t mask_ = 0xFFFF
+    );
+
+    /// \brief Coalesce the pending writes, and send one write per device
+    /// \return The number of writes dequeued
+    /// \note Single consumer only. At most `CAPACITY` writes are dequeued
+    /// per call, so a drain always ends, even under sustained production.
+    size_t
+    drain (
+        void
+    );
+
+  private:
+    // Private definition(s)
+    struct Command {
+        mcp23s17 * gpio_x;
+        uint16_t values;
+        uint16_t mask;
+    };
+
+    struct Cell {
+        std::atomic<size_t> sequence;
+        Command command;
+    };
+
+    // Private instance variable(s)
+    Cell _cells[CAPACITY];
+    std::atomic<size_t> _enqueue_position;
+    size_t _dequeue_position;
+
+    // Private method(s)
+    bool
+    pop (
+        Command & command_
+    );
+
+    bool
+    push (
+        const Command & command_
+    );
+};
+
+/// \brief Thread owning the bus on behalf of the producers
+/// \detail Drains the queue, then waits for the period, so the bus carries
+/// at most one frame per device per period, however fast the producers.
+/// \note Host platforms only
+class bus_owner {
+  public:
+    // Constructor and destructor method(s)
+
+    /// \brief Object Constructor
+    /// \param [in] queue_ The queue to drain (this thread is its consumer)
+    /// \param [in] period_us_ The time between drains
+    bus_owner (
+        command_queue & queue_,
+        const uint32_t period_us_
+    );
+
+    /// \brief Object Destructor
+    /// \note The queue is drained once more before the thread exits
+    ~bus_owner (
+        void
+    );
+
+  private:
+    // Private instance variable(s)
+    command_queue & _queue;
+    const uint32_t _period_us;
+    std::atomic<bool> _stop;
+    std::thread _worker;
+
+    // Private method(s)
+    void
+    run (
+        void
+    );
+};
+
+#endif // MCP23S17_HOST
+
+#endif
+
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
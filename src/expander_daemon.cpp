@@ -0,0 +1,364 @@
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
+
+#include "expander_daemon.h"
+
+#if defined(MCP23S17_HOST) && defined(__linux__)
+
+#include <cstring>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+const size_t MAX_EPOLL_EVENTS = 8;
+
+} // namespace
+
+expander_daemon::expander_daemon (
+    mcp23s17 * const * const devices_,
+    const size_t count_
+) :
+    _device{ nullptr },
+    _client{},
+    _pending{},
+    _levels{},
+    _listen_fd(-1),
+    _epoll_fd(::epoll_create1(EPOLL_CLOEXEC)),
+    _wake_fd(::eventfd(0, (EFD_CLOEXEC | EFD_NONBLOCK))),
+    _stopping(false),
+    _path{}
+{
+    struct epoll_event registration;
+
+    for ( size_t device = 0 ; device < DEVICE_COUNT && devices_ && device < count_ ; ++device ) {
+        _device[device] = devices_[device];
+    }
+    for ( Client & client : _client ) { client.fd = -1; }
+
+    registration.events = EPOLLIN;
+    registration.data.fd = _wake_fd;
+    if ( _epoll_fd >= 0 && _wake_fd >= 0 ) { ::epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, _wake_fd, &registration); }
+}
+
+expander_daemon::~expander_daemon (
+    void
+) {
+    for ( Client & client : _client ) { disconnect(client); }
+    if ( _listen_fd >= 0 ) {
+        ::close(_listen_fd);
+        ::unlink(_path);
+    }
+    if ( _wake_fd >= 0 ) { ::close(_wake_fd); }
+    if ( _epoll_fd >= 0 ) { ::close(_epoll_fd); }
+}
+
+expander_daemon::Record
+expander_daemon::decode (
+    const uint8_t * const buffer_
+) {
+    return Record{
+        static_cast<Opcode>(buffer_[0]),
+        buffer_[1],
+        static_cast<uint16_t>(buffer_[2] | (buffer_[3] << 8)),
+        static_cast<uint16_t>(buffer_[4] | (buffer_[5] << 8)),
+    };
+}
+
+void
+expander_daemon::encode (
+    const Record & record_,
+    uint8_t * const buffer_
+) {
+    buffer_[0] = static_cast<uint8_t>(record_.opcode);
+    buffer_[1] = record_.device;
+    buffer_[2] = static_cast<uint8_t>(record_.values);
+    buffer_[3] = static_cast<uint8_t>(record_.values >> 8);
+    buffer_[4] = static_cast<uint8_t>(record_.mask);
+    buffer_[5] = static_cast<uint8_t>(record_.mask >> 8);
+
+    return;
+}
+
+bool
+expander_daemon::listen (
+    const char * const path_
+) {
+    struct sockaddr_un address;
+    struct epoll_event registration;
+
+    if ( !path_ || _listen_fd >= 0 || _epoll_fd < 0 ) { return false; }
+    if ( ::strlen(path_) >= sizeof(address.sun_path) ) { return false; }
+
+    ::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    ::strncpy(address.sun_path, path_, (sizeof(address.sun_path) - 1));
+    ::strncpy(_path, path_, (sizeof(_path) - 1));
+
+    _listen_fd = ::socket(AF_UNIX, (SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC), 0);
+    if ( _listen_fd < 0 ) { return false; }
+
+    ::unlink(path_);
+    registration.events = EPOLLIN;
+    registration.data.fd = _listen_fd;
+    if ( ::bind(_listen_fd, reinterpret_cast<struct sockaddr *>(&address), sizeof(address)) < 0
+      || ::listen(_listen_fd, static_cast<int>(MAX_CLIENTS)) < 0
+      || ::epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, _listen_fd, &registration) < 0
+    ) {
+        ::close(_listen_fd);
+        _listen_fd = -1;
+        return false;
+    }
+
+    return true;
+}
+
+void
+expander_daemon::run (
+    const int sample_period_ms_
+) {
+    while ( !_stopping ) { serviceOnce(sample_period_ms_); }
+    _stopping = false;
+
+    return;
+}
+
+size_t
+expander_daemon::serviceOnce (
+    const int timeout_ms_
+) {
+    struct epoll_event ready[MAX_EPOLL_EVENTS];
+    const int ready_count(::epoll_wait(_epoll_fd, ready, static_cast<int>(MAX_EPOLL_EVENTS), timeout_ms_));
+    size_t served(0);
+
+    for ( int i = 0 ; i < ready_count ; ++i ) {
+        const int fd(ready[i].data.fd);
+
+        if ( fd == _wake_fd ) {
+            uint64_t counter;
+            (void)::read(_wake_fd, &counter, sizeof(counter));
+            _stopping = true;
+        } else if ( fd == _listen_fd ) {
+            accept();
+        } else {
+            for ( Client & client : _client ) {
+                if ( client.fd != fd ) { continue; }
+                served += serve(client);
+                break;
+            }
+        }
+    }
+
+    // Writes from every client are merged, so each device receives at most one frame per iteration
+    for ( uint8_t device = 0 ; device < DEVICE_COUNT ; ++device ) { flushWrites(device); }
+    sampleInputs();
+
+    return served;
+}
+
+void
+expander_daemon::stop (
+    void
+) {
+    const uint64_t increment(1);
+
+    (void)::write(_wake_fd, &increment, sizeof(increment));
+
+    return;
+}
+
+void
+expander_daemon::accept (
+    void
+) {
+    // Drain the backlog, so one wake-up admits every waiting client
+    for ( int fd ; (fd = ::accept4(_listen_fd, nullptr, nullptr, (SOCK_NONBLOCK | SOCK_CLOEXEC))) >= 0 ; ) {
+        struct epoll_event registration;
+        bool admitted(false);
+
+        registration.events = EPOLLIN;
+        registration.data.fd = fd;
+        for ( Client & client : _client ) {
+            if ( client.fd >= 0 ) { continue; }
+            if ( ::epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, fd, &registration) < 0 ) { break; }
+            client.fd = fd;
+            for ( uint16_t & subscription : client.subscription ) { subscription = 0x0000; }
+            admitted = true;
+            break;
+        }
+
+        // Every slot is taken
+        if ( !admitted ) { ::close(fd); }
+    }
+
+    return;
+}
+
+void
+expander_daemon::disconnect (
+    Client & client_
+) {
+    if ( client_.fd < 0 ) { return; }
+
+    ::epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, client_.fd, nullptr);
+    ::close(client_.fd);
+    client_.fd = -1;
+    for ( uint16_t & subscription : client_.subscription ) { subscription = 0x0000; }
+
+    return;
+}
+
+void
+expander_daemon::flushWrites (
+    const uint8_t device_
+) {
+    PendingWrite & pending(_pending[device_]);
+
+    if ( !pending.mask ) { return; }
+    _device[device_]->digitalWritePorts(pending.values, pending.mask);
+    pending.mask = 0x0000;
+
+    return;
+}
+
+bool
+expander_daemon::send (
+    Client & client_,
+    const uint8_t * const buffer_,
+    const size_t length_
+) {
+    // A client that cannot keep up with its responses is disconnected, rather than stalling the others
+    if ( ::send(client_.fd, buffer_, length_, (MSG_DONTWAIT | MSG_NOSIGNAL)) != static_cast<ssize_t>(length_) ) {
+        disconnect(client_);
+        return false;
+    }
+
+    return true;
+}
+
+size_t
+expander_daemon::serve (
+    Client & client_
+) {
+    uint8_t request[(MAX_BATCH * RECORD_SIZE) + 1];
+    uint8_t response[MAX_BATCH * RECORD_SIZE];
+    size_t response_length(0);
+    size_t served(0);
+    const ssize_t length(::recv(client_.fd, request, sizeof(request), MSG_DONTWAIT));
+
+    if ( length <= 0 ) {
+        disconnect(client_);
+        return 0;
+    }
+
+    // Only whole records are served, and a batch may not exceed `MAX_BATCH` records
+    if ( static_cast<size_t>(length) > (MAX_BATCH * RECORD_SIZE) || (length % RECORD_SIZE) ) {
+        const Record error{ Opcode::ERROR, 0, 0x0000, 0x0000 };
+        encode(error, response);
+        send(client_, response, RECORD_SIZE);
+        return 0;
+    }
+
+    for ( size_t offset = 0 ; offset < static_cast<size_t>(length) ; offset += RECORD_SIZE ) {
+        if ( serveRecord(client_, decode(request + offset), response, response_length) ) { ++served; }
+    }
+    if ( response_length ) { send(client_, response, response_length); }
+
+    return served;
+}
+
+bool
+expander_daemon::serveRecord (
+    Client & client_,
+    const Record & record_,
+    uint8_t * const response_,
+    size_t & response_length_
+) {
+    Record response(record_);
+    mcp23s17 * const gpio_x(( record_.device < DEVICE_COUNT ) ? _device[record_.device] : nullptr);
+
+    if ( gpio_x ) {
+        switch ( record_.opcode ) {
+          case Opcode::READ:
+            // A read observes every write queued before it
+            flushWrites(record_.device);
+            response.values = (gpio_x->digitalReadPorts(record_.mask) & record_.mask);
+            encode(response, (response_ + response_length_));
+            response_length_ += RECORD_SIZE;
+            return true;
+          case Opcode::WRITE:
+            _pending[record_.device].values = ((_pending[record_.device].values & ~record_.mask) | (record_.values & record_.mask));
+            _pending[record_.device].mask |= record_.mask;
+            return true;
+          case Opcode::PIN_MODES:
+            if ( (record_.values & 0x00FF) > static_cast<uint8_t>(mcp23s17::PinMode::INPUT_PULLUP) ) { break; }
+            flushWrites(record_.device);
+            gpio_x->pinModes(record_.mask, static_cast<mcp23s17::PinMode>(record_.values & 0x00FF));
+            return true;
+          case Opcode::SUBSCRIBE:
+            // The levels at the time of subscription are the baseline of the new pins only, so changes not yet sampled still reach the other subscribers
+            if ( record_.mask & ~subscribedPins(record_.device) ) {
+                const uint16_t new_pins(record_.mask & ~subscribedPins(record_.device));
+                _levels[record_.device] = ((_levels[record_.device] & ~new_pins) | (gpio_x->digitalReadPorts() & new_pins));
+            }
+            client_.subscription[record_.device] = record_.mask;
+            return true;
+          default:
+            break;
+        }
+    }
+
+    response.opcode = Opcode::ERROR;
+    encode(response, (response_ + response_length_));
+    response_length_ += RECORD_SIZE;
+
+    return false;
+}
+
+void
+expander_daemon::sampleInputs (
+    void
+) {
+    for ( uint8_t device = 0 ; device < DEVICE_COUNT ; ++device ) {
+        const uint16_t subscribed(subscribedPins(device));
+
+        if ( !subscribed || !_device[device] ) { continue; }
+
+        const uint16_t levels(_device[device]->digitalReadPorts());
+        const uint16_t changed((levels ^ _levels[device]) & subscribed);
+        _levels[device] = levels;
+        if ( !changed ) { continue; }
+
+        // Fan out to each subscriber of a pin that changed
+        for ( Client & client : _client ) {
+            uint8_t event[RECORD_SIZE];
+
+            if ( client.fd < 0 || !(client.subscription[device] & changed) ) { continue; }
+            encode(Record{ Opcode::EVENT, device, levels, static_cast<uint16_t>(client.subscription[device] & changed) }, event);
+            send(client, event, RECORD_SIZE);
+        }
+    }
+
+    return;
+}
+
+uint16_t
+expander_daemon::subscribedPins (
+    const uint8_t device_
+) const {
+    uint16_t subscribed(0x0000);
+
+    for ( const Client & client : _client ) {
+        if ( client.fd < 0 ) { continue; }
+        subscribed |= client.subscription[device_];
+    }
+
+    return subscribed;
+}
+
+#endif // MCP23S17_HOST && __linux__
+
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
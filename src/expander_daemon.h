@@ -0,0 +1,205 @@
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
+
+#ifndef EXPANDER_DAEMON_H
+#define EXPANDER_DAEMON_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "mcp23s17.h"
+
+#if defined(MCP23S17_HOST) && defined(__linux__)
+
+/// \brief Serves a set of expanders to many client processes
+/// \detail One process owns the devices (and so the register caches),
+/// and clients exchange batches of fixed-size records with it over a Unix
+/// domain socket (SOCK_SEQPACKET, so each message is one whole batch).
+/// Writes from every client are merged per device and sent once per loop
+/// iteration, a read sees every write that preceded it, and the inputs of
+/// subscribed pins are sampled each iteration, with changes fanned out to
+/// every subscriber.
+///
+/// Each record is 6 bytes: opcode, device, values (little-endian) and
+/// mask (little-endian).
+/// - `READ`: answered with `READ`, carrying the levels of the masked pins
+/// - `WRITE`: the masked pins take the given values (not answered)
+/// - `PIN_MODES`: the masked pins take the `mcp23s17::PinMode` given in
+///   the low byte of the values (not answered)
+/// - `SUBSCRIBE`: replace the subscription of the client to the device
+///   with the mask (not answered)
+/// - `EVENT`: sent by the daemon, carrying the levels of the device, and
+///   the subscribed pins that changed in the mask
+/// - `ERROR`: answers a record that could not be served (echoes it)
+/// \note The loop is single threaded, only `stop` may be called from
+/// other threads
+/// \note `test/expander_daemon_simulator.cpp` runs the daemon standalone,
+/// against simulated devices
+/// \note Host (Linux) platforms only
+class expander_daemon {
+  public:
+    // Definition(s)
+    enum class Opcode : uint8_t {
+        READ = 0x01,
+        WRITE = 0x02,
+        PIN_MODES = 0x03,
+        SUBSCRIBE = 0x04,
+        EVENT = 0x81,
+        ERROR = 0xFF,
+    };
+
+    /// \brief A protocol record
+    struct Record {
+        Opcode opcode;
+        uint8_t device;
+        uint16_t values;
+        uint16_t mask;
+    };
+
+    // Public instance variable(s)
+    static const size_t DEVICE_COUNT = 8;  ///< Devices served
+    static const size_t MAX_BATCH = 64;  ///< Records per message
+    static const size_t MAX_CLIENTS = 16;  ///< Clients connected at once
+    static const size_t RECORD_SIZE = 6;  ///< Bytes per encoded record
+
+    // Constructor and destructor method(s)
+
+    /// \brief Object Constructor
+    /// \param [in] devices_ The device served at each index (nullptr
+    /// where no device is present)
+    /// \param [in] count_ The number of entries in `devices_` (1-8)
+    expander_daemon (
+        mcp23s17 * const * const devices_,
+        const size_t count_
+    );
+
+    /// \brief Object Destructor
+    /// \note Disconnects every client, and removes the socket
+    ~expander_daemon (
+        void
+    );
+
+    // Public method(s)
+
+    /// \brief Decode a record
+    /// \param [in] buffer_ `RECORD_SIZE` bytes
+    static
+    Record
+    decode (
+        const uint8_t * const buffer_
+    );
+
+    /// \brief Encode a record
+    /// \param [in] record_ The record
+    /// \param [out] buffer_ `RECORD_SIZE` bytes
+    static
+    void
+    encode (
+        const Record & record_,
+        uint8_t * const buffer_
+    );
+
+    /// \brief Create the socket, and begin accepting clients
+    /// \param [in] path_ The filesystem path of the socket (replaced if present)
+    /// \return false if the socket could not be created
+    bool
+    listen (
+        const char * const path_
+    );
+
+    /// \brief Serve clients until `stop` is called
+    /// \param [in] sample_period_ms_ The longest time between input samples
+    void
+    run (
+        const int sample_period_ms_
+    );
+
+    /// \brief Run one iteration of the loop
+    /// \param [in] timeout_ms_ The longest time to wait for a client
+    /// \return The number of records served
+    size_t
+    serviceOnce (
+        const int timeout_ms_
+    );
+
+    /// \brief Ask `run` to return
+    /// \note Safe to call from any thread, and from a signal handler
+    void
+    stop (
+        void
+    );
+
+  private:
+    // Private definition(s)
+    struct Client {
+        int fd;
+        uint16_t subscription[DEVICE_COUNT];
+    };
+
+    struct PendingWrite {
+        uint16_t values;
+        uint16_t mask;
+    };
+
+    // Private instance variable(s)
+    mcp23s17 * _device[DEVICE_COUNT];
+    Client _client[MAX_CLIENTS];
+    PendingWrite _pending[DEVICE_COUNT];
+    uint16_t _levels[DEVICE_COUNT];
+    int _listen_fd;
+    int _epoll_fd;
+    int _wake_fd;
+    bool _stopping;
+    char _path[108];
+
+    // Private method(s)
+    void
+    accept (
+        void
+    );
+
+    void
+    disconnect (
+        Client & client_
+    );
+
+    void
+    flushWrites (
+        const uint8_t device_
+    );
+
+    bool
+    send (
+        Client & client_,
+        const uint8_t * const buffer_,
+        const size_t length_
+    );
+
+    size_t
+    serve (
+        Client & client_
+    );
+
+    bool
+    serveRecord (
+        Client & client_,
+        const Record & record_,
+        uint8_t * const response_,
+        size_t & response_length_
+    );
+
+    void
+    sampleInputs (
+        void
+    );
+
+    uint16_t
+    subscribedPins (
+        const uint8_t device_
+    ) const;
+};
+
+#endif // MCP23S17_HOST && __linux__
+
+#endif
+
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
@@ -0,0 +1,244 @@
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
+
+#include "hd44780.h"
+
+#if defined(TESTING)
+  #include "test/MOCK_wiring.h"
+#elif defined(ARDUINO) && (ARDUINO <= 100)
+  #include "Arduino.h"
+#elif defined(SPARK)
+  #include "application.h"
+#else
+  #include "WProgram.h"
+#endif
+
+namespace {
+
+// Instruction set
+const uint8_t CLEAR_DISPLAY = 0x01;
+const uint8_t ENTRY_MODE_INCREMENT = 0x06;
+const uint8_t DISPLAY_ON = 0x0C;
+const uint8_t FUNCTION_SET_4BIT = 0x20;
+const uint8_t FUNCTION_SET_2LINE = 0x08;
+const uint8_t SET_DDRAM_ADDRESS = 0x80;
+
+// Execution times (in microseconds)
+const unsigned int CLEAR_DISPLAY_US = 1520;
+const unsigned int EXECUTION_US = 37;
+const unsigned int POWER_ON_RESET_US = 4100;
+const unsigned int RESET_US = 100;
+
+const uint8_t BLANK = ' ';
+
+} // namespace
+
+hd44780::hd44780 (
+    mcp23s17 & gpio_x_,
+    const uint8_t rs_pin_,
+    const uint8_t enable_pin_,
+    const uint8_t d4_pin_,
+    const uint8_t d5_pin_,
+    const uint8_t d6_pin_,
+    const uint8_t d7_pin_,
+    const uint8_t columns_,
+    const uint8_t rows_
+) :
+    _gpio_x(gpio_x_),
+    _columns(columns_),
+    _rows(( !columns_ ) ? 0 : (( rows_ > MAX_ROWS ) ? MAX_ROWS : rows_)),  // A display without columns has no cells
+    _rs_mask(static_cast<uint16_t>(1) << rs_pin_),
+    _enable_mask(static_cast<uint16_t>(1) << enable_pin_),
+    _data_mask{ static_cast<uint16_t>(1 << d4_pin_), static_cast<uint16_t>(1 << d5_pin_), static_cast<uint16_t>(1 << d6_pin_), static_cast<uint16_t>(1 << d7_pin_) },
+    _pin_mask(_rs_mask | _enable_mask | _data_mask[0] | _data_mask[1] | _data_mask[2] | _data_mask[3]),
+    _cursor(0),
+    _ddram_address(0)
+{
+    for ( unsigned int i = 0 ; i < CELL_COUNT ; ++i ) {
+        _framebuffer[i] = BLANK;
+        _display[i] = BLANK;
+    }
+}
+
+void
+hd44780::begin (
+    void
+) {
+    uint8_t function_set(FUNCTION_SET_4BIT);
+
+    _gpio_x.pinModes(_pin_mask, mcp23s17::PinMode::OUTPUT);
+    mcp23s17::WriteStream stream(_gpio_x, _pin_mask);
+
+    // Initialization by instruction (the controller may be in either 8-bit or 4-bit mode)
+    sendNibble(stream, 0x03);
+    ::delayMicroseconds(POWER_ON_RESET_US);
+    sendNibble(stream, 0x03);
+    ::delayMicroseconds(RESET_US);
+    sendNibble(stream, 0x03);
+    ::delayMicroseconds(EXECUTION_US);
+    sendNibble(stream, 0x02);
+    ::delayMicroseconds(EXECUTION_US);
+
+    if ( _rows > 1 ) { function_set |= FUNCTION_SET_2LINE; }
+    sendByte(stream, function_set, false);
+    sendByte(stream, DISPLAY_ON, false);
+    sendByte(stream, CLEAR_DISPLAY, false);
+    ::delayMicroseconds(CLEAR_DISPLAY_US);
+    sendByte(stream, ENTRY_MODE_INCREMENT, false);
+
+    // The display is now blank, and the address counter is home
+    for ( unsigned int i = 0 ; i < CELL_COUNT ; ++i ) { _display[i] = BLANK; }
+    _ddram_address = 0;
+
+    return;
+}
+
+void
+hd44780::clear (
+    void
+) {
+    for ( unsigned int i = 0 ; i < CELL_COUNT ; ++i ) { _framebuffer[i] = BLANK; }
+    _cursor = 0;
+
+    return;
+}
+
+size_t
+hd44780::print (
+    const char * const string_
+) {
+    size_t count(0);
+
+    if ( !string_ ) { return 0; }
+    for ( const char * c = string_ ; *c ; ++c ) {
+        count += write(*c);
+    }
+
+    return count;
+}
+
+void
+hd44780::refresh (
+    void
+) {
+    const unsigned int cell_count(_columns * _rows);
+    unsigned int first_cell(0);
+
+    // Nothing is sent (not even IOCON) unless a cell has changed
+    while ( first_cell < cell_count && first_cell < CELL_COUNT && _framebuffer[first_cell] == _display[first_cell] ) { ++first_cell; }
+    if ( first_cell >= cell_count || first_cell >= CELL_COUNT ) { return; }
+
+    mcp23s17::WriteStream stream(_gpio_x, _pin_mask);
+    for ( unsigned int cell = first_cell ; cell < cell_count && cell < CELL_COUNT ; ++cell ) {
+        const uint8_t address(cellAddress(cell));
+
+        if ( _framebuffer[cell] == _display[cell] ) { continue; }
+
+        // The address counter advances after each character, so the command is only necessary when skipping cells or changing rows
+        if ( address != _ddram_address ) {
+            sendByte(stream, (SET_DDRAM_ADDRESS | address), false);
+        }
+        sendByte(stream, _framebuffer[cell], true);
+
+        _display[cell] = _framebuffer[cell];
+        _ddram_address = (address + 1);
+    }
+
+    return;
+}
+
+void
+hd44780::setCursor (
+    const uint8_t column_,
+    const uint8_t row_
+) {
+    if ( column_ >= _columns || row_ >= _rows ) {
+        _cursor = CELL_COUNT;
+    } else {
+        _cursor = ((row_ * _columns) + column_);
+    }
+
+    return;
+}
+
+size_t
+hd44780::write (
+    const uint8_t character_
+) {
+    if ( _cursor >= CELL_COUNT || _cursor >= (_columns * _rows) ) { return 0; }
+
+    _framebuffer[_cursor] = character_;
+
+    // Stop at the end of the row
+    if ( !((_cursor + 1) % _columns) ) {
+        _cursor = CELL_COUNT;
+    } else {
+        ++_cursor;
+    }
+
+    return 1;
+}
+
+uint8_t
+hd44780::cellAddress (
+    const uint8_t cell_
+) const {
+    const uint8_t row(cell_ / _columns);
+    const uint8_t column(cell_ % _columns);
+    const uint8_t row_offset[MAX_ROWS] = { 0x00, 0x40, _columns, static_cast<uint8_t>(0x40 + _columns) };
+
+    return (row_offset[row] + column);
+}
+
+void
+hd44780::sendByte (
+    mcp23s17::WriteStream & stream_,
+    const uint8_t value_,
+    const bool register_select_
+) {
+    uint16_t high_nibble(_gpio_x.getLatchValues() & ~_pin_mask);
+    uint16_t low_nibble;
+
+    if ( register_select_ ) { high_nibble |= _rs_mask; }
+    low_nibble = high_nibble;
+
+    for ( unsigned int bit = 0 ; bit < 4 ; ++bit ) {
+        if ( (value_ >> (bit + 4)) & 0x01 ) { high_nibble |= _data_mask[bit]; }
+        if ( (value_ >> bit) & 0x01 ) { low_nibble |= _data_mask[bit]; }
+    }
+
+    // RS and data settle before E rises, and each nibble is latched as E falls
+    const uint16_t samples[] = {
+        high_nibble,
+        static_cast<uint16_t>(high_nibble | _enable_mask),
+        high_nibble,
+        static_cast<uint16_t>(low_nibble | _enable_mask),
+        low_nibble,
+    };
+    stream_.write(samples, (sizeof(samples) / sizeof(samples[0])));
+    ::delayMicroseconds(EXECUTION_US);
+
+    return;
+}
+
+void
+hd44780::sendNibble (
+    mcp23s17::WriteStream & stream_,
+    const uint8_t nibble_
+) {
+    uint16_t nibble(_gpio_x.getLatchValues() & ~_pin_mask);
+
+    for ( unsigned int bit = 0 ; bit < 4 ; ++bit ) {
+        if ( (nibble_ >> bit) & 0x01 ) { nibble |= _data_mask[bit]; }
+    }
+
+    const uint16_t samples[] = {
+        nibble,
+        static_cast<uint16_t>(nibble | _enable_mask),
+        nibble,
+    };
+    stream_.write(samples, (sizeof(samples) / sizeof(samples[0])));
+
+    return;
+}
+
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
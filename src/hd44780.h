@@ -0,0 +1,157 @@
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
+
+#ifndef HD44780_H
+#define HD44780_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "mcp23s17.h"
+
+/// \brief HD44780 character LCD (4-bit mode) attached to an MCP23S17
+/// \detail Characters are written to a framebuffer, and `refresh` sends
+/// only the cells that differ from what the display is known to show.
+/// Each refresh opens a single stream session (see
+/// `mcp23s17::WriteStream`), so IOCON is configured once and restored
+/// once, while each character (or command) costs a single transaction.
+/// DDRAM address commands are skipped whenever the display's address
+/// counter already points at the next cell to be sent.
+/// \note The R/W pin of the display is expected to be tied to GND
+class hd44780 {
+  public:
+    // Constructor and destructor method(s)
+
+    /// \brief Object Constructor
+    /// \param [in] gpio_x_ The expander the display is attached to
+    /// \param [in] rs_pin_ The expander pin connected to RS
+    /// \param [in] enable_pin_ The expander pin connected to E
+    /// \param [in] d4_pin_ The expander pin connected to D4
+    /// \param [in] d5_pin_ The expander pin connected to D5
+    /// \param [in] d6_pin_ The expander pin connected to D6
+    /// \param [in] d7_pin_ The expander pin connected to D7
+    /// \param [in] columns_ The number of columns on the display
+    /// \param [in] rows_ The number of rows on the display
+    /// \note `columns_ * rows_` is limited to `CELL_COUNT`
+    /// \note A display without columns has no cells, so every write is
+    /// rejected
+    hd44780 (
+        mcp23s17 & gpio_x_,
+        const uint8_t rs_pin_,
+        const uint8_t enable_pin_,
+        const uint8_t d4_pin_,
+        const uint8_t d5_pin_,
+        const uint8_t d6_pin_,
+        const uint8_t d7_pin_,
+        const uint8_t columns_,
+        const uint8_t rows_
+    );
+
+    // Public instance variable(s)
+    static const uint8_t CELL_COUNT = 80;
+    static const uint8_t MAX_ROWS = 4;
+
+    // Public method(s)
+
+    /// \brief Configure the expander pins and initialize the display
+    /// \note The display requires >40ms after power-up before `begin`
+    void
+    begin (
+        void
+    );
+
+    /// \brief Clear the framebuffer
+    /// \note The display is updated by the next call to `refresh`
+    void
+    clear (
+        void
+    );
+
+    /// \brief Write a string to the framebuffer at the cursor
+    /// \param [in] string_ The null terminated string to write
+    /// \return The number of characters written
+    /// \note Characters beyond the end of the row are discarded
+    size_t
+    print (
+        const char * const string_
+    );
+
+    /// \brief Send the framebuffer cells that differ from the display
+    void
+    refresh (
+        void
+    );
+
+    /// \brief Move the framebuffer cursor
+    /// \param [in] column_ The column of the next character
+    /// \param [in] row_ The row of the next character
+    void
+    setCursor (
+        const uint8_t column_,
+        const uint8_t row_
+    );
+
+    /// \brief Write a character to the framebuffer at the cursor
+    /// \param [in] character_ The character to write
+    /// \return 1 if the character was written, otherwise 0
+    size_t
+    write (
+        const uint8_t character_
+    );
+
+  protected:
+    // Protected method(s)
+    inline
+    char const *
+    getFramebuffer (
+        void
+    ) const {
+        return _framebuffer;
+    }
+
+  private:
+    // Private instance variable(s)
+    mcp23s17 & _gpio_x;
+    const uint8_t _columns;
+    const uint8_t _rows;
+    const uint16_t _rs_mask;
+    const uint16_t _enable_mask;
+    const uint16_t _data_mask[4];
+    const uint16_t _pin_mask;
+    uint8_t _cursor;
+    uint8_t _ddram_address;
+    char _framebuffer[CELL_COUNT];
+    char _display[CELL_COUNT];
+
+    // Private method(s)
+
+    /// \brief DDRAM address of a framebuffer cell
+    uint8_t
+    cellAddress (
+        const uint8_t cell_
+    ) const;
+
+    /// \brief Send a byte as two nibbles in a single transaction
+    /// \param [in] stream_ The open session of the display pins
+    /// \param [in] value_ The command or character to send
+    /// \param [in] register_select_ false => command, true => character
+    void
+    sendByte (
+        mcp23s17::WriteStream & stream_,
+        const uint8_t value_,
+        const bool register_select_
+    );
+
+    /// \brief Send a single nibble (command) in a single transaction
+    /// \param [in] stream_ The open session of the display pins
+    /// \param [in] nibble_ The command to send
+    /// \note Only used during initialization, while in 8-bit mode
+    void
+    sendNibble (
+        mcp23s17::WriteStream & stream_,
+        const uint8_t nibble_
+    );
+};
+
+#endif
+
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
@@ -0,0 +1,93 @@
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
+
+#include "keypad_matrix.h"
+
+keypad_matrix::keypad_matrix (
+    mcp23s17 & gpio_x_,
+    const mcp23s17::Port row_port_,
+    const uint8_t rows_,
+    const uint8_t columns_,
+    const uint8_t debounce_scans_
+) :
+    _gpio_x(gpio_x_),
+    _rows(( rows_ > MAX_ROWS ) ? MAX_ROWS : rows_),
+    _columns(( columns_ > MAX_COLUMNS ) ? MAX_COLUMNS : columns_),
+    _debounce_scans(debounce_scans_ ? debounce_scans_ : 1),
+    _row_shift(( mcp23s17::Port::A == row_port_ ) ? 0 : 8),
+    _column_shift(( mcp23s17::Port::A == row_port_ ) ? 8 : 0),
+    _row_mask(static_cast<uint16_t>((1 << _rows) - 1) << _row_shift),
+    _column_mask(static_cast<uint16_t>((1 << _columns) - 1) << _column_shift),
+    _key_state{ 0 },
+    _debounce_count{ { 0 } },
+    _idle(false)
+{}
+
+keypad_matrix::KeyState
+keypad_matrix::getKeyState (
+    const uint8_t row_,
+    const uint8_t column_
+) const {
+    if ( row_ >= _rows || column_ >= _columns ) { return KeyState::RELEASED; }
+    return static_cast<KeyState>((_key_state[row_] >> column_) & 0x01);
+}
+
+void
+keypad_matrix::begin (
+    const mcp23s17::isr_t interrupt_service_routine_
+) {
+    // Idle (all rows LOW), so any key press changes a column. The row latches are cleared in the same frame that drives the rows.
+    _gpio_x.pinModesOutput(_row_mask, 0x0000);
+    _gpio_x.pinModes(_column_mask, mcp23s17::PinMode::INPUT_PULLUP);
+    _gpio_x.attachInterrupts(_column_mask, interrupt_service_routine_, mcp23s17::InterruptMode::CHANGE);
+    _idle = true;
+
+    return;
+}
+
+size_t
+keypad_matrix::scan (
+    KeyEvent * const events_,
+    const size_t capacity_
+) {
+    size_t event_count(0);
+    bool keys_held(false);
+
+    for ( uint8_t row = 0 ; row < _rows ; ++row ) {
+        uint8_t pressed;
+
+        // Drive the row LOW (and the others HIGH), then read the columns
+        _gpio_x.digitalWritePorts(~(static_cast<uint16_t>(1) << (row + _row_shift)), _row_mask);
+        pressed = ~(_gpio_x.digitalReadPorts(_column_mask) >> _column_shift);
+
+        for ( uint8_t column = 0 ; column < _columns ; ++column ) {
+            const uint8_t column_mask(static_cast<uint8_t>(1) << column);
+            const bool raw_state(pressed & column_mask);
+            const bool debounced_state(_key_state[row] & column_mask);
+
+            if ( raw_state == debounced_state ) {
+                _debounce_count[row][column] = 0;
+            } else if ( ++_debounce_count[row][column] >= _debounce_scans ) {
+                // Hold the change until it can be reported
+                _debounce_count[row][column] = _debounce_scans;
+                if ( event_count < capacity_ && events_ ) {
+                    _key_state[row] ^= column_mask;
+                    _debounce_count[row][column] = 0;
+                    events_[event_count].row = row;
+                    events_[event_count].column = column;
+                    events_[event_count].state = static_cast<KeyState>(raw_state);
+                    ++event_count;
+                }
+            }
+
+            keys_held |= (raw_state || (_key_state[row] & column_mask));
+        }
+    }
+
+    // Return to idle (all rows LOW) once every key has been released
+    _idle = !keys_held;
+    if ( _idle ) { _gpio_x.digitalWritePorts(0x0000, _row_mask); }
+
+    return event_count;
+}
+
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
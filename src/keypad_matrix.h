@@ -0,0 +1,117 @@
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
+
+#ifndef KEYPAD_MATRIX_H
+#define KEYPAD_MATRIX_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "mcp23s17.h"
+
+/// \brief Key matrix scanner (up to 8x8) on a single MCP23S17
+/// \detail Rows are driven from one port and columns are read from the
+/// other, so each row of a scan costs one 3-byte write and one 3-byte
+/// read. Between key presses every row is held LOW with the column
+/// interrupts armed, so an idle keypad costs no bus traffic at all; the
+/// host only needs to scan once the INT line is asserted.
+/// \note Keys are debounced and tracked individually (n-key rollover),
+/// which requires a diode per key. The diodes also keep the driven rows
+/// from contending when several keys share a column.
+class keypad_matrix {
+  public:
+    // Definition(s)
+
+    /// \brief Key State
+    enum class KeyState : uint8_t {
+        RELEASED = 0,
+        PRESSED,
+    };
+
+    /// \brief Key Event
+    struct KeyEvent {
+        uint8_t row;
+        uint8_t column;
+        KeyState state;
+    };
+
+    // Constructor and destructor method(s)
+
+    /// \brief Object Constructor
+    /// \param [in] gpio_x_ The expander the keypad is attached to
+    /// \param [in] row_port_ The port driving the rows (pins 0 to `rows_` - 1)
+    /// \param [in] rows_ The number of rows in the matrix (1-8)
+    /// \param [in] columns_ The number of columns in the matrix (1-8),
+    /// read from the opposite port (pins 0 to `columns_` - 1)
+    /// \param [in] debounce_scans_ The number of consecutive scans a key
+    /// must hold a new state before it is reported
+    keypad_matrix (
+        mcp23s17 & gpio_x_,
+        const mcp23s17::Port row_port_,
+        const uint8_t rows_,
+        const uint8_t columns_,
+        const uint8_t debounce_scans_ = 2
+    );
+
+    // Accessor method(s)
+
+    /// \brief Whether the keypad is waiting on a column interrupt
+    /// \return true when no keys are held and every row is driven LOW
+    inline
+    bool
+    isIdle (
+        void
+    ) const {
+        return _idle;
+    }
+
+    /// \brief Debounced state of a key
+    KeyState
+    getKeyState (
+        const uint8_t row_,
+        const uint8_t column_
+    ) const;
+
+    // Public instance variable(s)
+    static const uint8_t MAX_COLUMNS = 8;
+    static const uint8_t MAX_ROWS = 8;
+
+    // Public method(s)
+
+    /// \brief Configure the expander and arm the column interrupts
+    /// \param [in] interrupt_service_routine_ The callback to be fired
+    /// when a column changes while idle (optional)
+    void
+    begin (
+        const mcp23s17::isr_t interrupt_service_routine_ = nullptr
+    );
+
+    /// \brief Scan the matrix and report debounced key events
+    /// \param [out] events_ The caller supplied buffer to receive events
+    /// \param [in] capacity_ The number of events the buffer can hold
+    /// \return The number of events reported
+    /// \note Changes that do not fit in the buffer are reported by a
+    /// subsequent scan
+    size_t
+    scan (
+        KeyEvent * const events_,
+        const size_t capacity_
+    );
+
+  private:
+    // Private instance variable(s)
+    mcp23s17 & _gpio_x;
+    const uint8_t _rows;
+    const uint8_t _columns;
+    const uint8_t _debounce_scans;
+    const unsigned int _row_shift;
+    const unsigned int _column_shift;
+    const uint16_t _row_mask;
+    const uint16_t _column_mask;
+    uint8_t _key_state[MAX_ROWS];
+    uint8_t _debounce_count[MAX_ROWS][MAX_COLUMNS];
+    bool _idle;
+};
+
+#endif
+
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
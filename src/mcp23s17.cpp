@@ -1,6 +1,13 @@
 /* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
 
 #include "mcp23s17.h"
+#include "spi_transport.h"
+
+#if defined(MCP23S17_HOST)
+  #include <chrono>
+
+  #include "spi_bus.h"
+#endif
 
 #if defined(TESTING)
   #include "test/MOCK_wiring.h"
@@ -12,26 +19,147 @@
   #include "WProgram.h"
 #endif
 
+#if !defined(MCP23S17_HOST) && defined(__AVR__)
+  #include <avr/sleep.h>
+#endif
+
+namespace {
+
+/// \brief Translate a register address from IOCON.BANK = 0 to IOCON.BANK = 1
+/// \detail With BANK = 0 the port A/B registers are interleaved, while with
+/// BANK = 1 the port B registers are offset by 0x10.
+inline
+uint8_t
+bankOneAddress (
+    const mcp23s17::ControlRegister register_
+) {
+    const uint8_t address(static_cast<uint8_t>(register_));
+    return (((address & 0x01) << 4) | (address >> 1));
+}
+
+#if defined(MCP23S17_HOST)
+/// \brief Monotonic time base of `waitForAny`
+inline
+unsigned long
+elapsedMilliseconds (
+    void
+) {
+    return static_cast<unsigned long>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+#else
+/// \brief Monotonic time base of `waitForAny`
+inline
+unsigned long
+elapsedMilliseconds (
+    void
+) {
+    return ::millis();
+}
+
+/// \brief Sleep until the next interrupt
+inline
+void
+lowPowerWait (
+    void
+) {
+  #if defined(__AVR__)
+    // IDLE keeps the timers running, so `millis` continues to advance
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    sleep_mode();
+  #elif defined(__arm__)
+    __WFI();
+  #endif
+}
+#endif
+
+/// \brief Length of the next chunk of a stream
+/// \param [in] remaining_ The samples yet to be streamed
+inline
+size_t
+streamChunkLength (
+    const size_t remaining_
+) {
+    return (( remaining_ < mcp23s17::STREAM_CHUNK_LENGTH ) ? remaining_ : static_cast<size_t>(mcp23s17::STREAM_CHUNK_LENGTH));
+}
+
+#if !defined(MCP23S17_HOST) && !defined(__AVR__) && !defined(__arm__) && !defined(ESP8266)
+/// \brief Nesting depth of the critical sections (the interrupt mask
+/// cannot be read back on every platform)
+volatile uint8_t critical_section_depth(0);
+#endif
+
+} // namespace
+
 mcp23s17::mcp23s17 (
     const HardwareAddress hw_addr_
+#if defined(MCP23S17_HOST)
+    ,
+    spi_bus * const bus_
+#endif
+) :
+#if defined(MCP23S17_HOST)
+    mcp23s17(hw_addr_, static_cast<spi_transport *>(nullptr), bus_)
+#else
+    mcp23s17(hw_addr_, static_cast<spi_transport *>(nullptr))
+#endif
+{}
+
+mcp23s17::mcp23s17 (
+    const HardwareAddress hw_addr_,
+    spi_transport & transport_
+#if defined(MCP23S17_HOST)
+    ,
+    spi_bus * const bus_
+#endif
+) :
+#if defined(MCP23S17_HOST)
+    mcp23s17(hw_addr_, &transport_, bus_)
+#else
+    mcp23s17(hw_addr_, &transport_)
+#endif
+{}
+
+mcp23s17::mcp23s17 (
+    const HardwareAddress hw_addr_,
+    spi_transport * const transport_
+#if defined(MCP23S17_HOST)
+    ,
+    spi_bus * const bus_
+#endif
 ) :
     _SPI_BUS_ADDRESS(SPI_BASE_ADDRESS | (static_cast<uint8_t>(hw_addr_) << 1)),
     _control_register{ 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
     _control_register_address{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21 },
-    _interrupt_service_routines{ nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr }
+    _interrupt_service_routines{ nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr },
+    _interrupt_snapshot{ 0x0000, 0x0000, 0x0000 },
+    _transport(transport_),
+    _latches_unconfirmed(false)
+#if defined(MCP23S17_HOST)
+    ,
+    _bus(bus_),
+    _lock_owner(std::thread::id()),
+    _lock_depth(0),
+    _dispatch_count(0)
+#else
+    ,
+    _dispatch_count(0)
+#endif
 {
-    ::SPI.begin();
+    uint8_t frame[] = { SPI_BASE_ADDRESS, static_cast<uint8_t>(ControlRegister::IOCONA), static_cast<uint8_t>(IOConfigurationRegister::HAEN) };
+
+    if ( _transport ) {
+        _transport->begin();
+    } else {
+        ::SPI.begin();
+    }
 
     //TODO: Load cache from chip registers (requires special handling if IOCON:HAEN is unset, or IOCON:BANK is set), or use a capture a reset pin so the chip can be put in a known state.
 
     // Set IOCON:HAEN bit
     _control_register[static_cast<uint8_t>(mcp23s17::ControlRegister::IOCONA)] |= static_cast<uint8_t>(IOConfigurationRegister::HAEN);
 
-    ::digitalWrite(SS, LOW);
-    ::SPI.transfer(SPI_BASE_ADDRESS);
-    ::SPI.transfer(static_cast<uint8_t>(ControlRegister::IOCONA));
-    ::SPI.transfer(static_cast<uint8_t>(IOConfigurationRegister::HAEN));
-    ::digitalWrite(SS, HIGH);
+    CriticalSection critical_section(*this);
+    transferFrame(frame, sizeof(frame));
 
     return;
 }
@@ -42,54 +170,94 @@ mcp23s17::attachInterrupt (
     const isr_t interrupt_service_routine_,
     const InterruptMode mode_
 ) {
-    uint16_t interrupt_control_cache(0x0000);
-    uint16_t interrupt_enable_cache(0x0000);
-
-    //if ( pin_ >= PIN_COUNT ) { return; }
-    //if ( !interrupt_service_routine_ ) { return; }
-    _interrupt_service_routines[pin_] = interrupt_service_routine_;
-
-    // Check enable cache for existing data
-    interrupt_enable_cache = _control_register[static_cast<uint8_t>(ControlRegister::GPINTENA)];
-    interrupt_enable_cache |= (_control_register[static_cast<uint8_t>(ControlRegister::GPINTENB)] << 8);
-    interrupt_enable_cache |= (1 << pin_);
-    _control_register[static_cast<uint8_t>(ControlRegister::GPINTENA)] = interrupt_enable_cache;
-    _control_register[static_cast<uint8_t>(ControlRegister::GPINTENB)] = (interrupt_enable_cache >> 8);
-
-    // Check control cache for existing data
-    interrupt_control_cache = _control_register[static_cast<uint8_t>(ControlRegister::INTCONA)];
-    interrupt_control_cache |= (_control_register[static_cast<uint8_t>(ControlRegister::INTCONB)] << 8);
-    if ( InterruptMode::CHANGE != mode_ ) {
-        interrupt_control_cache |= (1 << pin_);
-    } else {
-        interrupt_control_cache &= ~(1 << pin_);
+    InterruptConfiguration configuration;
+
+    configuration.pin = pin_;
+    configuration.interrupt_service_routine = interrupt_service_routine_;
+    configuration.mode = mode_;
+
+    // Invalid pins are ignored, and only the pin's own bits are merged into the register images
+    return attachInterrupts(&configuration, 1);
+}
+
+void
+mcp23s17::attachInterrupts (
+    const uint16_t mask_,
+    const isr_t interrupt_service_routine_,
+    const InterruptMode mode_
+) {
+    InterruptConfiguration configurations[PIN_COUNT];
+    size_t count(0);
+
+    for ( uint8_t pin = 0 ; pin < PIN_COUNT ; ++pin ) {
+        if ( !((mask_ >> pin) & 0x01) ) { continue; }
+        configurations[count].pin = pin;
+        configurations[count].interrupt_service_routine = interrupt_service_routine_;
+        configurations[count].mode = mode_;
+        ++count;
     }
-    _control_register[static_cast<uint8_t>(ControlRegister::INTCONA)] = interrupt_control_cache;
-    _control_register[static_cast<uint8_t>(ControlRegister::INTCONB)] = (interrupt_control_cache >> 8);
 
-    // Three bytes are required to update a single register. Therefore, if a comparison-based interrupt is requested, then both ports of all three registers are written at once to optimize the transfer by one byte. Otherwise, if a change-based interrupt is requested, then it is more efficient to write two transactions to the to the specific ports and registers.
-    ::digitalWrite(SS, LOW);
-    ::SPI.transfer(_SPI_BUS_ADDRESS | static_cast<uint8_t>(RegisterTransaction::WRITE));
-    ::SPI.transfer(static_cast<uint8_t>(ControlRegister::GPINTENA));
-    ::SPI.transfer(interrupt_enable_cache);  // GPINTENA
-    ::SPI.transfer(interrupt_enable_cache >> 8);  // GPINTENB
-    if ( InterruptMode::HIGH == mode_ ) {
-        ::SPI.transfer(1 << pin_);  // DEFVALA
-        ::SPI.transfer(1 << (pin_ % 8));  // DEFVALB
-        ::SPI.transfer(interrupt_control_cache);  // INTCONA
-        ::SPI.transfer(interrupt_control_cache >> 8);  // INTCONB
-    } else {
-        ::SPI.transfer(0x00);  // DEFVALA
-        ::SPI.transfer(0x00);  // DEFVALB
-        if ( InterruptMode::CHANGE == mode_ ) {
-            ::SPI.transfer(interrupt_control_cache);  // INTCONA
-            ::SPI.transfer(interrupt_control_cache >> 8);  // INTCONB
+    return attachInterrupts(configurations, count);
+}
+
+void
+mcp23s17::attachInterrupts (
+    const InterruptConfiguration * const configurations_,
+    const size_t count_
+) {
+    if ( !configurations_ ) { return; }
+
+    CriticalSection critical_section(*this);
+    uint16_t interrupt_enable_cache(registerPair(ControlRegister::GPINTENA));
+    uint16_t default_value_cache(registerPair(ControlRegister::DEFVALA));
+    uint16_t interrupt_control_cache(registerPair(ControlRegister::INTCONA));
+    bool attached(false);
+
+    for ( size_t i = 0 ; i < count_ ; ++i ) {
+        const uint8_t pin(configurations_[i].pin);
+
+        if ( pin >= PIN_COUNT ) { continue; }
+        const uint16_t pin_mask(static_cast<uint16_t>(1) << pin);
+        _interrupt_service_routines[pin] = configurations_[i].interrupt_service_routine;
+
+        interrupt_enable_cache |= pin_mask;
+        if ( InterruptMode::HIGH == configurations_[i].mode ) {
+            default_value_cache |= pin_mask;
+        } else {
+            default_value_cache &= ~pin_mask;
+        }
+        if ( InterruptMode::CHANGE != configurations_[i].mode ) {
+            interrupt_control_cache |= pin_mask;
         } else {
-            ::SPI.transfer(interrupt_control_cache);  // INTCONA
-            ::SPI.transfer(interrupt_control_cache >> 8);  // INTCONB
+            interrupt_control_cache &= ~pin_mask;
         }
+        attached = true;
     }
-    ::digitalWrite(SS, HIGH);
+    if ( !attached ) { return; }
+
+    return writeInterruptConfiguration(interrupt_enable_cache, default_value_cache, interrupt_control_cache);
+}
+
+void
+mcp23s17::detachInterrupt (
+    const uint8_t pin_
+) {
+    if ( pin_ >= PIN_COUNT ) { return; }
+    return detachInterrupts(static_cast<uint16_t>(1) << pin_);
+}
+
+void
+mcp23s17::detachInterrupts (
+    const uint16_t mask_
+) {
+    CriticalSection critical_section(*this);
+
+    for ( uint8_t pin = 0 ; pin < PIN_COUNT ; ++pin ) {
+        if ( !((mask_ >> pin) & 0x01) ) { continue; }
+        _interrupt_service_routines[pin] = nullptr;
+    }
+
+    return writeRegisterPair(ControlRegister::GPINTENA, (registerPair(ControlRegister::GPINTENA) & ~mask_));
 }
 
 mcp23s17::PinLatchValue
@@ -100,7 +268,7 @@ mcp23s17::digitalRead (
 
     ControlRegister latch_register(ControlRegister::GPIOA_);
     ControlRegister direction_register(ControlRegister::IODIRA);
-    uint8_t port_latch_values(0x00);
+    CriticalSection critical_section(*this);
 
     // Select the appropriate port
     if ( pin_ / 8 ) {
@@ -111,14 +279,90 @@ mcp23s17::digitalRead (
     // Check to see if device is in the proper state
     if ( PinMode::OUTPUT == static_cast<PinMode>((_control_register[static_cast<uint8_t>(direction_register)] >> bit_pos) & 0x01) ) { return PinLatchValue::LOW; }
 
-    // Send data
-    ::digitalWrite(SS, LOW);
-    ::SPI.transfer(_SPI_BUS_ADDRESS | static_cast<uint8_t>(RegisterTransaction::READ));
-    ::SPI.transfer(static_cast<uint8_t>(latch_register));
-    port_latch_values = ::SPI.transfer(static_cast<uint8_t>(latch_register));  // Arbitrary bit to flush result buffer. `latch_register` is selected, because it is guaranteed to be in active memory.
-    ::digitalWrite(SS, HIGH);
+    // Send data (the trailing byte is arbitrary, and only flushes the result buffer. `latch_register` is selected, because it is guaranteed to be in active memory.)
+    uint8_t frame[] = {
+        static_cast<uint8_t>(_SPI_BUS_ADDRESS | static_cast<uint8_t>(RegisterTransaction::READ)),
+        static_cast<uint8_t>(latch_register),
+        static_cast<uint8_t>(latch_register),
+    };
+    transferFrame(frame, sizeof(frame));
+
+    return static_cast<PinLatchValue>((frame[2] >> bit_pos) & 0x01);
+}
+
+uint16_t
+mcp23s17::digitalReadPorts (
+    const uint16_t mask_
+) const {
+    uint8_t frame[MAX_FRAME_LENGTH];
+    const size_t length(prepareDigitalReadPorts(mask_, frame));
+
+    if ( !length ) { return 0x0000; }
+    {
+        CriticalSection critical_section(*this);
+        transferFrame(frame, length);
+    }
 
-    return static_cast<PinLatchValue>((port_latch_values >> bit_pos) & 0x01);
+    return completeDigitalReadPorts(mask_, frame);
+}
+
+uint32_t
+mcp23s17::digitalReadStream (
+    const Port port_,
+    uint8_t * const buffer_,
+    const size_t length_
+) {
+    const ControlRegister latch_register(( Port::A == port_ ) ? ControlRegister::GPIOA_ : ControlRegister::GPIOB_);
+    unsigned long elapsed_us(0);
+
+    if ( !buffer_ || !length_ ) { return 0; }
+    if ( !isStreamCapable() ) { return 0; }
+
+    // Capture data (interrupts are masked for a single chunk at a time, so the system clock keeps time)
+    for ( size_t offset = 0 ; offset < length_ ; offset += STREAM_CHUNK_LENGTH ) {
+        const size_t end(offset + streamChunkLength(length_ - offset));
+        CriticalSection critical_section(*this);
+        unsigned long start_us;
+
+        beginStream(latch_register, RegisterTransaction::READ, true);
+        start_us = ::micros();
+        for ( size_t i = offset ; i < end ; ++i ) {
+            buffer_[i] = ::SPI.transfer(static_cast<uint8_t>(latch_register));  // Arbitrary bit to flush result buffer
+        }
+        elapsed_us += (::micros() - start_us);
+        endStream(true);
+    }
+
+    return static_cast<uint32_t>((static_cast<uint64_t>(elapsed_us) * 1000) / length_);
+}
+
+uint32_t
+mcp23s17::digitalReadStream (
+    uint16_t * const buffer_,
+    const size_t length_
+) {
+    unsigned long elapsed_us(0);
+
+    if ( !buffer_ || !length_ ) { return 0; }
+    if ( !isStreamCapable() ) { return 0; }
+
+    // Capture data (interrupts are masked for a single chunk at a time, so the system clock keeps time)
+    for ( size_t offset = 0 ; offset < length_ ; offset += STREAM_CHUNK_LENGTH ) {
+        const size_t end(offset + streamChunkLength(length_ - offset));
+        CriticalSection critical_section(*this);
+        unsigned long start_us;
+
+        beginStream(ControlRegister::GPIOA_, RegisterTransaction::READ, false);
+        start_us = ::micros();
+        for ( size_t i = offset ; i < end ; ++i ) {
+            buffer_[i] = ::SPI.transfer(static_cast<uint8_t>(ControlRegister::GPIOA_));  // GPIOA
+            buffer_[i] |= (static_cast<uint16_t>(::SPI.transfer(static_cast<uint8_t>(ControlRegister::GPIOB_))) << 8);  // GPIOB
+        }
+        elapsed_us += (::micros() - start_us);
+        endStream(false);
+    }
+
+    return static_cast<uint32_t>((static_cast<uint64_t>(elapsed_us) * 1000) / length_);
 }
 
 void
@@ -132,6 +376,7 @@ mcp23s17::digitalWrite (
     ControlRegister latch_register(ControlRegister::GPIOA_);
     ControlRegister direction_register(ControlRegister::IODIRA);
     uint8_t registry_value;
+    CriticalSection critical_section(*this);
 
     // Select the appropriate port
     if ( pin_ / 8 ) {
@@ -155,15 +400,73 @@ mcp23s17::digitalWrite (
     _control_register[static_cast<uint8_t>(latch_register)] = registry_value;
 
     // Send data
-    ::digitalWrite(SS, LOW);
-    ::SPI.transfer(_SPI_BUS_ADDRESS | static_cast<uint8_t>(RegisterTransaction::WRITE));
-    ::SPI.transfer(static_cast<uint8_t>(latch_register));
-    ::SPI.transfer(registry_value);
-    ::digitalWrite(SS, HIGH);
+    uint8_t frame[] = { static_cast<uint8_t>(_SPI_BUS_ADDRESS | static_cast<uint8_t>(RegisterTransaction::WRITE)), static_cast<uint8_t>(latch_register), registry_value };
+    if ( !transferFrame(frame, sizeof(frame)) ) { _latches_unconfirmed = true; }
+
+    return;
+}
+
+void
+mcp23s17::digitalWritePorts (
+    const uint16_t values_,
+    const uint16_t mask_
+) {
+    uint8_t frame[MAX_FRAME_LENGTH];
+    CriticalSection critical_section(*this);
+    const size_t length(prepareDigitalWritePorts(values_, mask_, frame));
+
+    if ( !length ) { return; }
+    if ( !transferFrame(frame, length) ) { _latches_unconfirmed = true; }
+
+    return;
+}
+
+void
+mcp23s17::digitalWriteStream (
+    const Port port_,
+    const uint8_t * const buffer_,
+    const size_t length_
+) {
+    if ( !buffer_ || !length_ ) { return; }
+    if ( !isStreamCapable() ) { return; }
+
+    // Each chunk is a complete session, so the device is never left in streaming mode while interrupts are unmasked
+    for ( size_t offset = 0 ; offset < length_ ; offset += STREAM_CHUNK_LENGTH ) {
+        CriticalSection critical_section(*this);
+        WriteStream stream(*this, (( Port::A == port_ ) ? 0x00FF : 0xFF00));
+
+        stream.write((buffer_ + offset), streamChunkLength(length_ - offset));
+    }
 
     return;
 }
 
+void
+mcp23s17::digitalWriteStream (
+    const uint16_t * const buffer_,
+    const size_t length_
+) {
+    if ( !buffer_ || !length_ ) { return; }
+    if ( !isStreamCapable() ) { return; }
+
+    // Each chunk is a complete session, so the device is never left in streaming mode while interrupts are unmasked
+    for ( size_t offset = 0 ; offset < length_ ; offset += STREAM_CHUNK_LENGTH ) {
+        CriticalSection critical_section(*this);
+        WriteStream stream(*this);
+
+        stream.write((buffer_ + offset), streamChunkLength(length_ - offset));
+    }
+
+    return;
+}
+
+bool
+mcp23s17::isStreamCapable (
+    void
+) const {
+    return ( !_transport || _transport->isStreamCapable() );
+}
+
 void
 mcp23s17::pinMode (
     const uint8_t pin_,
@@ -176,6 +479,7 @@ mcp23s17::pinMode (
     ControlRegister pullup_register(ControlRegister::GPPUA);
     uint8_t latch_register_cache;
     uint8_t pullup_register_cache;
+    CriticalSection critical_section(*this);
 
     // Select the appropriate port
     if ( pin_ / 8 ) {
@@ -205,24 +509,852 @@ mcp23s17::pinMode (
 
     // Send data to IODIR[A|B] registers, if necessary
     if ( _control_register[static_cast<uint8_t>(latch_register)] != latch_register_cache ) {
-        _control_register[static_cast<uint8_t>(latch_register)] = latch_register_cache;
+        uint8_t frame[] = { static_cast<uint8_t>(_SPI_BUS_ADDRESS | static_cast<uint8_t>(RegisterTransaction::WRITE)), static_cast<uint8_t>(latch_register), latch_register_cache };
 
-        ::digitalWrite(SS, LOW);
-        ::SPI.transfer(_SPI_BUS_ADDRESS | static_cast<uint8_t>(RegisterTransaction::WRITE));
-        ::SPI.transfer(static_cast<uint8_t>(latch_register));
-        ::SPI.transfer(latch_register_cache);
-        ::digitalWrite(SS, HIGH);
+        _control_register[static_cast<uint8_t>(latch_register)] = latch_register_cache;
+        transferFrame(frame, sizeof(frame));
     }
 
     // Send data to GPPU[A|B] registers, if necessary
     if ( _control_register[static_cast<uint8_t>(pullup_register)] != pullup_register_cache ) {
+        uint8_t frame[] = { static_cast<uint8_t>(_SPI_BUS_ADDRESS | static_cast<uint8_t>(RegisterTransaction::WRITE)), static_cast<uint8_t>(pullup_register), pullup_register_cache };
+
         _control_register[static_cast<uint8_t>(pullup_register)] = pullup_register_cache;
+        transferFrame(frame, sizeof(frame));
+    }
+
+    return;
+}
+
+void
+mcp23s17::pinModeOutput (
+    const uint8_t pin_,
+    const PinLatchValue value_
+) {
+    if ( pin_ >= PIN_COUNT ) { return; }
+    return pinModesOutput((static_cast<uint16_t>(1) << pin_), (( PinLatchValue::HIGH == value_ ) ? 0xFFFF : 0x0000));
+}
+
+void
+mcp23s17::pinModes (
+    const uint16_t mask_,
+    const PinMode mode_
+) {
+    PinMode modes[PIN_COUNT];
+    CriticalSection critical_section(*this);
+    uint16_t direction(registerPair(ControlRegister::IODIRA));
+    uint16_t pullup(registerPair(ControlRegister::GPPUA));
+
+    for ( uint8_t pin = 0 ; pin < PIN_COUNT ; ++pin ) {
+        if ( (mask_ >> pin) & 0x01 ) {
+            modes[pin] = mode_;
+        } else if ( !((direction >> pin) & 0x01) ) {
+            modes[pin] = PinMode::OUTPUT;
+        } else if ( (pullup >> pin) & 0x01 ) {
+            modes[pin] = PinMode::INPUT_PULLUP;
+        } else {
+            modes[pin] = PinMode::INPUT;
+        }
+    }
+
+    return pinModes(modes, PIN_COUNT);
+}
+
+void
+mcp23s17::pinModes (
+    const PinMode * const modes_,
+    const size_t count_
+) {
+    if ( !modes_ ) { return; }
+
+    CriticalSection critical_section(*this);
+    uint16_t direction(registerPair(ControlRegister::IODIRA));
+    uint16_t pullup(registerPair(ControlRegister::GPPUA));
+
+    for ( uint8_t pin = 0 ; pin < PIN_COUNT && pin < count_ ; ++pin ) {
+        const uint16_t pin_mask(static_cast<uint16_t>(1) << pin);
+
+        switch ( modes_[pin] ) {
+          case PinMode::OUTPUT:
+            direction &= ~pin_mask;
+            break;
+          case PinMode::INPUT:
+            pullup &= ~pin_mask;
+            direction |= pin_mask;
+            break;
+          case PinMode::INPUT_PULLUP:
+            pullup |= pin_mask;
+            direction |= pin_mask;
+            break;
+        }
+    }
+
+    // A single burst from IODIRA through GPPUB costs 16 bytes (and rewrites every register between), so two pair updates are always cheaper
+    writeRegisterPair(ControlRegister::IODIRA, direction);
+    writeRegisterPair(ControlRegister::GPPUA, pullup);
+
+    return;
+}
+
+void
+mcp23s17::pinModesOutput (
+    const uint16_t mask_,
+    const uint16_t values_
+) {
+    CriticalSection critical_section(*this);
+    const uint16_t latch(getLatchValues());
+    const uint16_t direction(registerPair(ControlRegister::IODIRA));
+    const uint16_t latch_image((latch & ~mask_) | (values_ & mask_));
+    const uint16_t direction_image(direction & ~mask_);
+
+    // Registers in the order the address pointer visits them, beginning at OLATA
+    const ControlRegister frame_register[] = { ControlRegister::OLATA, ControlRegister::OLATB, ControlRegister::IODIRA, ControlRegister::IODIRB };
+    const uint8_t frame_value[] = {
+        static_cast<uint8_t>(latch_image),
+        static_cast<uint8_t>(latch_image >> 8),
+        static_cast<uint8_t>(direction_image),
+        static_cast<uint8_t>(direction_image >> 8),
+    };
+    const bool frame_changed[] = {
+        (static_cast<uint8_t>(latch) != frame_value[0]),
+        (static_cast<uint8_t>(latch >> 8) != frame_value[1]),
+        (static_cast<uint8_t>(direction) != frame_value[2]),
+        (static_cast<uint8_t>(direction >> 8) != frame_value[3]),
+    };
+    uint8_t frame[MAX_FRAME_LENGTH];
+    size_t length(0);
+    unsigned int first(0);
+    unsigned int last(3);
+
+    // Trim the registers that are unchanged from either end of the frame
+    while ( first < 4 && !frame_changed[first] ) { ++first; }
+    if ( first == 4 ) { return; }
+    while ( !frame_changed[last] ) { --last; }
+
+    _control_register[static_cast<uint8_t>(ControlRegister::GPIOA_)] = frame_value[0];
+    _control_register[static_cast<uint8_t>(ControlRegister::GPIOB_)] = frame_value[1];
+    _control_register[static_cast<uint8_t>(ControlRegister::IODIRA)] = frame_value[2];
+    _control_register[static_cast<uint8_t>(ControlRegister::IODIRB)] = frame_value[3];
+
+    // Send data (the latches always precede the directions)
+    frame[length++] = (_SPI_BUS_ADDRESS | static_cast<uint8_t>(RegisterTransaction::WRITE));
+    frame[length++] = static_cast<uint8_t>(frame_register[first]);
+    for ( unsigned int i = first ; i <= last ; ++i ) {
+        frame[length++] = frame_value[i];
+    }
+    if ( !transferFrame(frame, length) && first <= 1 ) { _latches_unconfirmed = true; }
+
+    return;
+}
+
+mcp23s17::InterruptSnapshot
+mcp23s17::serviceInterrupts (
+    void
+) {
+    uint8_t frame[MAX_FRAME_LENGTH];
+    const size_t length(prepareServiceInterrupts(frame));
+
+    {
+        CriticalSection critical_section(*this);
+
+        // The bytes received are invalid, so neither the snapshot nor any interrupt service routine may act upon them
+        if ( !transferFrame(frame, length) ) { return InterruptSnapshot{ 0x0000, 0x0000, 0x0000 }; }
+    }
+
+    return completeServiceInterrupts(frame);
+}
+
+void
+mcp23s17::shiftOut (
+    const uint8_t data_pin_,
+    const uint8_t clock_pin_,
+    const uint8_t bit_order_,
+    const uint8_t value_
+) {
+    return shiftOut(data_pin_, clock_pin_, bit_order_, &value_, 1);
+}
+
+void
+mcp23s17::shiftOut (
+    const uint8_t data_pin_,
+    const uint8_t clock_pin_,
+    const uint8_t bit_order_,
+    const uint8_t * const buffer_,
+    const size_t length_
+) {
+    // The pins are validated before they are used as shift counts
+    if ( data_pin_ >= PIN_COUNT || clock_pin_ >= PIN_COUNT ) { return; }
+    if ( !buffer_ || !length_ ) { return; }
+    if ( !isStreamCapable() ) { return; }
+
+    const uint16_t data_mask(static_cast<uint16_t>(1) << data_pin_);
+    const uint16_t clock_mask(static_cast<uint16_t>(1) << clock_pin_);
+    const bool single_port((data_pin_ / 8) == (clock_pin_ / 8));
+    const ControlRegister latch_register(( single_port && (clock_pin_ / 8) ) ? ControlRegister::GPIOB_ : ControlRegister::GPIOA_);
+    const unsigned int port_shift(( ControlRegister::GPIOB_ == latch_register ) ? 8 : 0);
+
+    // Each byte costs 16 samples, and interrupts are masked for a single chunk of bytes at a time
+    const size_t chunk_bytes(STREAM_CHUNK_LENGTH / 16);
+
+    for ( size_t offset = 0 ; offset < length_ ; offset += chunk_bytes ) {
+        uint16_t latch_cache;
+        CriticalSection critical_section(*this);
+
+        // Check to see if device is in the proper state
+        if ( registerPair(ControlRegister::IODIRA) & (data_mask | clock_mask) ) { return; }
+
+        // Check cache for existing data
+        latch_cache = (getLatchValues() & ~clock_mask);
+
+        // Each bit costs two samples (data with clock LOW, then clock HIGH). The falling clock edge is merged with the next data bit, because the data is only sampled on the rising edge.
+        beginStream(latch_register, RegisterTransaction::WRITE, single_port);
+        for ( size_t i = offset ; i < length_ && i < (offset + chunk_bytes) ; ++i ) {
+            for ( unsigned int bit = 0 ; bit < 8 ; ++bit ) {
+                const unsigned int bit_pos(( LSBFIRST == bit_order_ ) ? bit : (7 - bit));
+
+                if ( (buffer_[i] >> bit_pos) & 0x01 ) {
+                    latch_cache |= data_mask;
+                } else {
+                    latch_cache &= ~data_mask;
+                }
+
+                if ( single_port ) {
+                    ::SPI.transfer(latch_cache >> port_shift);
+                    ::SPI.transfer((latch_cache | clock_mask) >> port_shift);
+                } else {
+                    ::SPI.transfer(latch_cache);  // GPIOA
+                    ::SPI.transfer(latch_cache >> 8);  // GPIOB
+                    ::SPI.transfer(latch_cache | clock_mask);  // GPIOA
+                    ::SPI.transfer((latch_cache | clock_mask) >> 8);  // GPIOB
+                }
+            }
+        }
+
+        // Return the clock to idle
+        if ( single_port ) {
+            ::SPI.transfer(latch_cache >> port_shift);
+        } else {
+            ::SPI.transfer(latch_cache);  // GPIOA
+            ::SPI.transfer(latch_cache >> 8);  // GPIOB
+        }
+        endStream(single_port);
+
+        _control_register[static_cast<uint8_t>(ControlRegister::GPIOA_)] = latch_cache;
+        _control_register[static_cast<uint8_t>(ControlRegister::GPIOB_)] = (latch_cache >> 8);
+    }
+
+    return;
+}
+
+void
+mcp23s17::unwatch (
+    const uint16_t mask_
+) {
+    CriticalSection critical_section(*this);
+    return writeRegisterPair(ControlRegister::GPINTENA, (registerPair(ControlRegister::GPINTENA) & ~mask_));
+}
+
+uint16_t
+mcp23s17::waitForAny (
+    const uint16_t mask_,
+    const uint16_t pattern_,
+    const unsigned long timeout_ms_
+) {
+    const unsigned long start_ms(elapsedMilliseconds());
+    unsigned int dispatch_count(_dispatch_count);
+    uint16_t mask;
+    uint16_t enable;
+    uint16_t default_value;
+    uint16_t control;
+    uint16_t matched;
+
+    {
+        CriticalSection critical_section(*this);
+
+        // Interrupt-on-change is only available to inputs
+        mask = (mask_ & registerPair(ControlRegister::IODIRA));
+        if ( !mask ) { return 0x0000; }
+        enable = registerPair(ControlRegister::GPINTENA);
+        default_value = registerPair(ControlRegister::DEFVALA);
+        control = registerPair(ControlRegister::INTCONA);
+
+        // Arm before sampling, so a level reached after the sample raises the interrupt
+        watch(pattern_, mask, WatchMode::REACH);
+    }
+    matched = (~(digitalReadPorts(mask) ^ pattern_) & mask);
 
-        ::digitalWrite(SS, LOW);
-        ::SPI.transfer(_SPI_BUS_ADDRESS | static_cast<uint8_t>(RegisterTransaction::WRITE));
-        ::SPI.transfer(static_cast<uint8_t>(pullup_register));
-        ::SPI.transfer(pullup_register_cache);
+    while ( !matched && waitForDispatch(dispatch_count, start_ms, timeout_ms_) ) {
+        InterruptSnapshot snapshot;
+        {
+            CriticalSection critical_section(*this);
+            snapshot = _interrupt_snapshot;
+        }
+        matched = (((snapshot.flags & ~(snapshot.capture ^ pattern_)) | ~(snapshot.levels ^ pattern_)) & mask);
+    }
+
+    // Restore the configuration of the watched pins, and only theirs
+    {
+        CriticalSection critical_section(*this);
+        writeInterruptConfiguration(
+            ((registerPair(ControlRegister::GPINTENA) & ~mask) | (enable & mask)),
+            ((registerPair(ControlRegister::DEFVALA) & ~mask) | (default_value & mask)),
+            ((registerPair(ControlRegister::INTCONA) & ~mask) | (control & mask))
+        );
+    }
+
+    return matched;
+}
+
+bool
+mcp23s17::waitForPin (
+    const uint8_t pin_,
+    const PinLatchValue value_,
+    const unsigned long timeout_ms_
+) {
+    if ( pin_ >= PIN_COUNT ) { return false; }
+    const uint16_t pin_mask(static_cast<uint16_t>(1) << pin_);
+
+    return waitForAny(pin_mask, (( PinLatchValue::HIGH == value_ ) ? pin_mask : 0x0000), timeout_ms_);
+}
+
+void
+mcp23s17::watch (
+    const uint16_t pattern_,
+    const uint16_t mask_,
+    const WatchMode mode_
+) {
+    // The chip signals a mismatch, so a match is watched for by comparing against the complement
+    const uint16_t default_value(( WatchMode::REACH == mode_ ) ? ~pattern_ : pattern_);
+
+    if ( !mask_ ) { return; }
+    CriticalSection critical_section(*this);
+
+    // Merge with the existing configuration of the unwatched pins
+    return writeInterruptConfiguration(
+        (registerPair(ControlRegister::GPINTENA) | mask_),
+        ((registerPair(ControlRegister::DEFVALA) & ~mask_) | (default_value & mask_)),
+        (registerPair(ControlRegister::INTCONA) | mask_)
+    );
+}
+
+uint16_t
+mcp23s17::completeDigitalReadPorts (
+    const uint16_t mask_,
+    const uint8_t * const frame_
+) const {
+    if ( mask_ & 0x00FF ) {
+        return (frame_[2] | (( mask_ & 0xFF00 ) ? (static_cast<uint16_t>(frame_[3]) << 8) : 0x0000));
+    } else {
+        return (static_cast<uint16_t>(frame_[2]) << 8);
+    }
+}
+
+mcp23s17::InterruptSnapshot
+mcp23s17::completeServiceInterrupts (
+    const uint8_t * const frame_
+) {
+    InterruptSnapshot snapshot;
+    isr_t interrupt_service_routines[PIN_COUNT];
+
+    {
+        CriticalSection critical_section(*this);
+        _interrupt_snapshot.flags = (frame_[2] | (frame_[3] << 8));
+        _interrupt_snapshot.capture = (frame_[4] | (frame_[5] << 8));
+        _interrupt_snapshot.levels = (frame_[6] | (frame_[7] << 8));
+        snapshot = _interrupt_snapshot;
+        for ( uint8_t pin = 0 ; pin < PIN_COUNT ; ++pin ) { interrupt_service_routines[pin] = _interrupt_service_routines[pin]; }
+#if !defined(MCP23S17_HOST)
+        ++_dispatch_count;
+#endif
+    }
+
+    // Wake the callers of `waitForAny`
+#if defined(MCP23S17_HOST)
+    {
+        std::lock_guard<std::mutex> lock(_dispatch_mutex);
+        ++_dispatch_count;
+    }
+    _dispatched.notify_all();
+#endif
+
+    // Dispatch outside of the critical section, so the callbacks are free to drive the device
+    for ( uint8_t pin = 0 ; pin < PIN_COUNT ; ++pin ) {
+        if ( !((snapshot.flags >> pin) & 0x01) ) { continue; }
+        if ( !interrupt_service_routines[pin] ) { continue; }
+        interrupt_service_routines[pin]();
+    }
+
+    return snapshot;
+}
+
+void
+mcp23s17::failDigitalWritePorts (
+    void
+) {
+    CriticalSection critical_section(*this);
+    _latches_unconfirmed = true;
+
+    return;
+}
+
+size_t
+mcp23s17::prepareDigitalReadPorts (
+    const uint16_t mask_,
+    uint8_t * const frame_
+) const {
+    const bool read_port_a(mask_ & 0x00FF);
+    const bool read_port_b(mask_ & 0xFF00);
+    size_t length(0);
+
+    if ( !read_port_a && !read_port_b ) { return 0; }
+
+    // The address pointer increments from port A to port B (the trailing bytes are arbitrary, and only flush the result buffer)
+    frame_[length++] = (_SPI_BUS_ADDRESS | static_cast<uint8_t>(RegisterTransaction::READ));
+    if ( read_port_a ) {
+        frame_[length++] = static_cast<uint8_t>(ControlRegister::GPIOA_);
+        frame_[length++] = static_cast<uint8_t>(ControlRegister::GPIOA_);
+        if ( read_port_b ) { frame_[length++] = static_cast<uint8_t>(ControlRegister::GPIOB_); }
+    } else {
+        frame_[length++] = static_cast<uint8_t>(ControlRegister::GPIOB_);
+        frame_[length++] = static_cast<uint8_t>(ControlRegister::GPIOB_);
+    }
+
+    return length;
+}
+
+size_t
+mcp23s17::prepareDigitalWritePorts (
+    const uint16_t values_,
+    const uint16_t mask_,
+    uint8_t * const frame_
+) {
+    // Pins configured as INPUT are never updated
+    const uint16_t output_mask(mask_ & ~registerPair(ControlRegister::IODIRA));
+    const uint16_t latch_cache((getLatchValues() & ~output_mask) | (values_ & output_mask));
+    size_t length(prepareRegisterPair(ControlRegister::GPIOA_, latch_cache, frame_));
+
+    // A failed write may have left the chip behind the cache, so both ports are sent
+    if ( _latches_unconfirmed ) {
+        _latches_unconfirmed = false;
+        length = 0;
+        frame_[length++] = (_SPI_BUS_ADDRESS | static_cast<uint8_t>(RegisterTransaction::WRITE));
+        frame_[length++] = static_cast<uint8_t>(ControlRegister::GPIOA_);
+        frame_[length++] = static_cast<uint8_t>(latch_cache);
+        frame_[length++] = static_cast<uint8_t>(latch_cache >> 8);
+    }
+
+    return length;
+}
+
+size_t
+mcp23s17::prepareServiceInterrupts (
+    uint8_t * const frame_
+) const {
+    size_t length(0);
+
+    // INTFA, INTFB, INTCAPA, INTCAPB, GPIOA, GPIOB (the trailing bytes are arbitrary, and only flush the result buffer)
+    frame_[length++] = (_SPI_BUS_ADDRESS | static_cast<uint8_t>(RegisterTransaction::READ));
+    while ( length < 8 ) { frame_[length++] = static_cast<uint8_t>(ControlRegister::INTFA); }
+
+    return length;
+}
+
+#if defined(MCP23S17_HOST)
+
+mcp23s17::CriticalSection::CriticalSection (
+    mcp23s17 const & gpio_x_
+) :
+    _gpio_x(gpio_x_)
+{
+    const std::thread::id self(std::this_thread::get_id());
+    std::thread::id unlocked;
+
+    // A shared bus serializes every frame on it, which includes those of this device
+    if ( _gpio_x._bus ) {
+        _gpio_x._bus->acquire();
+        return;
+    }
+
+    // Only the owner could have stored its own id, so reentry is detected without synchronization
+    if ( self == _gpio_x._lock_owner.load(std::memory_order_relaxed) ) {
+        ++_gpio_x._lock_depth;
+        return;
+    }
+    while ( !_gpio_x._lock_owner.compare_exchange_weak(unlocked, self, std::memory_order_acquire, std::memory_order_relaxed) ) {
+        unlocked = std::thread::id();
+        std::this_thread::yield();
+    }
+}
+
+mcp23s17::CriticalSection::~CriticalSection (
+    void
+) {
+    if ( _gpio_x._bus ) {
+        _gpio_x._bus->release();
+    } else if ( _gpio_x._lock_depth ) {
+        --_gpio_x._lock_depth;
+    } else {
+        _gpio_x._lock_owner.store(std::thread::id(), std::memory_order_release);
+    }
+}
+
+#elif defined(__AVR__)
+
+mcp23s17::CriticalSection::CriticalSection (
+    mcp23s17 const &
+) :
+    _interrupt_state(SREG)
+{
+    cli();
+}
+
+mcp23s17::CriticalSection::~CriticalSection (
+    void
+) {
+    SREG = _interrupt_state;
+}
+
+#elif defined(__arm__)
+
+mcp23s17::CriticalSection::CriticalSection (
+    mcp23s17 const &
+) :
+    _interrupt_state(__get_PRIMASK())
+{
+    __disable_irq();
+}
+
+mcp23s17::CriticalSection::~CriticalSection (
+    void
+) {
+    __set_PRIMASK(_interrupt_state);
+}
+
+#elif defined(ESP8266)
+
+mcp23s17::CriticalSection::CriticalSection (
+    mcp23s17 const &
+) :
+    _interrupt_state(xt_rsil(15))
+{}
+
+mcp23s17::CriticalSection::~CriticalSection (
+    void
+) {
+    xt_wsr_ps(_interrupt_state);
+}
+
+#elif defined(ARDUINO) || defined(SPARK)
+
+mcp23s17::CriticalSection::CriticalSection (
+    mcp23s17 const &
+) :
+    _interrupt_state(0)
+{
+    noInterrupts();
+    ++critical_section_depth;
+}
+
+mcp23s17::CriticalSection::~CriticalSection (
+    void
+) {
+    // The previous mask is unknown, so interrupts are enabled as the outermost section exits
+    if ( !--critical_section_depth ) { interrupts(); }
+}
+
+#else
+
+  #error "mcp23s17: CriticalSection requires noInterrupts() and interrupts() on this core"
+
+#endif
+
+void
+mcp23s17::beginStream (
+    const ControlRegister register_,
+    const RegisterTransaction transaction_,
+    const bool single_port_
+) {
+    setStreamMode(single_port_);
+    openStream(register_, transaction_, single_port_);
+
+    return;
+}
+
+void
+mcp23s17::endStream (
+    const bool single_port_
+) {
+    ::digitalWrite(SS, HIGH);
+    restoreStreamMode(single_port_);
+
+    return;
+}
+
+void
+mcp23s17::openStream (
+    const ControlRegister register_,
+    const RegisterTransaction transaction_,
+    const bool single_port_
+) {
+    ::digitalWrite(SS, LOW);
+    ::SPI.transfer(_SPI_BUS_ADDRESS | static_cast<uint8_t>(transaction_));
+    ::SPI.transfer(single_port_ ? bankOneAddress(register_) : static_cast<uint8_t>(register_));
+
+    return;
+}
+
+size_t
+mcp23s17::prepareRegisterPair (
+    const ControlRegister register_,
+    const uint16_t value_,
+    uint8_t * const frame_
+) {
+    const uint8_t register_a(static_cast<uint8_t>(register_));
+    const uint8_t register_b(register_a + 1);
+    const bool port_a_changed(_control_register[register_a] != static_cast<uint8_t>(value_));
+    const bool port_b_changed(_control_register[register_b] != static_cast<uint8_t>(value_ >> 8));
+    size_t length(0);
+
+    // Test to see if either port requires an update
+    if ( !port_a_changed && !port_b_changed ) { return 0; }
+    _control_register[register_a] = value_;
+    _control_register[register_b] = (value_ >> 8);
+
+    // The address pointer increments from port A to port B
+    frame_[length++] = (_SPI_BUS_ADDRESS | static_cast<uint8_t>(RegisterTransaction::WRITE));
+    if ( port_a_changed ) {
+        frame_[length++] = register_a;
+        frame_[length++] = value_;
+        if ( port_b_changed ) { frame_[length++] = (value_ >> 8); }
+    } else {
+        frame_[length++] = register_b;
+        frame_[length++] = (value_ >> 8);
+    }
+
+    return length;
+}
+
+void
+mcp23s17::restoreStreamMode (
+    const bool single_port_
+) {
+    // IOCON is found at a different address while IOCON.BANK = 1
+    ::digitalWrite(SS, LOW);
+    ::SPI.transfer(_SPI_BUS_ADDRESS | static_cast<uint8_t>(RegisterTransaction::WRITE));
+    ::SPI.transfer(single_port_ ? bankOneAddress(ControlRegister::IOCONA) : static_cast<uint8_t>(ControlRegister::IOCONA));
+    ::SPI.transfer(_control_register[static_cast<uint8_t>(ControlRegister::IOCONA)]);
+    ::digitalWrite(SS, HIGH);
+
+    return;
+}
+
+void
+mcp23s17::setStreamMode (
+    const bool single_port_
+) {
+    uint8_t stream_configuration(_control_register[static_cast<uint8_t>(ControlRegister::IOCONA)] | static_cast<uint8_t>(IOConfigurationRegister::SEQOP));
+
+    // IOCON.BANK = 1 fixes the address pointer on a single register, whereas IOCON.BANK = 0 toggles it between the A/B pair
+    if ( single_port_ ) { stream_configuration |= static_cast<uint8_t>(IOConfigurationRegister::BANK); }
+
+    ::digitalWrite(SS, LOW);
+    ::SPI.transfer(_SPI_BUS_ADDRESS | static_cast<uint8_t>(RegisterTransaction::WRITE));
+    ::SPI.transfer(static_cast<uint8_t>(ControlRegister::IOCONA));
+    ::SPI.transfer(stream_configuration);
+    ::digitalWrite(SS, HIGH);
+
+    return;
+}
+
+bool
+mcp23s17::transferFrame (
+    uint8_t * const frame_,
+    const size_t length_
+) const {
+    if ( _transport ) {
+        spi_transport::Frame frame{ { 0 }, static_cast<uint8_t>(length_), nullptr, nullptr, false };
+        bool exchanged;
+
+        for ( size_t i = 0 ; i < length_ ; ++i ) { frame.data[i] = frame_[i]; }
+        exchanged = _transport->transfer(frame);
+        for ( size_t i = 0 ; i < length_ ; ++i ) { frame_[i] = ( exchanged ? frame.data[i] : 0x00 ); }
+
+        return exchanged;
+    }
+
+    ::digitalWrite(SS, LOW);
+    for ( size_t i = 0 ; i < length_ ; ++i ) {
+        frame_[i] = ::SPI.transfer(frame_[i]);
+    }
+    ::digitalWrite(SS, HIGH);
+
+    return true;
+}
+
+bool
+mcp23s17::waitForDispatch (
+    unsigned int & dispatch_count_,
+    const unsigned long start_ms_,
+    const unsigned long timeout_ms_
+) {
+#if defined(MCP23S17_HOST)
+    std::unique_lock<std::mutex> lock(_dispatch_mutex);
+#endif
+
+    for (;;) {
+        const unsigned int dispatch_count(_dispatch_count);
+        const unsigned long elapsed_ms(elapsedMilliseconds() - start_ms_);
+
+        if ( dispatch_count != dispatch_count_ ) {
+            dispatch_count_ = dispatch_count;
+            return true;
+        }
+        if ( elapsed_ms >= timeout_ms_ ) { return false; }
+#if defined(MCP23S17_HOST)
+        _dispatched.wait_for(lock, std::chrono::milliseconds(timeout_ms_ - elapsed_ms));
+#else
+        // Any interrupt wakes the core, including the tick advancing `millis`, so the timeout is honored
+        lowPowerWait();
+#endif
+    }
+}
+
+void
+mcp23s17::writeInterruptConfiguration (
+    const uint16_t enable_,
+    const uint16_t default_value_,
+    const uint16_t control_
+) {
+    const uint16_t registers[] = { enable_, default_value_, control_ };
+    const uint8_t gpintena(static_cast<uint8_t>(ControlRegister::GPINTENA));
+    uint8_t frame[MAX_FRAME_LENGTH];
+    size_t length(0);
+
+    // Send data (GPINTENA, GPINTENB, DEFVALA, DEFVALB, INTCONA, INTCONB)
+    frame[length++] = (_SPI_BUS_ADDRESS | static_cast<uint8_t>(RegisterTransaction::WRITE));
+    frame[length++] = gpintena;
+    for ( unsigned int i = 0 ; i < (sizeof(registers) / sizeof(registers[0])) ; ++i ) {
+        _control_register[gpintena + (2 * i)] = registers[i];
+        _control_register[gpintena + (2 * i) + 1] = (registers[i] >> 8);
+        frame[length++] = static_cast<uint8_t>(registers[i]);
+        frame[length++] = static_cast<uint8_t>(registers[i] >> 8);
+    }
+    transferFrame(frame, length);
+
+    return;
+}
+
+void
+mcp23s17::writeRegisterPair (
+    const ControlRegister register_,
+    const uint16_t value_
+) {
+    uint8_t frame[MAX_FRAME_LENGTH];
+    const size_t length(prepareRegisterPair(register_, value_, frame));
+
+    if ( !length ) { return; }
+    transferFrame(frame, length);
+
+    return;
+}
+
+mcp23s17::WriteStream::WriteStream (
+    mcp23s17 & gpio_x_,
+    const uint16_t mask_
+) :
+    _gpio_x(gpio_x_),
+#if defined(MCP23S17_HOST)
+    _critical_section(gpio_x_),
+#endif
+    _mask(mask_),
+    _single_port(!(mask_ & 0x00FF) || !(mask_ & 0xFF00)),
+    _port_shift(( _single_port && (mask_ & 0xFF00) ) ? 8 : 0)
+{
+    if ( !_gpio_x.isStreamCapable() ) { return; }
+    CriticalSection critical_section(_gpio_x);
+    _gpio_x.setStreamMode(_single_port);
+}
+
+mcp23s17::WriteStream::~WriteStream (
+    void
+) {
+    if ( !_gpio_x.isStreamCapable() ) { return; }
+    CriticalSection critical_section(_gpio_x);
+    _gpio_x.restoreStreamMode(_single_port);
+}
+
+void
+mcp23s17::WriteStream::write (
+    const uint8_t * const buffer_,
+    const size_t length_
+) {
+    if ( !buffer_ || !length_ ) { return; }
+    if ( !_single_port ) { return; }
+    if ( !_gpio_x.isStreamCapable() ) { return; }
+
+    // Interrupts are masked for a single chunk at a time
+    for ( size_t offset = 0 ; offset < length_ ; offset += STREAM_CHUNK_LENGTH ) {
+        const size_t end(offset + streamChunkLength(length_ - offset));
+        CriticalSection critical_section(_gpio_x);
+
+        // Pins configured as INPUT, and pins outside of the session, are never updated
+        const uint16_t update_mask(_mask & ~_gpio_x.registerPair(ControlRegister::IODIRA));
+        uint16_t latch_cache(_gpio_x.getLatchValues());
+
+        _gpio_x.openStream((_port_shift ? ControlRegister::GPIOB_ : ControlRegister::GPIOA_), RegisterTransaction::WRITE, true);
+        for ( size_t i = offset ; i < end ; ++i ) {
+            latch_cache = ((latch_cache & ~update_mask) | ((static_cast<uint16_t>(buffer_[i]) << _port_shift) & update_mask));
+            transferSample(latch_cache);
+        }
+        ::digitalWrite(SS, HIGH);
+
+        _gpio_x._control_register[static_cast<uint8_t>(ControlRegister::GPIOA_)] = latch_cache;
+        _gpio_x._control_register[static_cast<uint8_t>(ControlRegister::GPIOB_)] = (latch_cache >> 8);
+    }
+
+    return;
+}
+
+void
+mcp23s17::WriteStream::write (
+    const uint16_t * const buffer_,
+    const size_t length_
+) {
+    if ( !buffer_ || !length_ ) { return; }
+    if ( !_gpio_x.isStreamCapable() ) { return; }
+
+    // Interrupts are masked for a single chunk at a time
+    for ( size_t offset = 0 ; offset < length_ ; offset += STREAM_CHUNK_LENGTH ) {
+        const size_t end(offset + streamChunkLength(length_ - offset));
+        CriticalSection critical_section(_gpio_x);
+
+        // Pins configured as INPUT, and pins outside of the session, are never updated
+        const uint16_t update_mask(_mask & ~_gpio_x.registerPair(ControlRegister::IODIRA));
+        uint16_t latch_cache(_gpio_x.getLatchValues());
+
+        _gpio_x.openStream((_port_shift ? ControlRegister::GPIOB_ : ControlRegister::GPIOA_), RegisterTransaction::WRITE, _single_port);
+        for ( size_t i = offset ; i < end ; ++i ) {
+            latch_cache = ((latch_cache & ~update_mask) | (buffer_[i] & update_mask));
+            transferSample(latch_cache);
+        }
         ::digitalWrite(SS, HIGH);
+
+        _gpio_x._control_register[static_cast<uint8_t>(ControlRegister::GPIOA_)] = latch_cache;
+        _gpio_x._control_register[static_cast<uint8_t>(ControlRegister::GPIOB_)] = (latch_cache >> 8);
+    }
+
+    return;
+}
+
+void
+mcp23s17::WriteStream::transferSample (
+    const uint16_t sample_
+) const {
+    if ( _single_port ) {
+        ::SPI.transfer(sample_ >> _port_shift);
+    } else {
+        ::SPI.transfer(sample_);  // GPIOA
+        ::SPI.transfer(sample_ >> 8);  // GPIOB
     }
 
     return;
@@ -3,8 +3,24 @@
 #ifndef MCP23S17_H
 #define MCP23S17_H
 
+#include <cstddef>
 #include <cstdint>
 
+#if !defined(ARDUINO) && !defined(SPARK)
+  #define MCP23S17_HOST
+#endif
+
+#if defined(MCP23S17_HOST)
+  #include <atomic>
+  #include <condition_variable>
+  #include <mutex>
+  #include <thread>
+
+  class spi_bus;
+#endif
+
+class spi_transport;
+
 class mcp23s17 {
   public:
     // Definition(s)
@@ -63,6 +79,22 @@ class mcp23s17 {
         RISING,
     };
 
+    /// \brief Interrupt Configuration
+    /// \note Describes a single pin for `attachInterrupts`
+    struct InterruptConfiguration {
+        uint8_t pin;  ///< The number associated with the pin
+        isr_t interrupt_service_routine;  ///< The callback to be fired when the interrupt occurs
+        InterruptMode mode;  ///< The mode of the interrupt
+    };
+
+    /// \brief Interrupt Snapshot
+    /// \note Port A occupies the low byte, port B the high byte
+    struct InterruptSnapshot {
+        uint16_t flags;  ///< INTF - The pins that caused the interrupt
+        uint16_t capture;  ///< INTCAP - The pin levels when the interrupt occurred
+        uint16_t levels;  ///< GPIO - The pin levels when the interrupt was serviced
+    };
+
     /// \brief I/O Control Register
     /// \n Unimplemented (bit 0) - Read as ‘0’.
     /// \n INTPOL (bit 1) - This bit sets the polarity of the INT output pin.
@@ -114,22 +146,83 @@ class mcp23s17 {
         INPUT_PULLUP,
     };
 
+    /// \brief GPIO Ports
+    /// \note Pins 0-7 belong to port A, pins 8-15 belong to port B
+    enum class Port : uint8_t {
+        A = 0,
+        B,
+    };
+
     /// \brief Register Transaction Flag
     enum class RegisterTransaction : uint8_t {
         WRITE = 0,
         READ,
     };
 
+    /// \brief Watch Mode
+    /// \n - LEAVE - Signal when any watched pin differs from the pattern
+    /// \n - REACH - Signal when any watched pin matches the pattern
+    enum class WatchMode {
+        LEAVE = 0,
+        REACH,
+    };
+
+    /// \brief Streaming session (see below)
+    class WriteStream;
+
     // Constructor and destructor method(s)
 
     /// \brief Object Constructor
     /// \param [in] hw_addr_ The hardware address of the device
+    /// \param [in] bus_ The bus shared with other devices and threads (host
+    /// platforms only). Each frame holds the bus, instead of the device.
     mcp23s17 (
         const HardwareAddress hw_addr_
+#if defined(MCP23S17_HOST)
+        ,
+        spi_bus * const bus_ = nullptr
+#endif
+    );
+
+    /// \brief Object Constructor
+    /// \param [in] hw_addr_ The hardware address of the device
+    /// \param [in] transport_ Exchanges every frame (see
+    /// `spi_transport::transfer`), so a device behind a transport that
+    /// cannot reach `SPI` (e.g. `spidev_transport`) never touches `SPI`
+    /// \param [in] bus_ The bus shared with other devices and threads (host
+    /// platforms only). Each frame holds the bus, instead of the device.
+    /// \note The streaming methods are unavailable unless the transport
+    /// is stream capable (see `isStreamCapable`)
+    mcp23s17 (
+        const HardwareAddress hw_addr_,
+        spi_transport & transport_
+#if defined(MCP23S17_HOST)
+        ,
+        spi_bus * const bus_ = nullptr
+#endif
     );
 
     // Accessor method(s)
 
+    /// \brief Cached output latch values
+    /// \return The latch values of port A (low byte) and port B (high byte)
+    inline
+    uint16_t
+    getLatchValues (
+        void
+    ) const {
+        return (_control_register[static_cast<uint8_t>(ControlRegister::GPIOA_)] | (_control_register[static_cast<uint8_t>(ControlRegister::GPIOB_)] << 8));
+    }
+
+    /// \brief Snapshot taken by the most recent call to `serviceInterrupts`
+    inline
+    InterruptSnapshot const &
+    getInterruptSnapshot (
+        void
+    ) const {
+        return _interrupt_snapshot;
+    }
+
     /// \brief Hardware address of device
     /// \return Hardware address of the device
     inline
@@ -140,9 +233,20 @@ class mcp23s17 {
         return _SPI_BUS_ADDRESS;
     }
 
+    /// \brief Whether the streaming methods (`digitalReadStream`,
+    /// `digitalWriteStream`, `shiftOut` and `WriteStream`) are available
+    /// \note Streams hold chip select across a whole session, so they
+    /// require `SPI`, and have no effect otherwise
+    bool
+    isStreamCapable (
+        void
+    ) const;
+
     // Public instance variable(s)
+    static const uint8_t MAX_FRAME_LENGTH = 8;
     static const uint8_t PIN_COUNT = 16;
     static const uint8_t SPI_BASE_ADDRESS = 0x40;
+    static const uint8_t STREAM_CHUNK_LENGTH = 64;  ///< The most samples streamed per critical section
 
     // Public method(s)
 
@@ -155,6 +259,8 @@ class mcp23s17 {
     /// \n - HIGH - Signal when pin state is HIGH
     /// \n - LOW - Signal when pin state is LOW
     /// \n - RISING - Signal when pin transistions from LOW to HIGH
+    /// \note Invalid pins are ignored, and the interrupt configuration of
+    /// the other pins is retained
     void
     attachInterrupt (
         const uint8_t pin_,
@@ -162,6 +268,52 @@ class mcp23s17 {
         const InterruptMode mode_
     );
 
+    /// \brief Attach the same interrupt to several pins at once
+    /// \param [in] mask_ The pins to attach
+    /// \param [in] interrupt_service_routine_ The callback to be fired when the interrupt occurs
+    /// \param [in] mode_ The mode of the interrupt (see `attachInterrupt`)
+    /// \note Only the bits of the attached pins change in GPINTEN,
+    /// DEFVAL and INTCON (as when attaching each pin with
+    /// `attachInterrupt`), and the final images are written in a single
+    /// 8-byte transaction
+    void
+    attachInterrupts (
+        const uint16_t mask_,
+        const isr_t interrupt_service_routine_,
+        const InterruptMode mode_
+    );
+
+    /// \brief Attach interrupts described per pin
+    /// \param [in] configurations_ The pin, callback and mode of each interrupt
+    /// \param [in] count_ The number of configurations
+    /// \note The final images are written in a single 8-byte transaction
+    /// \note Configurations of invalid pins are ignored
+    void
+    attachInterrupts (
+        const InterruptConfiguration * const configurations_,
+        const size_t count_
+    );
+
+    /// \brief Detach interrupt from specified pin
+    /// \param [in] pin_ The number associated with the pin
+    /// \note Only the GPINTEN register of the pin's port is written (a
+    /// 3-byte transaction), and nothing is sent if the pin was not
+    /// enabled. INTCON and DEFVAL are ignored while a pin is disabled, so
+    /// they are left untouched.
+    void
+    detachInterrupt (
+        const uint8_t pin_
+    );
+
+    /// \brief Detach the interrupts of several pins at once
+    /// \param [in] mask_ The pins to detach
+    /// \note Only GPINTEN is updated (DEFVAL and INTCON are ignored
+    /// while a pin is disabled), using the fewest bytes possible
+    void
+    detachInterrupts (
+        const uint16_t mask_
+    );
+
     /// \brief Read from GPIO pins
     /// \param [in] pin_ The number associated with the pin
     /// \return HIGH or LOW based on the voltage level on the pin
@@ -170,6 +322,53 @@ class mcp23s17 {
         const uint8_t pin_
     ) const;
 
+    /// \brief Read both GPIO ports at once
+    /// \param [in] mask_ The pins of interest
+    /// \return The levels of port A (low byte) and port B (high byte)
+    /// \note Only the ports containing pins of interest are read. A
+    /// single port costs a 3-byte transaction, while both ports share a
+    /// 4-byte transaction. Unread ports are returned as LOW.
+    uint16_t
+    digitalReadPorts (
+        const uint16_t mask_ = 0xFFFF
+    ) const;
+
+    /// \brief Capture consecutive samples of a single GPIO port
+    /// \param [in] port_ The port to sample
+    /// \param [out] buffer_ The caller supplied buffer to receive the samples
+    /// \param [in] length_ The number of samples to capture
+    /// \return The estimated period between samples in nanoseconds
+    /// \note Chip select is held for each chunk of `STREAM_CHUNK_LENGTH`
+    /// samples and IOCON.BANK and IOCON.SEQOP are set, so each sample
+    /// costs a single byte on the bus. The original IOCON value is
+    /// restored after each chunk, and interrupts are only masked for one
+    /// chunk at a time, so `millis()` and `micros()` keep time.
+    /// \note The estimate is derived from `micros()`, so short captures
+    /// are subject to its resolution. Only the time spent within the
+    /// chunks is counted, so the samples of longer captures are evenly
+    /// spaced within each chunk, but not across chunks.
+    uint32_t
+    digitalReadStream (
+        const Port port_,
+        uint8_t * const buffer_,
+        const size_t length_
+    );
+
+    /// \brief Capture consecutive samples of both GPIO ports
+    /// \param [out] buffer_ The caller supplied buffer to receive the
+    /// samples (port A in the low byte, port B in the high byte)
+    /// \param [in] length_ The number of samples to capture
+    /// \return The estimated period between samples in nanoseconds
+    /// \note Chip select is held for each chunk of `STREAM_CHUNK_LENGTH`
+    /// samples and IOCON.SEQOP is set, so the address pointer toggles
+    /// between GPIOA and GPIOB. The original IOCON value is restored
+    /// after each chunk.
+    uint32_t
+    digitalReadStream (
+        uint16_t * const buffer_,
+        const size_t length_
+    );
+
     /// \brief Write HIGH or LOW on pins
     /// \param [in] pin_ The number associated with the pin
     /// \param [in] value_ The value set to the latch
@@ -181,6 +380,54 @@ class mcp23s17 {
         const PinLatchValue value_
     );
 
+    /// \brief Write both GPIO ports at once
+    /// \param [in] values_ The latch values of port A (low byte) and
+    /// port B (high byte)
+    /// \param [in] mask_ The pins to be updated (pins configured as
+    /// INPUT are never updated)
+    /// \note Only the ports that change are sent. A single port costs a
+    /// 3-byte transaction, while both ports share a 4-byte transaction.
+    void
+    digitalWritePorts (
+        const uint16_t values_,
+        const uint16_t mask_ = 0xFFFF
+    );
+
+    /// \brief Stream values to a single GPIO port
+    /// \param [in] port_ The port to receive the values
+    /// \param [in] buffer_ The values to be latched, in order (pins
+    /// configured as INPUT are never updated)
+    /// \param [in] length_ The number of values in the buffer
+    /// \note IOCON.BANK and IOCON.SEQOP are set for the duration of the
+    /// transfer, so the address pointer stays on the port register and
+    /// each value costs a single byte on the bus. Each chunk of
+    /// `STREAM_CHUNK_LENGTH` values is a transaction of its own, after
+    /// which the original IOCON value is restored, so interrupts are only
+    /// masked for one chunk at a time.
+    /// \note The final value is retained as the cached port latch.
+    void
+    digitalWriteStream (
+        const Port port_,
+        const uint8_t * const buffer_,
+        const size_t length_
+    );
+
+    /// \brief Stream values to both GPIO ports
+    /// \param [in] buffer_ The values to be latched, in order (port A
+    /// in the low byte, port B in the high byte, pins configured as
+    /// INPUT are never updated)
+    /// \param [in] length_ The number of values in the buffer
+    /// \note IOCON.SEQOP is set for the duration of the transfer, so the
+    /// address pointer toggles between GPIOA and GPIOB. Each chunk of
+    /// `STREAM_CHUNK_LENGTH` values is a transaction of its own, after
+    /// which the original IOCON value is restored.
+    /// \note The final value is retained as the cached port latches.
+    void
+    digitalWriteStream (
+        const uint16_t * const buffer_,
+        const size_t length_
+    );
+
     /// \brief Set pin mode
     /// \param [in] pin_ The number associated with the pin
     /// \param [in] mode_ The direction to set the GPIO pins
@@ -194,9 +441,241 @@ class mcp23s17 {
         const PinMode mode_
     );
 
+    /// \brief Configure a pin as OUTPUT with an initial value
+    /// \param [in] pin_ The number associated with the pin
+    /// \param [in] value_ The value set to the latch before the pin is
+    /// driven
+    /// \note See `pinModesOutput`
+    void
+    pinModeOutput (
+        const uint8_t pin_,
+        const PinLatchValue value_
+    );
+
+    /// \brief Set the mode of several pins at once
+    /// \param [in] mask_ The pins to configure
+    /// \param [in] mode_ The direction to set the GPIO pins (see `pinMode`)
+    /// \note The final IODIR and GPPU images are computed first, then
+    /// each register pair is sent with the fewest bytes possible (at most
+    /// two 4-byte transactions, and nothing when the cache already holds
+    /// the images)
+    void
+    pinModes (
+        const uint16_t mask_,
+        const PinMode mode_
+    );
+
+    /// \brief Set the mode of consecutive pins, starting at pin 0
+    /// \param [in] modes_ The direction of each pin (see `pinMode`)
+    /// \param [in] count_ The number of pins to configure
+    /// \note Sent as described for the mask overload
+    void
+    pinModes (
+        const PinMode * const modes_,
+        const size_t count_
+    );
+
+    /// \brief Configure several pins as OUTPUT with initial values
+    /// \param [in] mask_ The pins to configure
+    /// \param [in] values_ The latch values of port A (low byte) and
+    /// port B (high byte)
+    /// \note OLATA, OLATB, IODIRA and IODIRB are consecutive in
+    /// sequential mode (the address pointer rolls over from OLATB to
+    /// IODIRA), so the latches and directions are written in a single
+    /// transaction, latches first. A pin never drives a stale value, and
+    /// only the span of registers that change is sent (3-6 bytes).
+    void
+    pinModesOutput (
+        const uint16_t mask_,
+        const uint16_t values_
+    );
+
+    /// \brief Service a pending interrupt
+    /// \return The interrupt flags, captured levels, and current levels
+    /// of both ports
+    /// \note INTF, INTCAP and GPIO are contiguous, so they are read in a
+    /// single 8-byte transaction, which also clears the interrupt. The
+    /// callback of each flagged pin is then invoked.
+    InterruptSnapshot
+    serviceInterrupts (
+        void
+    );
+
+    /// \brief Shift a byte out of the expander one bit at a time
+    /// \param [in] data_pin_ The pin on which to output each bit
+    /// \param [in] clock_pin_ The pin to toggle once the data pin has been set
+    /// \param [in] bit_order_ The order in which to shift out the bits
+    /// \n - MSBFIRST => Most Significant Bit First
+    /// \n - LSBFIRST => Least Significant Bit First
+    /// \param [in] value_ The data to shift out
+    /// \note The complete data/clock sequence is emitted as a single
+    /// streaming transaction (see `digitalWriteStream`)
+    /// \note Both pins must be configured as OUTPUT, and the clock pin
+    /// is expected to idle LOW
+    void
+    shiftOut (
+        const uint8_t data_pin_,
+        const uint8_t clock_pin_,
+        const uint8_t bit_order_,
+        const uint8_t value_
+    );
+
+    /// \brief Shift several bytes out of the expander one bit at a time
+    /// \param [in] data_pin_ The pin on which to output each bit
+    /// \param [in] clock_pin_ The pin to toggle once the data pin has been set
+    /// \param [in] bit_order_ The order in which to shift out the bits
+    /// \param [in] buffer_ The data to shift out, in order
+    /// \param [in] length_ The number of bytes in the buffer
+    /// \note Each byte costs 16 samples, so the bytes are emitted in
+    /// streaming transactions of up to `STREAM_CHUNK_LENGTH / 16` bytes,
+    /// and the clock idles between them
+    void
+    shiftOut (
+        const uint8_t data_pin_,
+        const uint8_t clock_pin_,
+        const uint8_t bit_order_,
+        const uint8_t * const buffer_,
+        const size_t length_
+    );
+
+    /// \brief Stop watching pins
+    /// \param [in] mask_ The pins to stop watching
+    /// \note Only GPINTEN is updated, and nothing is sent when the pins
+    /// were not enabled
+    void
+    unwatch (
+        const uint16_t mask_
+    );
+
+    /// \brief Sleep until any of the pins reaches its level in a pattern
+    /// \param [in] mask_ The pins to wait for (INPUT pins only)
+    /// \param [in] pattern_ The awaited levels of port A (low byte) and
+    /// port B (high byte)
+    /// \param [in] timeout_ms_ The longest time to wait (milliseconds)
+    /// \return The pins that reached their level (0 upon timeout)
+    /// \note The pins are watched in hardware (see `watch`) and sampled
+    /// once, then the caller sleeps until an interrupt is dispatched by
+    /// `serviceInterrupts` (a condition variable on host platforms, a low
+    /// power wait on MCUs). The bus is idle until the interrupt fires or
+    /// the timeout expires. A level held only briefly is recognized from
+    /// the captured levels (INTCAP).
+    /// \note Whoever monitors INT must call `serviceInterrupts` (or
+    /// `serviceInterruptsAsync`), e.g. an interrupt handler or event loop
+    /// \note The interrupt configuration of the pins is restored upon
+    /// return, so it must not be changed while waiting
+    uint16_t
+    waitForAny (
+        const uint16_t mask_,
+        const uint16_t pattern_,
+        const unsigned long timeout_ms_
+    );
+
+    /// \brief Sleep until a pin reaches a level
+    /// \param [in] pin_ The number associated with the pin (INPUT only)
+    /// \param [in] value_ The awaited level
+    /// \param [in] timeout_ms_ The longest time to wait (milliseconds)
+    /// \return false upon timeout
+    /// \note See `waitForAny`
+    bool
+    waitForPin (
+        const uint8_t pin_,
+        const PinLatchValue value_,
+        const unsigned long timeout_ms_
+    );
+
+    /// \brief Watch the inputs for a pattern in hardware
+    /// \param [in] pattern_ The expected levels of port A (low byte) and
+    /// port B (high byte)
+    /// \param [in] mask_ The pins to watch (other pins retain their
+    /// interrupt configuration)
+    /// \param [in] mode_ The condition to signal
+    /// \n - LEAVE - Signal when any watched pin differs from the pattern
+    /// \n - REACH - Signal when any watched pin matches the pattern
+    /// \note The pattern is loaded into DEFVAL, and the watched pins are
+    /// switched to compare mode (INTCON) and enabled (GPINTEN). All six
+    /// registers are contiguous, so they are written in a single 8-byte
+    /// transaction. The bus remains idle until the interrupt fires.
+    /// \note The chip compares each pin independently, so REACH signals
+    /// as soon as any one watched pin matches. Confirm the complete
+    /// pattern from the snapshot returned by `serviceInterrupts`.
+    /// \note The interrupt remains asserted while the condition holds,
+    /// so the pattern should be updated (or the pins unwatched) when
+    /// servicing the interrupt.
+    /// \note `attachInterrupt` rewrites the DEFVAL bit of its pin, so watch
+    /// after attaching
+    void
+    watch (
+        const uint16_t pattern_,
+        const uint16_t mask_,
+        const WatchMode mode_ = WatchMode::LEAVE
+    );
+
   protected:
+    // Protected definition(s)
+
+    /// \brief Makes a cache update and its frame a single, indivisible unit
+    /// \detail Interrupts are masked on MCUs, and the previous mask is
+    /// restored on exit, so sections nest and may be entered from an
+    /// interrupt service routine. On host platforms, where interrupts are
+    /// dispatched from other threads, a reentrant spin lock is taken on the
+    /// device instead, or the device's `spi_bus` when it shares one.
+    /// \note Held only across the cache update and the transfer, never
+    /// while interrupt service routines are dispatched
+    /// \note On cores other than AVR, ARM and ESP8266, the mask cannot be
+    /// read back, so `noInterrupts` is counted and interrupts are enabled
+    /// as the outermost section exits (even within an interrupt service
+    /// routine)
+    class CriticalSection {
+      public:
+        explicit
+        CriticalSection (
+            mcp23s17 const & gpio_x_
+        );
+
+        ~CriticalSection (
+            void
+        );
+
+      private:
+        CriticalSection (const CriticalSection &) = delete;
+        CriticalSection & operator= (const CriticalSection &) = delete;
+
+#if defined(MCP23S17_HOST)
+        mcp23s17 const & _gpio_x;
+        bool _nested;
+#else
+        uint32_t _interrupt_state;
+#endif
+    };
+
     // Protected instance variable(s)
     // Protected method(s)
+
+    /// \brief Extract the port values from a completed `digitalReadPorts` frame
+    /// \param [in] mask_ The mask given to `prepareDigitalReadPorts`
+    /// \param [in] frame_ The bytes received
+    uint16_t
+    completeDigitalReadPorts (
+        const uint16_t mask_,
+        const uint8_t * const frame_
+    ) const;
+
+    /// \brief Record the snapshot of a completed `serviceInterrupts` frame,
+    /// and invoke the callback of each flagged pin
+    /// \param [in] frame_ The bytes received
+    InterruptSnapshot
+    completeServiceInterrupts (
+        const uint8_t * const frame_
+    );
+
+    /// \brief Record that a `digitalWritePorts` frame could not be exchanged
+    /// \note The chip may not hold the cached latches, so the next frame
+    /// prepared by `prepareDigitalWritePorts` sends both ports
+    void
+    failDigitalWritePorts (
+        void
+    );
+
     inline
     uint8_t const *
     getControlRegister (
@@ -221,14 +700,266 @@ class mcp23s17 {
         return _interrupt_service_routines;
     }
 
+    /// \brief Prepare the frame of `digitalReadPorts`
+    /// \param [in] mask_ The pins of interest
+    /// \param [out] frame_ The frame (at least `MAX_FRAME_LENGTH` bytes)
+    /// \return The length of the frame (0 when there is nothing to read)
+    size_t
+    prepareDigitalReadPorts (
+        const uint16_t mask_,
+        uint8_t * const frame_
+    ) const;
+
+    /// \brief Prepare the frame of `digitalWritePorts`
+    /// \param [in] values_ The latch values of both ports
+    /// \param [in] mask_ The pins to be updated
+    /// \param [out] frame_ The frame (at least `MAX_FRAME_LENGTH` bytes)
+    /// \return The length of the frame (0 when there is nothing to write)
+    /// \note The cache is updated immediately, so frames must be
+    /// transferred in the order they are prepared
+    size_t
+    prepareDigitalWritePorts (
+        const uint16_t values_,
+        const uint16_t mask_,
+        uint8_t * const frame_
+    );
+
+    /// \brief Prepare the frame of `serviceInterrupts`
+    /// \param [out] frame_ The frame (at least `MAX_FRAME_LENGTH` bytes)
+    /// \return The length of the frame
+    size_t
+    prepareServiceInterrupts (
+        uint8_t * const frame_
+    ) const;
+
   private:
     // Private instance variable(s)
     const uint8_t _SPI_BUS_ADDRESS;
     uint8_t _control_register[static_cast<uint8_t>(ControlRegister::REGISTER_COUNT)];
     uint8_t _control_register_address[static_cast<uint8_t>(ControlRegister::REGISTER_COUNT)];
     isr_t _interrupt_service_routines[PIN_COUNT];
+    InterruptSnapshot _interrupt_snapshot;
+    spi_transport * const _transport;
+    bool _latches_unconfirmed;
+#if defined(MCP23S17_HOST)
+    spi_bus * const _bus;
+    mutable std::atomic<std::thread::id> _lock_owner;
+    mutable unsigned int _lock_depth;
+    std::mutex _dispatch_mutex;
+    std::condition_variable _dispatched;
+    std::atomic<unsigned int> _dispatch_count;
+#else
+    volatile uint8_t _dispatch_count;
+#endif
+
+    // Private method(s)
+
+    /// \brief Object Constructor (see above)
+    /// \param [in] transport_ The transport exchanging every frame, or
+    /// nullptr to exchange them on `SPI`
+    mcp23s17 (
+        const HardwareAddress hw_addr_,
+        spi_transport * const transport_
+#if defined(MCP23S17_HOST)
+        ,
+        spi_bus * const bus_
+#endif
+    );
+
+    /// \brief Configure byte mode and open a streaming transaction
+    /// \param [in] register_ The register to stream to or from
+    /// \param [in] transaction_ The direction of the stream
+    /// \param [in] single_port_ Fix the address pointer on `register_`
+    /// (IOCON.BANK = 1), instead of toggling between the A/B pair
+    /// \note Chip select remains asserted upon return
+    void
+    beginStream (
+        const ControlRegister register_,
+        const RegisterTransaction transaction_,
+        const bool single_port_
+    );
+
+    /// \brief Close a streaming transaction and restore IOCON
+    /// \param [in] single_port_ Must match the value given to `beginStream`
+    void
+    endStream (
+        const bool single_port_
+    );
+
+    /// \brief Open a streaming transaction (IOCON must already be configured)
+    /// \param [in] register_ The register to stream to or from
+    /// \param [in] transaction_ The direction of the stream
+    /// \param [in] single_port_ The value given to `setStreamMode`
+    /// \note Chip select remains asserted upon return
+    void
+    openStream (
+        const ControlRegister register_,
+        const RegisterTransaction transaction_,
+        const bool single_port_
+    );
+
+    /// \brief Prepare the update of an A/B register pair with the fewest bytes possible
+    /// \param [in] register_ The port A register of the pair
+    /// \param [in] value_ The port A (low byte) and port B (high byte) values
+    /// \param [out] frame_ The frame (at least `MAX_FRAME_LENGTH` bytes)
+    /// \return The length of the frame (0 when the cache already holds `value_`)
+    /// \note The cache is updated immediately
+    size_t
+    prepareRegisterPair (
+        const ControlRegister register_,
+        const uint16_t value_,
+        uint8_t * const frame_
+    );
+
+    /// \brief Cached value of an A/B register pair
+    /// \param [in] register_ The port A register of the pair
+    /// \return The port A (low byte) and port B (high byte) values
+    inline
+    uint16_t
+    registerPair (
+        const ControlRegister register_
+    ) const {
+        return (_control_register[static_cast<uint8_t>(register_)] | (_control_register[static_cast<uint8_t>(register_) + 1] << 8));
+    }
+
+    /// \brief Restore IOCON after `setStreamMode`
+    /// \param [in] single_port_ The value given to `setStreamMode`
+    void
+    restoreStreamMode (
+        const bool single_port_
+    );
+
+    /// \brief Set IOCON.SEQOP (and IOCON.BANK) in a transaction of its own
+    /// \param [in] single_port_ Fix the address pointer on a single
+    /// register (IOCON.BANK = 1), instead of toggling between the A/B pair
+    void
+    setStreamMode (
+        const bool single_port_
+    );
+
+    /// \brief Exchange a prepared frame in a single transaction
+    /// \param [in,out] frame_ The bytes to send, replaced by the bytes received
+    /// \param [in] length_ The length of the frame
+    /// \return false if the frame could not be exchanged (the bytes
+    /// received are zeroed)
+    bool
+    transferFrame (
+        uint8_t * const frame_,
+        const size_t length_
+    ) const;
+
+    /// \brief Sleep until `serviceInterrupts` has been called
+    /// \param [in,out] dispatch_count_ The dispatches already seen
+    /// \param [in] start_ms_ The time the wait began
+    /// \param [in] timeout_ms_ The longest time to wait
+    /// \return false upon timeout
+    bool
+    waitForDispatch (
+        unsigned int & dispatch_count_,
+        const unsigned long start_ms_,
+        const unsigned long timeout_ms_
+    );
+
+    /// \brief Write the interrupt configuration images
+    /// \param [in] enable_ GPINTEN of port A (low byte) and port B (high byte)
+    /// \param [in] default_value_ DEFVAL of port A (low byte) and port B (high byte)
+    /// \param [in] control_ INTCON of port A (low byte) and port B (high byte)
+    /// \note The registers are contiguous, so they are sent in a single
+    /// 8-byte transaction
+    void
+    writeInterruptConfiguration (
+        const uint16_t enable_,
+        const uint16_t default_value_,
+        const uint16_t control_
+    );
+
+    /// \brief Update an A/B register pair with the fewest bytes possible
+    /// \param [in] register_ The port A register of the pair
+    /// \param [in] value_ The port A (low byte) and port B (high byte) values
+    /// \note Nothing is sent when the cache already holds `value_`
+    void
+    writeRegisterPair (
+        const ControlRegister register_,
+        const uint16_t value_
+    );
+};
+
+/// \brief Several streaming transactions sharing one IOCON configuration
+/// \detail IOCON.SEQOP (and IOCON.BANK, when every pin of the session
+/// belongs to one port) is set as the session opens and restored as it
+/// closes, so each call to `write` costs a single transaction (per
+/// `STREAM_CHUNK_LENGTH` values). Drivers
+/// that must pause between transfers (e.g. to honor the execution time of
+/// a peripheral) avoid reconfiguring IOCON around every transfer.
+/// \note The device is addressed differently while a session is open, so
+/// no other method of the device may be called until it closes. On host
+/// platforms the session holds the device (or its `spi_bus`), so other
+/// threads wait; on MCUs, interrupt service routines must not drive the
+/// device while a session is open.
+class mcp23s17::WriteStream {
+  public:
+    // Constructor and destructor method(s)
+
+    /// \brief Open a session
+    /// \param [in] gpio_x_ The expander to stream to
+    /// \param [in] mask_ The pins to be updated (pins configured as
+    /// INPUT are never updated). When they all belong to one port, each
+    /// sample costs a single byte on the bus.
+    explicit
+    WriteStream (
+        mcp23s17 & gpio_x_,
+        const uint16_t mask_ = 0xFFFF
+    );
+
+    /// \brief Close the session and restore IOCON
+    ~WriteStream (
+        void
+    );
+
+    // Public method(s)
+
+    /// \brief Stream values to the port of a single port session
+    /// \param [in] buffer_ The values to be latched, in order
+    /// \param [in] length_ The number of values in the buffer
+    /// \note Ignored by sessions spanning both ports
+    void
+    write (
+        const uint8_t * const buffer_,
+        const size_t length_
+    );
+
+    /// \brief Stream values, one transaction per `STREAM_CHUNK_LENGTH` values
+    /// \param [in] buffer_ The values to be latched, in order (port A
+    /// in the low byte, port B in the high byte)
+    /// \param [in] length_ The number of values in the buffer
+    /// \note The final value is retained as the cached port latches.
+    void
+    write (
+        const uint16_t * const buffer_,
+        const size_t length_
+    );
+
+  private:
+    WriteStream (const WriteStream &) = delete;
+    WriteStream & operator= (const WriteStream &) = delete;
+
+    // Private instance variable(s)
+    mcp23s17 & _gpio_x;
+#if defined(MCP23S17_HOST)
+    CriticalSection _critical_section;
+#endif
+    const uint16_t _mask;
+    const bool _single_port;
+    const unsigned int _port_shift;
 
     // Private method(s)
+
+    /// \brief Latch a single sample within an open transaction
+    /// \param [in] sample_ The values of port A (low byte) and port B (high byte)
+    void
+    transferSample (
+        const uint16_t sample_
+    ) const;
 };
 
 #endif
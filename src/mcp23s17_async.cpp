@@ -0,0 +1,216 @@
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
+
+#include "mcp23s17_async.h"
+
+#if defined(MCP23S17_HOST)
+  #include <thread>
+#endif
+
+mcp23s17_async::Operation::Operation (
+    void
+) :
+    _frame{ { 0 }, 0, nullptr, nullptr, false },
+    _owner(nullptr),
+    _type(Type::WRITE_PORTS),
+    _mask(0x0000),
+    _port_values(0x0000),
+    _snapshot{ 0x0000, 0x0000, 0x0000 },
+    _callback(nullptr),
+    _context(nullptr),
+    _sequence(0),
+    _complete(true)
+{}
+
+mcp23s17_async::mcp23s17_async (
+    const HardwareAddress hw_addr_,
+    spi_transport & transport_
+#if defined(MCP23S17_HOST)
+    ,
+    spi_bus * const bus_
+#endif
+) :
+#if defined(MCP23S17_HOST)
+    mcp23s17(hw_addr_, transport_, bus_),
+#else
+    mcp23s17(hw_addr_, transport_),
+#endif
+    _transport(transport_),
+    _handoff(0),
+    _handoff_sequence(0)
+{}
+
+bool
+mcp23s17_async::digitalReadPortsAsync (
+    Operation & operation_,
+    const uint16_t mask_,
+    const callback_t callback_,
+    void * const context_
+) {
+    if ( !operation_.isComplete() ) { return false; }
+
+    const size_t length(prepareDigitalReadPorts(mask_, operation_._frame.data));
+    return submit(operation_, Operation::Type::READ_PORTS, mask_, length, callback_, context_);
+}
+
+bool
+mcp23s17_async::digitalWriteAsync (
+    Operation & operation_,
+    const uint8_t pin_,
+    const PinLatchValue value_,
+    const callback_t callback_,
+    void * const context_
+) {
+    if ( pin_ >= PIN_COUNT ) { return false; }
+    return digitalWritePortsAsync(operation_, (( PinLatchValue::HIGH == value_ ) ? 0xFFFF : 0x0000), (static_cast<uint16_t>(1) << pin_), callback_, context_);
+}
+
+bool
+mcp23s17_async::digitalWritePortsAsync (
+    Operation & operation_,
+    const uint16_t values_,
+    const uint16_t mask_,
+    const callback_t callback_,
+    void * const context_
+) {
+    uint16_t previous_latch(0x0000);
+    size_t length(0);
+    unsigned int sequence(0);
+
+    if ( !operation_.isComplete() ) { return false; }
+
+    // The frame is handed to the transport before another update can be prepared, so frames reach the chip in the order of the cache updates
+    for (;;) {
+        {
+            CriticalSection critical_section(*this);
+            if ( !_handoff ) {
+                if ( !++_handoff_sequence ) { ++_handoff_sequence; }
+                sequence = _handoff_sequence;
+                _handoff = sequence;
+                operation_._sequence = sequence;
+                previous_latch = getLatchValues();
+                length = prepareDigitalWritePorts(values_, mask_, operation_._frame.data);
+            }
+        }
+        if ( sequence ) { break; }
+#if defined(MCP23S17_HOST)
+        std::this_thread::yield();
+#else
+        // Only an interrupt service routine can find a handoff in progress, and the write it preempted cannot finish until it returns
+        return false;
+#endif
+    }
+
+    // Callbacks and interrupt service routines may run as the frame completes, so the transport is called outside of the critical section
+    if ( submit(operation_, Operation::Type::WRITE_PORTS, mask_, length, callback_, context_) ) {
+        releaseHandoff(sequence);
+        return true;
+    }
+
+    // Roll the cache back, so it continues to describe the chip (no other write could have been prepared since)
+    CriticalSection critical_section(*this);
+    uint8_t frame[MAX_FRAME_LENGTH];
+    prepareDigitalWritePorts(previous_latch, 0xFFFF, frame);
+    _handoff = 0;
+
+    // The refused frame may have carried the resend of a failed write, so the next write sends both ports
+    failDigitalWritePorts();
+
+    return false;
+}
+
+bool
+mcp23s17_async::serviceInterruptsAsync (
+    Operation & operation_,
+    const callback_t callback_,
+    void * const context_
+) {
+    if ( !operation_.isComplete() ) { return false; }
+
+    const size_t length(prepareServiceInterrupts(operation_._frame.data));
+    return submit(operation_, Operation::Type::SERVICE_INTERRUPTS, 0xFFFF, length, callback_, context_);
+}
+
+void
+mcp23s17_async::complete (
+    Operation & operation_
+) {
+    const bool failed(operation_._frame.failed);
+
+    // The bytes received by a failed frame are invalid, so they never reach the cache, the snapshot or an interrupt service routine
+    switch ( operation_._type ) {
+      case Operation::Type::READ_PORTS:
+        operation_._port_values = (( operation_._frame.length && !failed ) ? completeDigitalReadPorts(operation_._mask, operation_._frame.data) : 0x0000);
+        break;
+      case Operation::Type::SERVICE_INTERRUPTS:
+        operation_._snapshot = ( failed ? InterruptSnapshot{ 0x0000, 0x0000, 0x0000 } : completeServiceInterrupts(operation_._frame.data) );
+        break;
+      case Operation::Type::WRITE_PORTS:
+        if ( failed ) { failDigitalWritePorts(); }
+
+        // The frame has been exchanged, so the next write may be handed to the transport (e.g. when reissued from the callback)
+        releaseHandoff(operation_._sequence);
+        break;
+    }
+
+    // The operation may be reissued from its own callback (or by another thread), so the callback is read before completion is published
+    const callback_t callback(operation_._callback);
+    void * const context(operation_._context);
+    operation_._complete = true;
+    if ( callback ) { callback(operation_, context); }
+
+    return;
+}
+
+void
+mcp23s17_async::onFrameComplete (
+    spi_transport::Frame & frame_
+) {
+    Operation & operation(*static_cast<Operation *>(frame_.context));
+    return operation._owner->complete(operation);
+}
+
+void
+mcp23s17_async::releaseHandoff (
+    const unsigned int sequence_
+) {
+    CriticalSection critical_section(*this);
+    if ( sequence_ == _handoff ) { _handoff = 0; }
+
+    return;
+}
+
+bool
+mcp23s17_async::submit (
+    Operation & operation_,
+    const Operation::Type type_,
+    const uint16_t mask_,
+    const size_t length_,
+    const callback_t callback_,
+    void * const context_
+) {
+    operation_._frame.length = length_;
+    operation_._frame.on_complete = onFrameComplete;
+    operation_._frame.context = &operation_;
+    operation_._frame.failed = false;
+    operation_._owner = this;
+    operation_._type = type_;
+    operation_._mask = mask_;
+    operation_._callback = callback_;
+    operation_._context = context_;
+
+    // Nothing to exchange
+    if ( !length_ ) {
+        complete(operation_);
+        return true;
+    }
+
+    operation_._complete = false;
+    if ( !_transport.submit(operation_._frame) ) {
+        operation_._complete = true;
+        return false;
+    }
+
+    return true;
+}
+
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
@@ -0,0 +1,234 @@
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
+
+#ifndef MCP23S17_ASYNC_H
+#define MCP23S17_ASYNC_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "mcp23s17.h"
+#include "spi_transport.h"
+
+#if defined(MCP23S17_HOST)
+  #include <atomic>
+#endif
+
+/// \brief MCP23S17 with non-blocking operations
+/// \detail Each asynchronous operation is prepared as a frame from the
+/// register cache, and handed to a transport that completes it in the
+/// background. The cache is updated when the operation is prepared, so
+/// operations issued back to back always build on one another, and the
+/// transport exchanges them in the same order. Completion is signaled
+/// through an optional callback, and can also be polled on the
+/// operation itself.
+/// \note The blocking methods exchange their frames through the transport
+/// (see `spi_transport::transfer`), so they may be mixed with operations
+/// still in flight only when the transport orders the two (e.g.
+/// `thread_transport` and `spidev_transport`)
+class mcp23s17_async : public mcp23s17 {
+  public:
+    // Definition(s)
+    class Operation;
+    typedef void(*callback_t)(Operation & operation_, void * context_);
+
+    /// \brief An asynchronous operation
+    /// \note The storage belongs to the caller, and must remain valid
+    /// until the operation completes
+    class Operation {
+      public:
+        Operation (
+            void
+        );
+
+        /// \brief Snapshot received by `serviceInterruptsAsync`
+        inline
+        InterruptSnapshot const &
+        getInterruptSnapshot (
+            void
+        ) const {
+            return _snapshot;
+        }
+
+        /// \brief Levels received by `digitalReadPortsAsync`
+        inline
+        uint16_t
+        getPortValues (
+            void
+        ) const {
+            return _port_values;
+        }
+
+        /// \brief Whether the operation has completed
+        inline
+        bool
+        isComplete (
+            void
+        ) const {
+            return _complete;
+        }
+
+        /// \brief Whether the transport failed to exchange the operation
+        /// \note A failed operation is complete, but received nothing (its
+        /// port values and snapshot are empty, and no interrupt service
+        /// routine is invoked). A failed write is sent again, in full, by
+        /// the next write.
+        inline
+        bool
+        isFailed (
+            void
+        ) const {
+            return _frame.failed;
+        }
+
+      private:
+        friend class mcp23s17_async;
+
+        enum class Type : uint8_t {
+            READ_PORTS = 0,
+            SERVICE_INTERRUPTS,
+            WRITE_PORTS,
+        };
+
+        spi_transport::Frame _frame;
+        mcp23s17_async * _owner;
+        Type _type;
+        uint16_t _mask;
+        uint16_t _port_values;
+        InterruptSnapshot _snapshot;
+        callback_t _callback;
+        void * _context;
+        unsigned int _sequence;
+#if defined(MCP23S17_HOST)
+        std::atomic<bool> _complete;
+#else
+        volatile bool _complete;
+#endif
+    };
+
+    // Constructor and destructor method(s)
+
+    /// \brief Object Constructor
+    /// \param [in] hw_addr_ The hardware address of the device
+    /// \param [in] transport_ The transport completing the operations, which
+    /// also exchanges the frames of the blocking methods (see `mcp23s17`)
+    /// \param [in] bus_ The bus shared with other devices and threads (see
+    /// `mcp23s17`), which should also be given to the transport
+    mcp23s17_async (
+        const HardwareAddress hw_addr_,
+        spi_transport & transport_
+#if defined(MCP23S17_HOST)
+        ,
+        spi_bus * const bus_ = nullptr
+#endif
+    );
+
+    // Public method(s)
+
+    /// \brief Read both GPIO ports without blocking
+    /// \param [out] operation_ The operation (see `getPortValues`)
+    /// \param [in] mask_ The pins of interest (see `digitalReadPorts`)
+    /// \param [in] callback_ Invoked upon completion (optional)
+    /// \param [in] context_ Passed to the callback
+    /// \return false if the operation is still in flight, or the
+    /// transport refused the frame
+    bool
+    digitalReadPortsAsync (
+        Operation & operation_,
+        const uint16_t mask_ = 0xFFFF,
+        const callback_t callback_ = nullptr,
+        void * const context_ = nullptr
+    );
+
+    /// \brief Write HIGH or LOW on a pin without blocking
+    /// \note See `digitalWritePortsAsync`
+    bool
+    digitalWriteAsync (
+        Operation & operation_,
+        const uint8_t pin_,
+        const PinLatchValue value_,
+        const callback_t callback_ = nullptr,
+        void * const context_ = nullptr
+    );
+
+    /// \brief Write both GPIO ports without blocking
+    /// \param [out] operation_ The operation
+    /// \param [in] values_ The latch values (see `digitalWritePorts`)
+    /// \param [in] mask_ The pins to be updated
+    /// \param [in] callback_ Invoked upon completion (optional)
+    /// \param [in] context_ Passed to the callback
+    /// \return false if the operation is still in flight, or the
+    /// transport refused the frame
+    /// \note When the cache already holds the values, the operation
+    /// completes immediately without a frame
+    /// \note The transport is called outside of the critical section, so
+    /// callbacks and interrupt service routines never run inside it. Writes
+    /// wait for the previous write to reach the transport, so frames keep
+    /// the order of their cache updates. On MCUs, an interrupt service
+    /// routine cannot wait for the write it preempted, so it is refused.
+    bool
+    digitalWritePortsAsync (
+        Operation & operation_,
+        const uint16_t values_,
+        const uint16_t mask_ = 0xFFFF,
+        const callback_t callback_ = nullptr,
+        void * const context_ = nullptr
+    );
+
+    /// \brief Service a pending interrupt without blocking
+    /// \param [out] operation_ The operation (see `getInterruptSnapshot`)
+    /// \param [in] callback_ Invoked upon completion (optional)
+    /// \param [in] context_ Passed to the callback
+    /// \return false if the operation is still in flight, or the
+    /// transport refused the frame
+    /// \note The pin callbacks are invoked upon completion, in the
+    /// context of the transport
+    bool
+    serviceInterruptsAsync (
+        Operation & operation_,
+        const callback_t callback_ = nullptr,
+        void * const context_ = nullptr
+    );
+
+  private:
+    // Private instance variable(s)
+    spi_transport & _transport;
+    unsigned int _handoff;  ///< Sequence of the write between its cache update and the transport (0 => none)
+    unsigned int _handoff_sequence;
+
+    // Private method(s)
+
+    /// \brief Finish an operation once its frame has been exchanged
+    void
+    complete (
+        Operation & operation_
+    );
+
+    /// \brief Completion handler of every frame
+    static
+    void
+    onFrameComplete (
+        spi_transport::Frame & frame_
+    );
+
+    /// \brief End the handoff of a write, once its frame is ordered
+    /// \param [in] sequence_ The sequence of the write
+    void
+    releaseHandoff (
+        const unsigned int sequence_
+    );
+
+    /// \brief Claim an operation and hand its frame to the transport
+    bool
+    submit (
+        Operation & operation_,
+        const Operation::Type type_,
+        const uint16_t mask_,
+        const size_t length_,
+        const callback_t callback_,
+        void * const context_
+    );
+};
+
+#endif
+
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
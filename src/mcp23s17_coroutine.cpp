@@ -0,0 +1,211 @@
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
+
+#include "mcp23s17_coroutine.h"
+
+#if defined(MCP23S17_HOST) && defined(__cpp_impl_coroutine)
+
+size_t
+coroutine_scheduler::poll (
+    void
+) {
+    std::deque<std::coroutine_handle<>> ready;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        ready.swap(_queue);
+    }
+
+    for ( std::coroutine_handle<> handle : ready ) { handle.resume(); }
+
+    return ready.size();
+}
+
+void
+coroutine_scheduler::post (
+    std::coroutine_handle<> handle_
+) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _queue.push_back(handle_);
+    }
+    _ready.notify_one();
+
+    return;
+}
+
+size_t
+coroutine_scheduler::wait (
+    void
+) {
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _ready.wait(lock, [this](){ return !_queue.empty(); });
+    }
+
+    return poll();
+}
+
+interrupt_signal::interrupt_signal (
+    coroutine_scheduler * const scheduler_
+) :
+    _scheduler(scheduler_),
+    _pending(false)
+{}
+
+void
+interrupt_signal::notify (
+    void
+) {
+    std::vector<std::coroutine_handle<>> waiters;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if ( _waiters.empty() ) {
+            _pending = true;
+            return;
+        }
+        waiters.swap(_waiters);
+    }
+
+    for ( std::coroutine_handle<> waiter : waiters ) {
+        if ( _scheduler ) {
+            _scheduler->post(waiter);
+        } else {
+            waiter.resume();
+        }
+    }
+
+    return;
+}
+
+bool
+interrupt_signal::Awaiter::await_suspend (
+    std::coroutine_handle<> handle_
+) {
+    std::lock_guard<std::mutex> lock(_signal._mutex);
+
+    // Consume a notification that arrived while nobody was waiting
+    if ( _signal._pending ) {
+        _signal._pending = false;
+        return false;
+    }
+    _signal._waiters.push_back(handle_);
+
+    return true;
+}
+
+mcp23s17_coroutine::Awaiter::Awaiter (
+    mcp23s17_coroutine & owner_
+) :
+    _owner(owner_),
+    _handle(nullptr),
+    _state(ISSUING),
+    _accepted(false)
+{}
+
+bool
+mcp23s17_coroutine::Awaiter::await_suspend (
+    std::coroutine_handle<> handle_
+) {
+    uint8_t expected(ISSUING);
+
+    _handle = handle_;
+    _accepted = issue();
+    if ( !_accepted ) { return false; }
+
+    // Suspend, unless the operation completed while it was being issued
+    return _state.compare_exchange_strong(expected, SUSPENDED);
+}
+
+void
+mcp23s17_coroutine::Awaiter::onComplete (
+    mcp23s17_async::Operation &,
+    void * context_
+) {
+    Awaiter & awaiter(*static_cast<Awaiter *>(context_));
+
+    // Only resume a coroutine that has actually suspended
+    if ( SUSPENDED != awaiter._state.exchange(COMPLETE) ) { return; }
+    return awaiter._owner.resume(awaiter._handle);
+}
+
+bool
+mcp23s17_coroutine::ReadPortsAwaiter::issue (
+    void
+) {
+    return _owner._gpio_x.digitalReadPortsAsync(_operation, _mask, onComplete, this);
+}
+
+bool
+mcp23s17_coroutine::ServiceInterruptsAwaiter::issue (
+    void
+) {
+    return _owner._gpio_x.serviceInterruptsAsync(_operation, onComplete, this);
+}
+
+bool
+mcp23s17_coroutine::WritePortsAwaiter::issue (
+    void
+) {
+    return _owner._gpio_x.digitalWritePortsAsync(_operation, _values, _mask, onComplete, this);
+}
+
+mcp23s17_coroutine::mcp23s17_coroutine (
+    mcp23s17_async & gpio_x_,
+    coroutine_scheduler * const scheduler_
+) :
+    _gpio_x(gpio_x_),
+    _scheduler(scheduler_)
+{}
+
+mcp23s17_coroutine::ReadPortsAwaiter
+mcp23s17_coroutine::digitalRead (
+    const uint8_t pin_
+) {
+    return ReadPortsAwaiter(*this, (( pin_ < mcp23s17::PIN_COUNT ) ? (static_cast<uint16_t>(1) << pin_) : 0x0000));
+}
+
+mcp23s17_coroutine::ReadPortsAwaiter
+mcp23s17_coroutine::digitalReadPorts (
+    const uint16_t mask_
+) {
+    return ReadPortsAwaiter(*this, mask_);
+}
+
+mcp23s17_coroutine::WritePortsAwaiter
+mcp23s17_coroutine::digitalWrite (
+    const uint8_t pin_,
+    const mcp23s17::PinLatchValue value_
+) {
+    return WritePortsAwaiter(*this, (( mcp23s17::PinLatchValue::HIGH == value_ ) ? 0xFFFF : 0x0000), (( pin_ < mcp23s17::PIN_COUNT ) ? (static_cast<uint16_t>(1) << pin_) : 0x0000));
+}
+
+mcp23s17_coroutine::WritePortsAwaiter
+mcp23s17_coroutine::digitalWritePorts (
+    const uint16_t values_,
+    const uint16_t mask_
+) {
+    return WritePortsAwaiter(*this, values_, mask_);
+}
+
+mcp23s17_coroutine::ServiceInterruptsAwaiter
+mcp23s17_coroutine::serviceInterrupts (
+    void
+) {
+    return ServiceInterruptsAwaiter(*this);
+}
+
+void
+mcp23s17_coroutine::resume (
+    std::coroutine_handle<> handle_
+) {
+    if ( _scheduler ) {
+        _scheduler->post(handle_);
+    } else {
+        handle_.resume();
+    }
+
+    return;
+}
+
+#endif // MCP23S17_HOST && __cpp_impl_coroutine
+
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
@@ -0,0 +1,263 @@
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
+
+#ifndef MCP23S17_COROUTINE_H
+#define MCP23S17_COROUTINE_H
+
+#include "mcp23s17_async.h"
+
+#if defined(MCP23S17_HOST) && defined(__cpp_impl_coroutine)
+
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <vector>
+
+/// \brief Resumes coroutines on the thread that runs it
+/// \detail Completions arrive on the transport's thread, and are posted
+/// here so that every task resumes on a single thread. Many tasks can
+/// then interleave their expander I/O without any threads of their own.
+class coroutine_scheduler {
+  public:
+    // Public method(s)
+
+    /// \brief Resume every coroutine that is ready
+    /// \return The number of coroutines resumed
+    size_t
+    poll (
+        void
+    );
+
+    /// \brief Queue a coroutine to be resumed
+    /// \note Safe to call from any thread
+    void
+    post (
+        std::coroutine_handle<> handle_
+    );
+
+    /// \brief Block until a coroutine is ready, then resume every
+    /// coroutine that is ready
+    /// \return The number of coroutines resumed
+    size_t
+    wait (
+        void
+    );
+
+  private:
+    // Private instance variable(s)
+    std::mutex _mutex;
+    std::condition_variable _ready;
+    std::deque<std::coroutine_handle<>> _queue;
+};
+
+/// \brief A fire-and-forget coroutine
+/// \detail Starts immediately, and runs until its first suspension
+/// point, returning control to the caller.
+struct coroutine_task {
+    struct promise_type {
+        coroutine_task get_return_object (void) { return {}; }
+        std::suspend_never initial_suspend (void) noexcept { return {}; }
+        std::suspend_never final_suspend (void) noexcept { return {}; }
+        void return_void (void) {}
+        void unhandled_exception (void) { std::terminate(); }
+    };
+};
+
+/// \brief Awaitable interrupt notification
+/// \detail `notify` is called by whatever observes the INT line (e.g.
+/// a GPIO edge handler), and wakes every coroutine awaiting `wait`. A
+/// notification that arrives while nobody is waiting is held, so it is
+/// never lost.
+class interrupt_signal {
+  public:
+    class Awaiter {
+      public:
+        bool await_ready (void) const noexcept { return false; }
+        bool await_suspend (std::coroutine_handle<> handle_);
+        void await_resume (void) const noexcept {}
+
+      private:
+        friend class interrupt_signal;
+        explicit Awaiter (interrupt_signal & signal_) : _signal(signal_) {}
+        interrupt_signal & _signal;
+    };
+
+    // Constructor and destructor method(s)
+
+    /// \brief Object Constructor
+    /// \param [in] scheduler_ Resumes the waiting coroutines (when
+    /// nullptr, they resume in the context of `notify`)
+    explicit
+    interrupt_signal (
+        coroutine_scheduler * const scheduler_ = nullptr
+    );
+
+    // Public method(s)
+
+    /// \brief Signal an interrupt
+    /// \note Safe to call from any thread
+    void
+    notify (
+        void
+    );
+
+    /// \brief Suspend until the next interrupt is signaled
+    inline
+    Awaiter
+    wait (
+        void
+    ) {
+        return Awaiter(*this);
+    }
+
+  private:
+    // Private instance variable(s)
+    coroutine_scheduler * const _scheduler;
+    std::mutex _mutex;
+    std::vector<std::coroutine_handle<>> _waiters;
+    bool _pending;
+};
+
+/// \brief Awaitable expander I/O for C++20 coroutines
+/// \detail Each operation is issued on the asynchronous transport of the
+/// expander, and the awaiting coroutine is suspended while the frame is
+/// in flight. It resumes upon completion, on the scheduler when one is
+/// given, otherwise in the context of the transport. When the transport
+/// completes the frame before the coroutine could suspend (e.g.
+/// `blocking_transport`), the coroutine simply continues.
+/// \note Host platforms with C++20 coroutine support only
+class mcp23s17_coroutine {
+  public:
+    // Definition(s)
+
+    /// \brief Common suspension logic of every operation
+    class Awaiter {
+      public:
+        bool await_ready (void) const noexcept { return false; }
+        bool await_suspend (std::coroutine_handle<> handle_);
+
+      protected:
+        enum : uint8_t {
+            ISSUING = 0,
+            SUSPENDED,
+            COMPLETE,
+        };
+
+        explicit Awaiter (mcp23s17_coroutine & owner_);
+        virtual ~Awaiter (void) {}
+
+        /// \brief Issue the asynchronous operation (see `onComplete`)
+        virtual bool issue (void) = 0;
+
+        static void onComplete (mcp23s17_async::Operation & operation_, void * context_);
+
+        mcp23s17_coroutine & _owner;
+        mcp23s17_async::Operation _operation;
+        std::coroutine_handle<> _handle;
+        std::atomic<uint8_t> _state;
+        bool _accepted;
+    };
+
+    /// \brief Resolves to the levels of both ports
+    class ReadPortsAwaiter : public Awaiter {
+      public:
+        uint16_t await_resume (void) const noexcept { return (_accepted ? _operation.getPortValues() : 0x0000); }
+
+      private:
+        friend class mcp23s17_coroutine;
+        ReadPortsAwaiter (mcp23s17_coroutine & owner_, const uint16_t mask_) : Awaiter(owner_), _mask(mask_) {}
+        bool issue (void) override;
+        const uint16_t _mask;
+    };
+
+    /// \brief Resolves to the interrupt snapshot
+    class ServiceInterruptsAwaiter : public Awaiter {
+      public:
+        mcp23s17::InterruptSnapshot await_resume (void) const noexcept { return (_accepted ? _operation.getInterruptSnapshot() : mcp23s17::InterruptSnapshot{ 0, 0, 0 }); }
+
+      private:
+        friend class mcp23s17_coroutine;
+        explicit ServiceInterruptsAwaiter (mcp23s17_coroutine & owner_) : Awaiter(owner_) {}
+        bool issue (void) override;
+    };
+
+    /// \brief Resolves to true if the write was accepted by the transport
+    class WritePortsAwaiter : public Awaiter {
+      public:
+        bool await_resume (void) const noexcept { return _accepted; }
+
+      private:
+        friend class mcp23s17_coroutine;
+        WritePortsAwaiter (mcp23s17_coroutine & owner_, const uint16_t values_, const uint16_t mask_) : Awaiter(owner_), _values(values_), _mask(mask_) {}
+        bool issue (void) override;
+        const uint16_t _values;
+        const uint16_t _mask;
+    };
+
+    // Constructor and destructor method(s)
+
+    /// \brief Object Constructor
+    /// \param [in] gpio_x_ The expander (and its transport)
+    /// \param [in] scheduler_ Resumes the awaiting coroutines (optional)
+    explicit
+    mcp23s17_coroutine (
+        mcp23s17_async & gpio_x_,
+        coroutine_scheduler * const scheduler_ = nullptr
+    );
+
+    // Public method(s)
+
+    /// \brief Read a pin (see `mcp23s17::digitalRead`)
+    /// \note Resolves to the levels of the pin's port (test the pin's bit)
+    ReadPortsAwaiter
+    digitalRead (
+        const uint8_t pin_
+    );
+
+    /// \brief Read both ports (see `mcp23s17::digitalReadPorts`)
+    ReadPortsAwaiter
+    digitalReadPorts (
+        const uint16_t mask_ = 0xFFFF
+    );
+
+    /// \brief Write a pin (see `mcp23s17::digitalWrite`)
+    WritePortsAwaiter
+    digitalWrite (
+        const uint8_t pin_,
+        const mcp23s17::PinLatchValue value_
+    );
+
+    /// \brief Write both ports (see `mcp23s17::digitalWritePorts`)
+    WritePortsAwaiter
+    digitalWritePorts (
+        const uint16_t values_,
+        const uint16_t mask_ = 0xFFFF
+    );
+
+    /// \brief Service a pending interrupt (see `mcp23s17::serviceInterrupts`)
+    ServiceInterruptsAwaiter
+    serviceInterrupts (
+        void
+    );
+
+  private:
+    // Private instance variable(s)
+    mcp23s17_async & _gpio_x;
+    coroutine_scheduler * const _scheduler;
+
+    // Private method(s)
+    void
+    resume (
+        std::coroutine_handle<> handle_
+    );
+};
+
+#endif // MCP23S17_HOST && __cpp_impl_coroutine
+
+#endif
+
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
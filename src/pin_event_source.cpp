@@ -0,0 +1,183 @@
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
+
+#include "pin_event_source.h"
+
+#if defined(MCP23S17_HOST) && defined(__linux__)
+
+#include <chrono>
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace {
+
+unsigned long
+defaultClockSource (
+    void
+) {
+    return static_cast<unsigned long>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+} // namespace
+
+pin_event_source::pin_event_source (
+    const uint16_t mask_,
+    const uint32_t debounce_us_,
+    const clock_source_t clock_source_
+) :
+    _mask(mask_),
+    _debounce_us(debounce_us_),
+    _clock_source(clock_source_ ? clock_source_ : defaultClockSource),
+    _fd(::eventfd(0, (EFD_CLOEXEC | EFD_NONBLOCK))),
+    _primed(false),
+    _reported(0x0000),
+    _held_off(0x0000),
+    _holding(0x0000),
+    _last_change_us{},
+    _queue{},
+    _queue_head(0),
+    _queue_length(0),
+    _dropped_count(0)
+{}
+
+pin_event_source::~pin_event_source (
+    void
+) {
+    if ( _fd >= 0 ) { ::close(_fd); }
+}
+
+uint32_t
+pin_event_source::getDroppedCount (
+    void
+) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _dropped_count;
+}
+
+int
+pin_event_source::getTimeoutMs (
+    void
+) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    const unsigned long now_us(_clock_source());
+    unsigned long timeout_us(static_cast<unsigned long>(-1));
+
+    if ( !_held_off ) { return -1; }
+
+    for ( uint8_t pin = 0 ; pin < mcp23s17::PIN_COUNT ; ++pin ) {
+        if ( !((_held_off >> pin) & 0x01) ) { continue; }
+        const unsigned long elapsed_us(now_us - _last_change_us[pin]);
+        const unsigned long remaining_us(( elapsed_us < _debounce_us ) ? (_debounce_us - elapsed_us) : 0);
+        if ( remaining_us < timeout_us ) { timeout_us = remaining_us; }
+    }
+
+    // Round up, so the loop does not wake before the hold-off has elapsed
+    return static_cast<int>((timeout_us + 999) / 1000);
+}
+
+size_t
+pin_event_source::read (
+    Event * const events_,
+    const size_t max_events_
+) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    size_t count(0);
+    uint64_t counter;
+
+    if ( !events_ ) { return 0; }
+
+    for ( ; count < max_events_ && count < _queue_length ; ++count ) {
+        events_[count] = _queue[(_queue_head + count) % CAPACITY];
+    }
+    _queue_head = ((_queue_head + count) % CAPACITY);
+    _queue_length -= count;
+
+    // Reset the descriptor once nothing is pending
+    if ( !_queue_length && _fd >= 0 ) { (void)::read(_fd, &counter, sizeof(counter)); }
+
+    return count;
+}
+
+void
+pin_event_source::update (
+    const mcp23s17::InterruptSnapshot & snapshot_
+) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    const unsigned long now_us(_clock_source());
+
+    // Without a baseline, the captured levels cannot be told from changes, so the current levels are the baseline
+    if ( !_primed ) { return apply(snapshot_.levels, now_us); }
+
+    apply(((_reported & ~snapshot_.flags) | (snapshot_.capture & snapshot_.flags)), now_us);
+    apply(snapshot_.levels, now_us);
+
+    return;
+}
+
+void
+pin_event_source::update (
+    const uint16_t levels_
+) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return apply(levels_, _clock_source());
+}
+
+void
+pin_event_source::apply (
+    const uint16_t levels_,
+    const unsigned long now_us_
+) {
+    uint16_t changed;
+
+    // The first levels are the baseline
+    if ( !_primed ) {
+        _reported = levels_;
+        _primed = true;
+        return;
+    }
+
+    // A pin that returned to its reported level within the hold-off no longer needs to be resampled
+    changed = ((levels_ ^ _reported) & _mask);
+    _held_off &= changed;
+
+    for ( uint8_t pin = 0 ; pin < mcp23s17::PIN_COUNT ; ++pin ) {
+        const uint16_t pin_mask(static_cast<uint16_t>(1) << pin);
+
+        if ( !(changed & pin_mask) ) { continue; }
+        if ( (_holding & pin_mask) && (now_us_ - _last_change_us[pin]) < _debounce_us ) {
+            _held_off |= pin_mask;
+            continue;
+        }
+
+        _reported ^= pin_mask;
+        _held_off &= ~pin_mask;
+        _holding |= pin_mask;
+        _last_change_us[pin] = now_us_;
+        enqueue(Event{ static_cast<uint32_t>(now_us_), pin, static_cast<uint8_t>((levels_ >> pin) & 0x01) });
+    }
+
+    return;
+}
+
+void
+pin_event_source::enqueue (
+    const Event & event_
+) {
+    const uint64_t increment(1);
+
+    if ( _queue_length == CAPACITY ) {
+        ++_dropped_count;
+        return;
+    }
+    _queue[(_queue_head + _queue_length) % CAPACITY] = event_;
+    ++_queue_length;
+
+    // Signal the descriptor as the queue becomes non-empty
+    if ( 1 == _queue_length && _fd >= 0 ) { (void)::write(_fd, &increment, sizeof(increment)); }
+
+    return;
+}
+
+#endif // MCP23S17_HOST && __linux__
+
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
@@ -0,0 +1,155 @@
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
+
+#ifndef PIN_EVENT_SOURCE_H
+#define PIN_EVENT_SOURCE_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "mcp23s17.h"
+
+#if defined(MCP23S17_HOST) && defined(__linux__)
+
+#include <mutex>
+
+/// \brief Debounced pin-change events behind a pollable file descriptor
+/// \detail Levels are fed from the interrupt dispatch (`update` with the
+/// interrupt snapshot) or from a polling engine (`update` with the port
+/// levels). Every change of a watched pin is reported immediately, then
+/// further changes of that pin are held off for the debounce period, and a
+/// change still present once the period has elapsed is reported by the
+/// next update. The descriptor (an eventfd) is readable while events are
+/// pending, so an epoll loop can serve the expanders next to its sockets
+/// and timers, and `read` collects many events per call.
+/// \note `getTimeoutMs` tells the event loop when a held-off change needs
+/// the levels to be sampled again, so no polling thread is required
+/// \note `update` may be called from the interrupt dispatch thread while
+/// the event loop calls `getTimeoutMs` and `read`
+/// \note Host (Linux) platforms only
+class pin_event_source {
+  public:
+    // Definition(s)
+    typedef unsigned long(*clock_source_t)(void);
+
+    /// \brief A debounced change of a pin
+    struct Event {
+        uint32_t timestamp_us;  ///< When the change was observed
+        uint8_t pin;  ///< The pin that changed
+        uint8_t level;  ///< The new level of the pin
+    };
+
+    // Public instance variable(s)
+    static const size_t CAPACITY = 64;  ///< Events that may be pending
+
+    // Constructor and destructor method(s)
+
+    /// \brief Object Constructor
+    /// \param [in] mask_ The pins to report
+    /// \param [in] debounce_us_ The hold-off after each reported change
+    /// \param [in] clock_source_ The clock (in microseconds) used to
+    /// timestamp each change (when nullptr, a monotonic clock is used)
+    pin_event_source (
+        const uint16_t mask_,
+        const uint32_t debounce_us_,
+        const clock_source_t clock_source_ = nullptr
+    );
+
+    /// \brief Object Destructor
+    ~pin_event_source (
+        void
+    );
+
+    // Accessor method(s)
+
+    /// \brief The number of events discarded because the queue was full
+    uint32_t
+    getDroppedCount (
+        void
+    );
+
+    /// \brief The descriptor to register with epoll (readable while events
+    /// are pending)
+    /// \return The descriptor, or -1 if it could not be created
+    inline
+    int
+    getFd (
+        void
+    ) const {
+        return _fd;
+    }
+
+    /// \brief The time until the levels should be sampled again
+    /// \return The timeout for `epoll_wait` in milliseconds (-1 when no
+    /// change is being held off)
+    int
+    getTimeoutMs (
+        void
+    ) const;
+
+    // Public method(s)
+
+    /// \brief Collect pending events
+    /// \param [out] events_ The events, oldest first
+    /// \param [in] max_events_ The capacity of `events_`
+    /// \return The number of events collected
+    /// \note Never blocks. The descriptor stops being readable once every
+    /// pending event has been collected.
+    size_t
+    read (
+        Event * const events_,
+        const size_t max_events_
+    );
+
+    /// \brief Feed the result of `mcp23s17::serviceInterrupts`
+    /// \note The captured levels of the flagged pins are applied before the
+    /// current levels, so a pin that has already changed back is not missed.
+    /// The first snapshot only sets the baseline (from its current levels).
+    void
+    update (
+        const mcp23s17::InterruptSnapshot & snapshot_
+    );
+
+    /// \brief Feed the levels of both ports (e.g. `mcp23s17::digitalReadPorts`)
+    void
+    update (
+        const uint16_t levels_
+    );
+
+  private:
+    // Private instance variable(s)
+    const uint16_t _mask;
+    const uint32_t _debounce_us;
+    const clock_source_t _clock_source;
+    int _fd;
+    bool _primed;
+    uint16_t _reported;
+    uint16_t _held_off;
+    uint16_t _holding;
+    unsigned long _last_change_us[mcp23s17::PIN_COUNT];
+    mutable std::mutex _mutex;
+    Event _queue[CAPACITY];
+    size_t _queue_head;
+    size_t _queue_length;
+    uint32_t _dropped_count;
+
+    // Private method(s)
+
+    /// \note `_mutex` must be held
+    void
+    apply (
+        const uint16_t levels_,
+        const unsigned long now_us_
+    );
+
+    /// \note `_mutex` must be held
+    void
+    enqueue (
+        const Event & event_
+    );
+};
+
+#endif // MCP23S17_HOST && __linux__
+
+#endif
+
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
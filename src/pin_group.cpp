@@ -0,0 +1,87 @@
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
+
+#include "pin_group.h"
+
+pin_group::pin_group (
+    mcp23s17 & gpio_x_,
+    const uint8_t * const pins_,
+    const size_t count_
+) :
+    _gpio_x(gpio_x_),
+    _run{},
+    _run_count(0),
+    _width(0),
+    _pin_mask(0x0000)
+{
+    if ( !pins_ ) { return; }
+
+    for ( size_t i = 0 ; i < count_ ; ++i ) {
+        const uint8_t pin(pins_[i]);
+
+        if ( pin >= mcp23s17::PIN_COUNT ) { continue; }
+        if ( (_pin_mask >> pin) & 0x01 ) { continue; }
+
+        // Extend the current run when the pin follows its last pin, otherwise begin a new run
+        if ( _run_count && (_run[_run_count - 1].pin_shift + (_width - _run[_run_count - 1].value_shift)) == pin ) {
+            _run[_run_count - 1].mask = ((_run[_run_count - 1].mask << 1) | 0x01);
+        } else {
+            _run[_run_count].value_shift = _width;
+            _run[_run_count].pin_shift = pin;
+            _run[_run_count].mask = 0x0001;
+            ++_run_count;
+        }
+        _pin_mask |= (static_cast<uint16_t>(1) << pin);
+        ++_width;
+    }
+}
+
+void
+pin_group::pinMode (
+    const mcp23s17::PinMode mode_
+) {
+    return _gpio_x.pinModes(_pin_mask, mode_);
+}
+
+uint16_t
+pin_group::read (
+    void
+) const {
+    if ( !_pin_mask ) { return 0x0000; }
+    return gather(_gpio_x.digitalReadPorts(_pin_mask));
+}
+
+void
+pin_group::write (
+    const uint16_t value_
+) {
+    if ( !_pin_mask ) { return; }
+    return _gpio_x.digitalWritePorts(scatter(value_), _pin_mask);
+}
+
+uint16_t
+pin_group::gather (
+    const uint16_t levels_
+) const {
+    uint16_t value(0x0000);
+
+    for ( uint8_t i = 0 ; i < _run_count ; ++i ) {
+        value |= (((levels_ >> _run[i].pin_shift) & _run[i].mask) << _run[i].value_shift);
+    }
+
+    return value;
+}
+
+uint16_t
+pin_group::scatter (
+    const uint16_t value_
+) const {
+    uint16_t levels(0x0000);
+
+    for ( uint8_t i = 0 ; i < _run_count ; ++i ) {
+        levels |= (((value_ >> _run[i].value_shift) & _run[i].mask) << _run[i].pin_shift);
+    }
+
+    return levels;
+}
+
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
@@ -0,0 +1,117 @@
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
+
+#ifndef PIN_GROUP_H
+#define PIN_GROUP_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "mcp23s17.h"
+
+/// \brief A named group of expander pins, read and written as an integer
+/// \detail The group is defined once from a list of pins (possibly
+/// spanning both ports), and the pins are reduced to runs of consecutive
+/// pins. Each run moves several bits with a single shift and mask, so
+/// scattering a value onto the ports (or gathering it back) costs one
+/// step per run instead of one per pin. `write` updates the whole field
+/// in a single masked read-modify-write of the cached latches, and `read`
+/// samples it in a single transaction.
+class pin_group {
+  public:
+    // Constructor and destructor method(s)
+
+    /// \brief Object Constructor
+    /// \param [in] gpio_x_ The expander the pins belong to
+    /// \param [in] pins_ The pins of the group, least significant bit first
+    /// \param [in] count_ The number of pins in the list
+    /// \note Invalid and repeated pins are ignored
+    pin_group (
+        mcp23s17 & gpio_x_,
+        const uint8_t * const pins_,
+        const size_t count_
+    );
+
+    // Accessor method(s)
+
+    /// \brief The expander pins occupied by the group
+    inline
+    uint16_t
+    getPinMask (
+        void
+    ) const {
+        return _pin_mask;
+    }
+
+    /// \brief The number of bits in the group
+    inline
+    uint8_t
+    getWidth (
+        void
+    ) const {
+        return _width;
+    }
+
+    // Public method(s)
+
+    /// \brief Set the mode of every pin in the group
+    /// \param [in] mode_ The direction to set the GPIO pins
+    /// \note See `mcp23s17::pinModes`
+    void
+    pinMode (
+        const mcp23s17::PinMode mode_
+    );
+
+    /// \brief Read the group as an integer
+    /// \return The levels of the pins, least significant bit first
+    /// \note Costs a single 3-byte (one port) or 4-byte (both ports)
+    /// transaction
+    uint16_t
+    read (
+        void
+    ) const;
+
+    /// \brief Write the group as an integer
+    /// \param [in] value_ The levels of the pins, least significant bit
+    /// first (bits beyond the width are ignored)
+    /// \note Every pin changes in the same transaction, so no
+    /// intermediate values appear on the wire. Nothing is sent when the
+    /// latches already hold the value.
+    void
+    write (
+        const uint16_t value_
+    );
+
+  private:
+    // Private instance variable(s)
+
+    /// \brief A run of consecutive pins carrying consecutive bits
+    struct Run {
+        uint8_t value_shift;  ///< The position of the first bit in the value
+        uint8_t pin_shift;  ///< The first pin of the run
+        uint16_t mask;  ///< The bits of the run (unshifted)
+    };
+
+    mcp23s17 & _gpio_x;
+    Run _run[mcp23s17::PIN_COUNT];
+    uint8_t _run_count;
+    uint8_t _width;
+    uint16_t _pin_mask;
+
+    // Private method(s)
+
+    /// \brief Gather pin levels into a value
+    uint16_t
+    gather (
+        const uint16_t levels_
+    ) const;
+
+    /// \brief Scatter a value onto pin levels
+    uint16_t
+    scatter (
+        const uint16_t value_
+    ) const;
+};
+
+#endif
+
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
@@ -0,0 +1,113 @@
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
+
+#include "pin_space.h"
+
+namespace {
+
+const uint8_t DEVICES_PER_WORD = 2;
+
+} // namespace
+
+pin_space::pin_space (
+    mcp23s17 * const * const devices_,
+    const size_t count_
+) :
+    _device{ nullptr },
+    _latch{ { 0 } },
+    _output{ { 0 } }
+{
+    for ( uint8_t device = 0 ; device < DEVICE_COUNT && devices_ && device < count_ ; ++device ) {
+        _device[device] = devices_[device];
+        updateLatch(device);
+    }
+}
+
+mcp23s17::PinLatchValue
+pin_space::digitalRead (
+    const uint8_t pin_
+) const {
+    const uint8_t device(pin_ / mcp23s17::PIN_COUNT);
+
+    if ( pin_ >= PIN_COUNT || !_device[device] ) { return mcp23s17::PinLatchValue::LOW; }
+    return _device[device]->digitalRead(pin_ % mcp23s17::PIN_COUNT);
+}
+
+void
+pin_space::digitalWrite (
+    const uint8_t pin_,
+    const mcp23s17::PinLatchValue value_
+) {
+    const uint8_t device(pin_ / mcp23s17::PIN_COUNT);
+
+    if ( pin_ >= PIN_COUNT || !_device[device] ) { return; }
+    _device[device]->digitalWrite((pin_ % mcp23s17::PIN_COUNT), value_);
+    updateLatch(device);
+
+    return;
+}
+
+void
+pin_space::pinMode (
+    const uint8_t pin_,
+    const mcp23s17::PinMode mode_
+) {
+    const uint8_t device(pin_ / mcp23s17::PIN_COUNT);
+
+    if ( pin_ >= PIN_COUNT || !_device[device] ) { return; }
+    _device[device]->pinMode((pin_ % mcp23s17::PIN_COUNT), mode_);
+    _output.set(pin_, (mcp23s17::PinMode::OUTPUT == mode_));
+
+    return;
+}
+
+pin_space::PinImage
+pin_space::read (
+    void
+) const {
+    PinImage image = { { 0 } };
+
+    for ( uint8_t device = 0 ; device < DEVICE_COUNT ; ++device ) {
+        if ( !_device[device] ) { continue; }
+        const unsigned int shift(mcp23s17::PIN_COUNT * (device % DEVICES_PER_WORD));
+        image.word[device / DEVICES_PER_WORD] |= (static_cast<uint32_t>(_device[device]->digitalReadPorts()) << shift);
+    }
+
+    return image;
+}
+
+void
+pin_space::write (
+    const PinImage & image_
+) {
+    for ( uint8_t word = 0 ; word < WORD_COUNT ; ++word ) {
+        const uint32_t changed((image_.word[word] ^ _latch.word[word]) & _output.word[word]);
+
+        if ( !changed ) { continue; }
+        for ( uint8_t half = 0 ; half < DEVICES_PER_WORD ; ++half ) {
+            const uint8_t device((word * DEVICES_PER_WORD) + half);
+            const unsigned int shift(mcp23s17::PIN_COUNT * half);
+            const uint16_t changed_pins(changed >> shift);
+
+            if ( !changed_pins ) { continue; }
+            _device[device]->digitalWritePorts((image_.word[word] >> shift), changed_pins);
+            updateLatch(device);
+        }
+    }
+
+    return;
+}
+
+void
+pin_space::updateLatch (
+    const uint8_t device_
+) {
+    const unsigned int shift(mcp23s17::PIN_COUNT * (device_ % DEVICES_PER_WORD));
+    uint32_t & word(_latch.word[device_ / DEVICES_PER_WORD]);
+
+    word &= ~(static_cast<uint32_t>(0xFFFF) << shift);
+    if ( _device[device_] ) { word |= (static_cast<uint32_t>(_device[device_]->getLatchValues()) << shift); }
+
+    return;
+}
+
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
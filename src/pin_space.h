@@ -0,0 +1,139 @@
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
+
+#ifndef PIN_SPACE_H
+#define PIN_SPACE_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "mcp23s17.h"
+
+/// \brief A unified 128-pin space across up to eight MCP23S17 devices
+/// \detail Pin `n` belongs to device `n / 16`, as pin `n % 16`. The
+/// latches and directions of every device are cached side by side in
+/// word-wide arrays (two devices per word), so comparing a complete
+/// image against the cache costs four XORs. Only the devices (and within
+/// them, only the ports) whose bits changed receive a transaction.
+/// \note The devices are expected to be configured through the pin
+/// space, so the cached directions describe the hardware
+class pin_space {
+  public:
+    // Definition(s)
+    static const uint8_t DEVICE_COUNT = 8;
+    static const uint8_t PIN_COUNT = (DEVICE_COUNT * mcp23s17::PIN_COUNT);
+    static const uint8_t WORD_COUNT = (PIN_COUNT / 32);
+
+    /// \brief An image of every pin in the space
+    /// \note Pin `n` occupies bit `n % 32` of `word[n / 32]`
+    struct PinImage {
+        uint32_t word[WORD_COUNT];
+
+        inline
+        bool
+        test (
+            const uint8_t pin_
+        ) const {
+            return ((pin_ < PIN_COUNT) && ((word[pin_ / 32] >> (pin_ % 32)) & 0x01));
+        }
+
+        inline
+        void
+        set (
+            const uint8_t pin_,
+            const bool value_ = true
+        ) {
+            if ( pin_ >= PIN_COUNT ) { return; }
+            if ( value_ ) {
+                word[pin_ / 32] |= (static_cast<uint32_t>(1) << (pin_ % 32));
+            } else {
+                word[pin_ / 32] &= ~(static_cast<uint32_t>(1) << (pin_ % 32));
+            }
+        }
+    };
+
+    // Constructor and destructor method(s)
+
+    /// \brief Object Constructor
+    /// \param [in] devices_ The device occupying each block of 16 pins
+    /// (nullptr where no device is present)
+    /// \param [in] count_ The number of entries in `devices_` (1-8)
+    pin_space (
+        mcp23s17 * const * const devices_,
+        const size_t count_
+    );
+
+    // Accessor method(s)
+
+    /// \brief Cached output latch values of every pin
+    inline
+    PinImage const &
+    getLatchImage (
+        void
+    ) const {
+        return _latch;
+    }
+
+    // Public method(s)
+
+    /// \brief Read from a GPIO pin
+    /// \param [in] pin_ The number associated with the pin (0-127)
+    /// \return HIGH or LOW based on the voltage level on the pin
+    mcp23s17::PinLatchValue
+    digitalRead (
+        const uint8_t pin_
+    ) const;
+
+    /// \brief Write HIGH or LOW on a pin
+    /// \param [in] pin_ The number associated with the pin (0-127)
+    /// \param [in] value_ The value set to the latch
+    void
+    digitalWrite (
+        const uint8_t pin_,
+        const mcp23s17::PinLatchValue value_
+    );
+
+    /// \brief Set pin mode
+    /// \param [in] pin_ The number associated with the pin (0-127)
+    /// \param [in] mode_ The direction to set the GPIO pin
+    void
+    pinMode (
+        const uint8_t pin_,
+        const mcp23s17::PinMode mode_
+    );
+
+    /// \brief Read every pin in the space
+    /// \return The levels of every pin (absent devices read as LOW)
+    /// \note Each device costs a single 4-byte transaction
+    PinImage
+    read (
+        void
+    ) const;
+
+    /// \brief Write every output pin in the space
+    /// \param [in] image_ The latch values of every pin (pins configured
+    /// as INPUT, and pins of absent devices, are ignored)
+    /// \note The image is compared against the cache a word at a time,
+    /// and only the ports with changed outputs are sent
+    void
+    write (
+        const PinImage & image_
+    );
+
+  private:
+    // Private instance variable(s)
+    mcp23s17 * _device[DEVICE_COUNT];
+    PinImage _latch;
+    PinImage _output;
+
+    // Private method(s)
+
+    /// \brief Refresh the cached latches of a device
+    void
+    updateLatch (
+        const uint8_t device_
+    );
+};
+
+#endif
+
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
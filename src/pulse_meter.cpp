@@ -0,0 +1,197 @@
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
+
+#include "pulse_meter.h"
+
+#if defined(TESTING)
+  #include "test/MOCK_wiring.h"
+#elif defined(ARDUINO) && (ARDUINO <= 100)
+  #include "Arduino.h"
+#elif defined(SPARK)
+  #include "application.h"
+#else
+  #include "WProgram.h"
+#endif
+
+namespace {
+
+unsigned long
+defaultClockSource (
+    void
+) {
+    return ::micros();
+}
+
+} // namespace
+
+pulse_meter::pulse_meter (
+    mcp23s17 & gpio_x_,
+    const clock_source_t clock_source_
+) :
+    _gpio_x(gpio_x_),
+    _clock_source(clock_source_ ? clock_source_ : defaultClockSource),
+    _channel{},
+    _attached(0x0000)
+{}
+
+uint32_t
+pulse_meter::getAveragePeriod (
+    const uint8_t pin_
+) const {
+    if ( pin_ >= mcp23s17::PIN_COUNT ) { return 0; }
+    if ( !_channel[pin_].period_count ) { return 0; }
+    return (_channel[pin_].period_sum / _channel[pin_].period_count);
+}
+
+uint32_t
+pulse_meter::getEdgeCount (
+    const uint8_t pin_
+) const {
+    if ( pin_ >= mcp23s17::PIN_COUNT ) { return 0; }
+    return _channel[pin_].edge_count;
+}
+
+float
+pulse_meter::getFrequency (
+    const uint8_t pin_
+) const {
+    const uint32_t average_period(getAveragePeriod(pin_));
+
+    if ( !average_period ) { return 0.0f; }
+    return (1000000.0f / average_period);
+}
+
+uint32_t
+pulse_meter::getPeriod (
+    const uint8_t pin_
+) const {
+    if ( pin_ >= mcp23s17::PIN_COUNT ) { return 0; }
+    return _channel[pin_].period;
+}
+
+uint32_t
+pulse_meter::getPulseWidth (
+    const uint8_t pin_
+) const {
+    if ( pin_ >= mcp23s17::PIN_COUNT ) { return 0; }
+    return _channel[pin_].pulse_width;
+}
+
+bool
+pulse_meter::attach (
+    const uint8_t pin_,
+    const mcp23s17::PinMode mode_
+) {
+    if ( pin_ >= mcp23s17::PIN_COUNT ) { return false; }
+    if ( mcp23s17::PinMode::INPUT != mode_ && mcp23s17::PinMode::INPUT_PULLUP != mode_ ) { return false; }
+
+    _gpio_x.pinMode(pin_, mode_);
+    // Only this pin's configuration is derived, so the DEFVAL and INTCON bits of its neighbors are kept
+    _gpio_x.attachInterrupts((static_cast<uint16_t>(1) << pin_), nullptr, mcp23s17::InterruptMode::CHANGE);
+
+    reset(pin_);
+    _channel[pin_].level = ((_gpio_x.digitalReadPorts(1 << pin_) >> pin_) & 0x01);
+    _attached |= (1 << pin_);
+
+    return true;
+}
+
+void
+pulse_meter::detach (
+    const uint8_t pin_
+) {
+    if ( pin_ >= mcp23s17::PIN_COUNT ) { return; }
+
+    _gpio_x.detachInterrupt(pin_);
+    _attached &= ~(1 << pin_);
+
+    return;
+}
+
+void
+pulse_meter::reset (
+    const uint8_t pin_
+) {
+    if ( pin_ >= mcp23s17::PIN_COUNT ) { return; }
+
+    const bool level(_channel[pin_].level);
+    _channel[pin_] = Channel();
+    _channel[pin_].level = level;
+
+    return;
+}
+
+void
+pulse_meter::service (
+    void
+) {
+    return update(_gpio_x.serviceInterrupts());
+}
+
+void
+pulse_meter::update (
+    const mcp23s17::InterruptSnapshot & snapshot_
+) {
+    const unsigned long timestamp(_clock_source());
+    uint16_t captured_port_mask(0x0000);
+
+    // INTCAP only holds valid data for the ports that raised the interrupt
+    if ( snapshot_.flags & 0x00FF ) { captured_port_mask |= 0x00FF; }
+    if ( snapshot_.flags & 0xFF00 ) { captured_port_mask |= 0xFF00; }
+    const uint16_t captured_levels((snapshot_.capture & captured_port_mask) | (snapshot_.levels & ~captured_port_mask));
+
+    for ( uint8_t pin = 0 ; pin < mcp23s17::PIN_COUNT ; ++pin ) {
+        if ( !((_attached >> pin) & 0x01) ) { continue; }
+
+        const bool captured_level((captured_levels >> pin) & 0x01);
+        const bool level((snapshot_.levels >> pin) & 0x01);
+        Channel & channel(_channel[pin]);
+
+        // A lone edge (before or after the capture) is timed. Two edges before service share a timestamp, so they are counted but not timed.
+        const bool double_edge((captured_level != channel.level) && (level != captured_level));
+        if ( captured_level != channel.level ) { edge(channel, captured_level, timestamp, !double_edge); }
+        if ( level != channel.level ) { edge(channel, level, timestamp, !double_edge); }
+    }
+
+    return;
+}
+
+void
+pulse_meter::edge (
+    Channel & channel_,
+    const bool level_,
+    const unsigned long timestamp_,
+    const bool timed_
+) {
+    ++channel_.edge_count;
+    channel_.level = level_;
+
+    if ( !timed_ ) {
+        // The next measurement must start from a known edge
+        channel_.risen = false;
+        return;
+    }
+
+    if ( level_ ) {
+        if ( channel_.risen ) {
+            channel_.period = (timestamp_ - channel_.rise_timestamp);
+
+            // Moving average (fixed-size ring of periods)
+            if ( channel_.period_count < AVERAGE_LENGTH ) {
+                ++channel_.period_count;
+            } else {
+                channel_.period_sum -= channel_.periods[channel_.period_index];
+            }
+            channel_.periods[channel_.period_index] = channel_.period;
+            channel_.period_sum += channel_.period;
+            channel_.period_index = ((channel_.period_index + 1) % AVERAGE_LENGTH);
+        }
+        channel_.rise_timestamp = timestamp_;
+        channel_.risen = true;
+    } else if ( channel_.risen ) {
+        channel_.pulse_width = (timestamp_ - channel_.rise_timestamp);
+    }
+
+    return;
+}
+
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
@@ -0,0 +1,144 @@
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
+
+#ifndef PULSE_METER_H
+#define PULSE_METER_H
+
+#include <cstdint>
+
+#include "mcp23s17.h"
+
+/// \brief Pulse width and frequency measurement on MCP23S17 inputs
+/// \detail Each measured pin is configured to interrupt on change, and
+/// every call to `service` (or `update`) timestamps the edges found in
+/// the interrupt snapshot with the clock source. Per pin, the meter
+/// keeps the edge count, the last period (rising edge to rising edge),
+/// the last pulse width (rising edge to falling edge) and a moving
+/// average of the last `AVERAGE_LENGTH` periods.
+/// \note The timestamps are taken when the interrupt is serviced, so
+/// the resolution of each measurement is the service latency
+class pulse_meter {
+  public:
+    typedef unsigned long(*clock_source_t)(void);
+
+    // Constructor and destructor method(s)
+
+    /// \brief Object Constructor
+    /// \param [in] gpio_x_ The expander the pulses are measured on
+    /// \param [in] clock_source_ The clock used to timestamp each edge
+    /// (default: `micros`)
+    /// \note The units of every period and pulse width are the units
+    /// of the clock source, and `getFrequency` assumes microseconds
+    pulse_meter (
+        mcp23s17 & gpio_x_,
+        const clock_source_t clock_source_ = nullptr
+    );
+
+    // Accessor method(s)
+
+    /// \brief Moving average of the last `AVERAGE_LENGTH` periods
+    uint32_t
+    getAveragePeriod (
+        const uint8_t pin_
+    ) const;
+
+    /// \brief Number of edges (rising and falling) observed
+    uint32_t
+    getEdgeCount (
+        const uint8_t pin_
+    ) const;
+
+    /// \brief Frequency (Hz) derived from the moving average period
+    /// \return 0 until a full period has been measured
+    float
+    getFrequency (
+        const uint8_t pin_
+    ) const;
+
+    /// \brief Time between the two most recent rising edges
+    uint32_t
+    getPeriod (
+        const uint8_t pin_
+    ) const;
+
+    /// \brief Time between the most recent rising edge and the
+    /// falling edge that followed it
+    uint32_t
+    getPulseWidth (
+        const uint8_t pin_
+    ) const;
+
+    // Public instance variable(s)
+    static const uint8_t AVERAGE_LENGTH = 8;
+
+    // Public method(s)
+
+    /// \brief Measure the pulses on a pin
+    /// \param [in] pin_ The pin to measure
+    /// \param [in] mode_ INPUT or INPUT_PULLUP
+    /// \return true if the pin is being measured
+    bool
+    attach (
+        const uint8_t pin_,
+        const mcp23s17::PinMode mode_ = mcp23s17::PinMode::INPUT
+    );
+
+    /// \brief Stop measuring the pulses on a pin
+    void
+    detach (
+        const uint8_t pin_
+    );
+
+    /// \brief Clear the measurements of a pin
+    void
+    reset (
+        const uint8_t pin_
+    );
+
+    /// \brief Service the expander interrupt and timestamp every edge
+    void
+    service (
+        void
+    );
+
+    /// \brief Timestamp the edges in an interrupt snapshot
+    /// \param [in] snapshot_ The result of `mcp23s17::serviceInterrupts`
+    /// \note Use in place of `service` when the expander is shared with
+    /// other interrupt consumers
+    void
+    update (
+        const mcp23s17::InterruptSnapshot & snapshot_
+    );
+
+  private:
+    // Private instance variable(s)
+    struct Channel {
+        uint32_t edge_count;
+        unsigned long rise_timestamp;
+        uint32_t period;
+        uint32_t pulse_width;
+        uint32_t periods[AVERAGE_LENGTH];
+        uint32_t period_sum;
+        uint8_t period_count;
+        uint8_t period_index;
+        bool level;
+        bool risen;
+    };
+
+    mcp23s17 & _gpio_x;
+    const clock_source_t _clock_source;
+    Channel _channel[mcp23s17::PIN_COUNT];
+    uint16_t _attached;
+
+    // Private method(s)
+    void
+    edge (
+        Channel & channel_,
+        const bool level_,
+        const unsigned long timestamp_,
+        const bool timed_
+    );
+};
+
+#endif
+
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
@@ -0,0 +1,145 @@
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
+
+#include "quadrature_decoder.h"
+
+#if defined(TESTING)
+  #include "test/MOCK_wiring.h"
+#elif defined(ARDUINO) && (ARDUINO <= 100)
+  #include "Arduino.h"
+#elif defined(SPARK)
+  #include "application.h"
+#else
+  #include "WProgram.h"
+#endif
+
+namespace {
+
+const int8_t SKIP = 2;
+
+/// \brief Quadrature state transitions, indexed by (previous state << 2) | current state
+/// \note Each state is (B << 1) | A, and the Gray code sequence 00 => 01 => 11 => 10 counts up
+const int8_t TRANSITION[16] = {
+     0, +1, -1, SKIP,
+    -1,  0, SKIP, +1,
+    +1, SKIP,  0, -1,
+    SKIP, -1, +1,  0,
+};
+
+} // namespace
+
+quadrature_decoder::quadrature_decoder (
+    mcp23s17 & gpio_x_
+) :
+    _gpio_x(gpio_x_),
+    _encoder{},
+    _attached(0x00),
+    _rate_timestamp_us(0)
+{}
+
+int32_t
+quadrature_decoder::getCount (
+    const uint8_t encoder_
+) const {
+    if ( encoder_ >= MAX_ENCODERS ) { return 0; }
+    return _encoder[encoder_].count;
+}
+
+int32_t
+quadrature_decoder::getRate (
+    const uint8_t encoder_
+) const {
+    if ( encoder_ >= MAX_ENCODERS ) { return 0; }
+    return _encoder[encoder_].rate;
+}
+
+uint32_t
+quadrature_decoder::getSkipCount (
+    const uint8_t encoder_
+) const {
+    if ( encoder_ >= MAX_ENCODERS ) { return 0; }
+    return _encoder[encoder_].skip_count;
+}
+
+bool
+quadrature_decoder::attach (
+    const uint8_t encoder_,
+    const uint8_t pin_a_,
+    const uint8_t pin_b_
+) {
+    if ( encoder_ >= MAX_ENCODERS ) { return false; }
+    if ( pin_a_ >= mcp23s17::PIN_COUNT || pin_b_ >= mcp23s17::PIN_COUNT || pin_a_ == pin_b_ ) { return false; }
+
+    const uint16_t pin_mask((1 << pin_a_) | (1 << pin_b_));
+
+    _gpio_x.pinModes(pin_mask, mcp23s17::PinMode::INPUT_PULLUP);
+    _gpio_x.attachInterrupts(pin_mask, nullptr, mcp23s17::InterruptMode::CHANGE);
+
+    _encoder[encoder_] = Encoder();
+    _encoder[encoder_].pin_a = pin_a_;
+    _encoder[encoder_].pin_b = pin_b_;
+
+    // Establish the initial state
+    step(_encoder[encoder_], _gpio_x.digitalReadPorts((1 << pin_a_) | (1 << pin_b_)));
+    _encoder[encoder_].count = 0;
+    _encoder[encoder_].skip_count = 0;
+    _attached |= (1 << encoder_);
+
+    return true;
+}
+
+void
+quadrature_decoder::service (
+    void
+) {
+    return update(_gpio_x.serviceInterrupts());
+}
+
+void
+quadrature_decoder::update (
+    const mcp23s17::InterruptSnapshot & snapshot_
+) {
+    const unsigned long now_us(::micros());
+    const unsigned long elapsed_us(now_us - _rate_timestamp_us);
+    uint16_t captured_port_mask(0x0000);
+
+    // INTCAP only holds valid data for the ports that raised the interrupt
+    if ( snapshot_.flags & 0x00FF ) { captured_port_mask |= 0x00FF; }
+    if ( snapshot_.flags & 0xFF00 ) { captured_port_mask |= 0xFF00; }
+    const uint16_t captured_levels((snapshot_.capture & captured_port_mask) | (snapshot_.levels & ~captured_port_mask));
+
+    for ( uint8_t i = 0 ; i < MAX_ENCODERS ; ++i ) {
+        if ( !((_attached >> i) & 0x01) ) { continue; }
+
+        // The capture records the first edge, while the levels catch any edge that followed before service
+        step(_encoder[i], captured_levels);
+        step(_encoder[i], snapshot_.levels);
+
+        if ( elapsed_us >= RATE_WINDOW_US ) {
+            _encoder[i].rate = static_cast<int32_t>((static_cast<int64_t>(_encoder[i].count - _encoder[i].rate_count) * 1000000) / static_cast<int64_t>(elapsed_us));
+            _encoder[i].rate_count = _encoder[i].count;
+        }
+    }
+    if ( elapsed_us >= RATE_WINDOW_US ) { _rate_timestamp_us = now_us; }
+
+    return;
+}
+
+void
+quadrature_decoder::step (
+    Encoder & encoder_,
+    const uint16_t levels_
+) {
+    const uint8_t state((((levels_ >> encoder_.pin_b) & 0x01) << 1) | ((levels_ >> encoder_.pin_a) & 0x01));
+    const int8_t transition(TRANSITION[(encoder_.state << 2) | state]);
+
+    if ( SKIP == transition ) {
+        ++encoder_.skip_count;
+    } else {
+        encoder_.count += transition;
+    }
+    encoder_.state = state;
+
+    return;
+}
+
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
@@ -0,0 +1,110 @@
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
+
+#ifndef QUADRATURE_DECODER_H
+#define QUADRATURE_DECODER_H
+
+#include <cstdint>
+
+#include "mcp23s17.h"
+
+/// \brief Quadrature rotary encoder decoding driven by MCP23S17 interrupts
+/// \detail Each encoder occupies a pair of pins configured to interrupt
+/// on change. A single call to `mcp23s17::serviceInterrupts` captures
+/// every pin, so one service read updates up to eight encoders. The
+/// captured levels (INTCAP) and the levels at service time (GPIO) are
+/// both fed through a table-driven state machine, and transitions that
+/// skip a state (both pins changed) are counted instead of guessed.
+class quadrature_decoder {
+  public:
+    // Constructor and destructor method(s)
+
+    /// \brief Object Constructor
+    /// \param [in] gpio_x_ The expander the encoders are attached to
+    quadrature_decoder (
+        mcp23s17 & gpio_x_
+    );
+
+    // Accessor method(s)
+
+    /// \brief Signed count of an encoder (one count per state transition)
+    int32_t
+    getCount (
+        const uint8_t encoder_
+    ) const;
+
+    /// \brief Counts per second of an encoder
+    /// \note Updated once per `RATE_WINDOW_US` while servicing
+    int32_t
+    getRate (
+        const uint8_t encoder_
+    ) const;
+
+    /// \brief Number of transitions that skipped a state
+    /// \note A non-zero value indicates the encoder is changing faster
+    /// than the interrupts are being serviced
+    uint32_t
+    getSkipCount (
+        const uint8_t encoder_
+    ) const;
+
+    // Public instance variable(s)
+    static const uint8_t MAX_ENCODERS = 8;
+    static const uint32_t RATE_WINDOW_US = 100000;
+
+    // Public method(s)
+
+    /// \brief Attach an encoder to a pair of pins
+    /// \param [in] encoder_ The index of the encoder (0-7)
+    /// \param [in] pin_a_ The pin connected to channel A
+    /// \param [in] pin_b_ The pin connected to channel B
+    /// \return true if the encoder was attached
+    bool
+    attach (
+        const uint8_t encoder_,
+        const uint8_t pin_a_,
+        const uint8_t pin_b_
+    );
+
+    /// \brief Service the expander interrupt and update every encoder
+    void
+    service (
+        void
+    );
+
+    /// \brief Update every encoder from an interrupt snapshot
+    /// \param [in] snapshot_ The result of `mcp23s17::serviceInterrupts`
+    /// \note Use in place of `service` when the expander is shared with
+    /// other interrupt consumers
+    void
+    update (
+        const mcp23s17::InterruptSnapshot & snapshot_
+    );
+
+  private:
+    // Private instance variable(s)
+    struct Encoder {
+        uint8_t pin_a;
+        uint8_t pin_b;
+        uint8_t state;
+        int32_t count;
+        int32_t rate_count;
+        int32_t rate;
+        uint32_t skip_count;
+    };
+
+    mcp23s17 & _gpio_x;
+    Encoder _encoder[MAX_ENCODERS];
+    uint8_t _attached;
+    unsigned long _rate_timestamp_us;
+
+    // Private method(s)
+    void
+    step (
+        Encoder & encoder_,
+        const uint16_t levels_
+    );
+};
+
+#endif
+
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
@@ -0,0 +1,131 @@
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
+
+#include "spi_bus.h"
+
+#if defined(MCP23S17_HOST)
+
+namespace {
+
+// Waiting threads spin briefly (frames last microseconds), then yield
+const unsigned int SPIN_LIMIT = 64;
+
+} // namespace
+
+spi_bus::spi_bus (
+    void
+) :
+    _next_ticket(0),
+    _now_serving(0),
+    _owner(std::thread::id()),
+    _depth(0),
+    _acquired_at(),
+    _statistics{ 0, 0, 0, 0, 0 }
+{}
+
+spi_bus::Statistics
+spi_bus::getStatistics (
+    void
+) {
+    std::chrono::steady_clock::time_point waiting_since;
+    Statistics statistics;
+
+    // Reading the statistics is not counted as a use of the bus
+    if ( std::this_thread::get_id() == _owner.load(std::memory_order_relaxed) ) { return _statistics; }
+    waitForTurn(waiting_since);
+    statistics = _statistics;
+    passTurn();
+
+    return statistics;
+}
+
+void
+spi_bus::acquire (
+    void
+) {
+    const std::thread::id self(std::this_thread::get_id());
+    std::chrono::steady_clock::time_point waiting_since;
+
+    // Only the owner could have stored its own id, so reentry is detected without synchronization
+    if ( self == _owner.load(std::memory_order_relaxed) ) {
+        ++_depth;
+        return;
+    }
+
+    const bool contended(waitForTurn(waiting_since));
+    _acquired_at = std::chrono::steady_clock::now();
+    _owner.store(self, std::memory_order_relaxed);
+
+    ++_statistics.acquisitions;
+    if ( contended ) {
+        ++_statistics.contentions;
+        _statistics.wait_time_ns += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(_acquired_at - waiting_since).count());
+    }
+
+    return;
+}
+
+void
+spi_bus::release (
+    void
+) {
+    if ( _depth ) {
+        --_depth;
+        return;
+    }
+
+    const uint64_t hold_time_ns(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _acquired_at).count()));
+    _statistics.hold_time_ns += hold_time_ns;
+    if ( hold_time_ns > _statistics.max_hold_time_ns ) { _statistics.max_hold_time_ns = hold_time_ns; }
+
+    _owner.store(std::thread::id(), std::memory_order_relaxed);
+    passTurn();
+
+    return;
+}
+
+void
+spi_bus::resetStatistics (
+    void
+) {
+    std::chrono::steady_clock::time_point waiting_since;
+
+    if ( std::this_thread::get_id() == _owner.load(std::memory_order_relaxed) ) {
+        _statistics = Statistics{ 0, 0, 0, 0, 0 };
+        return;
+    }
+    waitForTurn(waiting_since);
+    _statistics = Statistics{ 0, 0, 0, 0, 0 };
+    passTurn();
+
+    return;
+}
+
+void
+spi_bus::passTurn (
+    void
+) {
+    // Only the holder advances the counter, so the next ticket is served without a read-modify-write
+    _now_serving.store((_now_serving.load(std::memory_order_relaxed) + 1), std::memory_order_release);
+
+    return;
+}
+
+bool
+spi_bus::waitForTurn (
+    std::chrono::steady_clock::time_point & waiting_since_
+) {
+    const uint32_t ticket(_next_ticket.fetch_add(1, std::memory_order_relaxed));
+
+    if ( ticket == _now_serving.load(std::memory_order_acquire) ) { return false; }
+
+    waiting_since_ = std::chrono::steady_clock::now();
+    for ( unsigned int spin = 0 ; ticket != _now_serving.load(std::memory_order_acquire) ; ++spin ) {
+        if ( spin >= SPIN_LIMIT ) { std::this_thread::yield(); }
+    }
+
+    return true;
+}
+
+#endif // MCP23S17_HOST
+
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
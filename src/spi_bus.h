@@ -0,0 +1,103 @@
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
+
+#ifndef SPI_BUS_H
+#define SPI_BUS_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "mcp23s17.h"
+
+#if defined(MCP23S17_HOST)
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+/// \brief Arbitrates a shared SPI bus between threads
+/// \detail Every device on the bus (and any transport driving it) holds
+/// the bus from chip select to chip deselect, so whole frames are
+/// serialized. The lock is a ticket lock: an uncontended acquisition is
+/// a single atomic increment, and contending threads are served in the
+/// order they arrived. Each bus is independent, so threads driving
+/// different buses never wait on one another.
+/// \note The owner may acquire the bus again (e.g. from a callback), and
+/// must release it as many times
+/// \note Host platforms only
+class spi_bus {
+  public:
+    // Definition(s)
+
+    /// \brief Arbitration statistics
+    struct Statistics {
+        uint32_t acquisitions;  ///< Outermost acquisitions of the bus
+        uint32_t contentions;  ///< Acquisitions that had to wait for another thread
+        uint64_t hold_time_ns;  ///< Total time the bus was held
+        uint64_t max_hold_time_ns;  ///< Longest single hold of the bus
+        uint64_t wait_time_ns;  ///< Total time spent waiting for the bus
+    };
+
+    // Constructor and destructor method(s)
+    spi_bus (
+        void
+    );
+
+    // Accessor method(s)
+
+    /// \brief A consistent copy of the arbitration statistics
+    Statistics
+    getStatistics (
+        void
+    );
+
+    // Public method(s)
+
+    /// \brief Wait for the bus, then hold it
+    void
+    acquire (
+        void
+    );
+
+    /// \brief Release the bus to the next waiting thread
+    void
+    release (
+        void
+    );
+
+    /// \brief Clear the arbitration statistics
+    void
+    resetStatistics (
+        void
+    );
+
+  private:
+    // Private instance variable(s)
+    std::atomic<uint32_t> _next_ticket;
+    std::atomic<uint32_t> _now_serving;
+    std::atomic<std::thread::id> _owner;
+    unsigned int _depth;
+    std::chrono::steady_clock::time_point _acquired_at;
+    Statistics _statistics;
+
+    // Private method(s)
+
+    /// \brief Release the turn to the next ticket
+    void
+    passTurn (
+        void
+    );
+
+    /// \brief Take a ticket, and wait until it is served
+    /// \param [out] waiting_since_ When the wait began (set only when contended)
+    /// \return Whether the bus was held by another thread
+    bool
+    waitForTurn (
+        std::chrono::steady_clock::time_point & waiting_since_
+    );
+};
+
+#endif // MCP23S17_HOST
+
+#endif
+
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
@@ -0,0 +1,65 @@
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
+
+#include "spi_transport.h"
+
+#if defined(TESTING)
+  #include "test/MOCK_wiring.h"
+#elif defined(ARDUINO) && (ARDUINO <= 100)
+  #include "Arduino.h"
+#elif defined(SPARK)
+  #include "application.h"
+#else
+  #include "WProgram.h"
+#endif
+
+void
+spi_transport::begin (
+    void
+) {
+    ::SPI.begin();
+
+    return;
+}
+
+void
+spi_transport::complete (
+    Frame & frame_
+) {
+    if ( !frame_.on_complete ) { return; }
+    return frame_.on_complete(frame_);
+}
+
+void
+spi_transport::exchange (
+    Frame & frame_
+) {
+    ::digitalWrite(SS, LOW);
+    for ( size_t i = 0 ; i < frame_.length ; ++i ) {
+        frame_.data[i] = ::SPI.transfer(frame_.data[i]);
+    }
+    ::digitalWrite(SS, HIGH);
+    frame_.failed = false;
+
+    return;
+}
+
+bool
+spi_transport::transfer (
+    Frame & frame_
+) {
+    exchange(frame_);
+
+    return true;
+}
+
+bool
+blocking_transport::submit (
+    Frame & frame_
+) {
+    exchange(frame_);
+    complete(frame_);
+
+    return true;
+}
+
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
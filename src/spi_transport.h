@@ -0,0 +1,126 @@
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
+
+#ifndef SPI_TRANSPORT_H
+#define SPI_TRANSPORT_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "mcp23s17.h"
+
+/// \brief Completes prepared SPI frames on behalf of the caller
+/// \detail A frame is a complete chip-select-framed transaction, prepared
+/// ahead of time (see `mcp23s17_async`). A transport accepts frames in
+/// order, exchanges them on the bus, and invokes the completion handler
+/// of each frame once the bytes received have replaced the bytes sent.
+/// Implementations may complete frames immediately (`blocking_transport`),
+/// from a worker thread (`thread_transport`) or from a DMA interrupt.
+/// \note Frames must be completed in the order they are submitted
+class spi_transport {
+  public:
+    // Definition(s)
+    struct Frame;
+    typedef void(*completion_t)(Frame & frame_);
+
+    /// \brief A prepared SPI frame
+    struct Frame {
+        uint8_t data[mcp23s17::MAX_FRAME_LENGTH];  ///< The bytes to send, replaced by the bytes received
+        uint8_t length;  ///< The number of bytes in the frame
+        completion_t on_complete;  ///< Invoked once the frame has been exchanged
+        void * context;  ///< Owner of the frame
+        bool failed;  ///< Set when the frame could not be exchanged (the bytes received are invalid)
+    };
+
+    // Constructor and destructor method(s)
+    virtual
+    ~spi_transport (
+        void
+    ) {}
+
+    // Public method(s)
+
+    /// \brief Prepare the bus for the first frame
+    /// \note Called by each `mcp23s17` constructed over the transport
+    virtual
+    void
+    begin (
+        void
+    );
+
+    /// \brief Whether `SPI` may drive the devices directly
+    /// \note Streams hold chip select across a whole session (see
+    /// `mcp23s17::digitalWriteStream`), so they are only available on
+    /// transports that exchange frames on `SPI`
+    virtual
+    bool
+    isStreamCapable (
+        void
+    ) const {
+        return true;
+    }
+
+    /// \brief Make progress on the frames in flight
+    /// \note Only required by transports that are driven by polling
+    virtual
+    void
+    poll (
+        void
+    ) {}
+
+    /// \brief Queue a frame for exchange
+    /// \param [in] frame_ The frame (must remain valid until completion)
+    /// \return false if the frame could not be accepted
+    virtual
+    bool
+    submit (
+        Frame & frame_
+    ) = 0;
+
+    /// \brief Exchange a frame before returning, without completing it
+    /// \param [in] frame_ The frame (its completion handler is not invoked)
+    /// \return false if the frame could not be exchanged
+    /// \note Used by the blocking methods of `mcp23s17`. By default, the
+    /// frame is exchanged on `SPI` immediately; a transport that cannot
+    /// reach `SPI` (e.g. `spidev_transport`) exchanges the frames already
+    /// submitted first, so the device sees every frame in order.
+    virtual
+    bool
+    transfer (
+        Frame & frame_
+    );
+
+  protected:
+    // Protected method(s)
+
+    /// \brief Invoke the completion handler of a frame
+    static
+    void
+    complete (
+        Frame & frame_
+    );
+
+    /// \brief Exchange a frame on the bus in a single transaction
+    /// \note `SPI` cannot fail, so the frame is never marked failed
+    static
+    void
+    exchange (
+        Frame & frame_
+    );
+};
+
+/// \brief Synchronous, in-order transport
+/// \detail Each frame is exchanged and completed before `submit` returns.
+/// Intended for platforms without DMA, where it provides the same API as
+/// the asynchronous transports.
+class blocking_transport : public spi_transport {
+  public:
+    // Public method(s)
+    bool
+    submit (
+        Frame & frame_
+    ) override;
+};
+
+#endif
+
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
@@ -0,0 +1,200 @@
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
+
+#include "spidev_transport.h"
+
+#if defined(MCP23S17_HOST) && defined(__linux__)
+
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+namespace {
+
+const uint8_t BITS_PER_WORD = 8;
+const uint8_t MODE = SPI_MODE_0;
+
+} // namespace
+
+spidev_transport::spidev_transport (
+    const char * const path_,
+    const uint32_t speed_hz_
+) :
+    _fd(-1),
+    _owns_fd(true),
+    _speed_hz(speed_hz_),
+    _ioctl(systemIoctl),
+    _queue_head(0),
+    _exchanged_length(0),
+    _batch_length(0),
+    _completing(false),
+    _error_count(0),
+    _message_count(0)
+{
+    uint8_t mode(MODE);
+    uint8_t bits_per_word(BITS_PER_WORD);
+    uint32_t speed_hz(speed_hz_);
+
+    if ( !path_ ) { return; }
+    _fd = ::open(path_, O_RDWR | O_CLOEXEC);
+    if ( _fd < 0 ) { return; }
+
+    if ( _ioctl(_fd, SPI_IOC_WR_MODE, &mode) < 0
+      || _ioctl(_fd, SPI_IOC_WR_BITS_PER_WORD, &bits_per_word) < 0
+      || _ioctl(_fd, SPI_IOC_WR_MAX_SPEED_HZ, &speed_hz) < 0
+    ) {
+        ::close(_fd);
+        _fd = -1;
+    }
+}
+
+spidev_transport::spidev_transport (
+    const int fd_,
+    const uint32_t speed_hz_,
+    const ioctl_t ioctl_
+) :
+    _fd(fd_),
+    _owns_fd(false),
+    _speed_hz(speed_hz_),
+    _ioctl(ioctl_ ? ioctl_ : systemIoctl),
+    _queue_head(0),
+    _exchanged_length(0),
+    _batch_length(0),
+    _completing(false),
+    _error_count(0),
+    _message_count(0)
+{}
+
+spidev_transport::~spidev_transport (
+    void
+) {
+    flush();
+    if ( _owns_fd && _fd >= 0 ) { ::close(_fd); }
+}
+
+bool
+spidev_transport::flush (
+    void
+) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    const bool exchanged(exchangeBatch());
+
+    // A single thread completes the frames, so they are completed in order, even when several threads flush
+    if ( _completing ) { return exchanged; }
+    _completing = true;
+    while ( _exchanged_length ) {
+        Frame * const frame(_queue[_queue_head]);
+        _queue_head = ((_queue_head + 1) % MAX_QUEUE);
+        --_exchanged_length;
+
+        // The lock is released while completing, so completion handlers may submit again
+        lock.unlock();
+        complete(*frame);
+        lock.lock();
+    }
+    _completing = false;
+
+    return exchanged;
+}
+
+void
+spidev_transport::poll (
+    void
+) {
+    flush();
+
+    return;
+}
+
+bool
+spidev_transport::submit (
+    Frame & frame_
+) {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if ( _fd < 0 ) { return false; }
+
+    // A full batch is exchanged, but its frames are left for `flush` to complete, so completion handlers never run within `submit`
+    if ( _batch_length == MAX_BATCH ) { exchangeBatch(); }
+    if ( (_exchanged_length + _batch_length) == MAX_QUEUE ) { return false; }
+    _queue[(_queue_head + _exchanged_length + _batch_length) % MAX_QUEUE] = &frame_;
+    ++_batch_length;
+
+    return true;
+}
+
+bool
+spidev_transport::transfer (
+    Frame & frame_
+) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    Frame * const frames[] = { &frame_ };
+
+    // The frames already submitted are exchanged first, so the chip sees every frame in order
+    exchangeBatch();
+
+    return exchangeFrames(frames, 1);
+}
+
+bool
+spidev_transport::exchangeBatch (
+    void
+) {
+    Frame * batch[MAX_BATCH];
+    bool exchanged;
+
+    if ( !_batch_length ) { return true; }
+
+    for ( size_t i = 0 ; i < _batch_length ; ++i ) {
+        batch[i] = _queue[(_queue_head + _exchanged_length + i) % MAX_QUEUE];
+    }
+    exchanged = exchangeFrames(batch, _batch_length);
+    _exchanged_length += _batch_length;
+    _batch_length = 0;
+
+    return exchanged;
+}
+
+bool
+spidev_transport::exchangeFrames (
+    Frame * const * const frames_,
+    const size_t count_
+) {
+    bool exchanged(true);
+
+    // Chip select is released between frames, but not after the last one (which would hold it asserted)
+    for ( size_t i = 0 ; i < count_ ; ++i ) {
+        ::memset(&_transfers[i], 0, sizeof(_transfers[i]));
+        _transfers[i].tx_buf = reinterpret_cast<uintptr_t>(frames_[i]->data);
+        _transfers[i].rx_buf = reinterpret_cast<uintptr_t>(frames_[i]->data);
+        _transfers[i].len = frames_[i]->length;
+        _transfers[i].speed_hz = _speed_hz;
+        _transfers[i].bits_per_word = BITS_PER_WORD;
+        _transfers[i].cs_change = (( (i + 1) < count_ ) ? 1 : 0);
+    }
+
+    ++_message_count;
+    if ( _fd < 0 || _ioctl(_fd, SPI_IOC_MESSAGE(count_), _transfers) < 0 ) {
+        ++_error_count;
+        exchanged = false;
+    }
+
+    // The received bytes of a failed message are the bytes sent, so the frames are marked
+    for ( size_t i = 0 ; i < count_ ; ++i ) { frames_[i]->failed = !exchanged; }
+
+    return exchanged;
+}
+
+int
+spidev_transport::systemIoctl (
+    int fd_,
+    unsigned long request_,
+    void * argument_
+) {
+    return ::ioctl(fd_, request_, argument_);
+}
+
+#endif // MCP23S17_HOST && __linux__
+
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
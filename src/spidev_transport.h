@@ -0,0 +1,194 @@
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
+
+#ifndef SPIDEV_TRANSPORT_H
+#define SPIDEV_TRANSPORT_H
+
+#include "spi_transport.h"
+
+#if defined(MCP23S17_HOST) && defined(__linux__)
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+#include <linux/spi/spidev.h>
+
+/// \brief Linux userspace transport over a spidev character device
+/// \detail Submitted frames are batched, and a batch is exchanged with a
+/// single `SPI_IOC_MESSAGE(n)` ioctl. Each frame is one transfer of the
+/// message, and `cs_change` deselects the chip between consecutive frames,
+/// so the chip sees exactly the transactions it would have seen one by
+/// one. A batch is sent by `flush` (or `poll`), or as soon as it is full,
+/// and the frames exchanged are completed in order by the next `flush`.
+/// A frame whose ioctl failed is completed with `Frame::failed` set.
+/// \note The kernel serializes the messages of every spidev handle on a
+/// bus, so no `spi_bus` is required between processes or threads
+/// \note Every method may be called from any thread. Completion handlers
+/// run on the thread calling `flush`, one at a time, without the lock, so
+/// they may submit again.
+/// \note `SPI` is never touched, so devices have no streaming methods
+/// (see `mcp23s17::isStreamCapable`)
+/// \note Host (Linux) platforms only
+class spidev_transport : public spi_transport {
+  public:
+    // Definition(s)
+    typedef int(*ioctl_t)(int fd_, unsigned long request_, void * argument_);
+
+    // Public instance variable(s)
+    static const size_t MAX_BATCH = 32;  ///< Frames exchanged per ioctl
+    static const size_t MAX_QUEUE = (2 * MAX_BATCH);  ///< Frames held between `submit` and their completion
+
+    // Constructor and destructor method(s)
+
+    /// \brief Object Constructor
+    /// \param [in] path_ The spidev character device (e.g. "/dev/spidev0.0")
+    /// \param [in] speed_hz_ The SCK frequency (the MCP23S17 supports 10MHz)
+    /// \note See `isOpen`
+    spidev_transport (
+        const char * const path_,
+        const uint32_t speed_hz_ = 10000000
+    );
+
+    /// \brief Object Constructor
+    /// \param [in] fd_ An open, configured spidev file descriptor (not
+    /// closed by the transport)
+    /// \param [in] speed_hz_ The SCK frequency of each transfer
+    /// \param [in] ioctl_ Issues the ioctl (a stand-in for the device under test)
+    spidev_transport (
+        const int fd_,
+        const uint32_t speed_hz_,
+        const ioctl_t ioctl_
+    );
+
+    /// \brief Object Destructor
+    /// \note Frames still batched are exchanged first
+    ~spidev_transport (
+        void
+    );
+
+    // Accessor method(s)
+
+    /// \brief The number of ioctls that have failed
+    inline
+    uint32_t
+    getErrorCount (
+        void
+    ) const {
+        return _error_count;
+    }
+
+    /// \brief The number of ioctls issued
+    inline
+    uint32_t
+    getMessageCount (
+        void
+    ) const {
+        return _message_count;
+    }
+
+    /// \brief Whether the device was opened and configured
+    inline
+    bool
+    isOpen (
+        void
+    ) const {
+        return (_fd >= 0);
+    }
+
+    /// \brief Frames are exchanged on the spidev device, never on `SPI`
+    inline
+    bool
+    isStreamCapable (
+        void
+    ) const override {
+        return false;
+    }
+
+    // Public method(s)
+
+    /// \brief The device was configured as it was opened
+    void
+    begin (
+        void
+    ) override {}
+
+    /// \brief Exchange the batched frames in a single ioctl, and complete
+    /// every frame exchanged
+    /// \return false if the ioctl failed (the frames are completed regardless,
+    /// so no operation is left in flight, but marked `Frame::failed`)
+    /// \note While another thread is completing frames, the frames are
+    /// left to it, and `flush` returns without waiting
+    bool
+    flush (
+        void
+    );
+
+    /// \brief Flush the batched frames
+    void
+    poll (
+        void
+    ) override;
+
+    /// \brief Queue a frame for exchange
+    /// \return false if the device is not open, or `MAX_QUEUE` frames
+    /// await completion (see `flush`)
+    bool
+    submit (
+        Frame & frame_
+    ) override;
+
+    /// \brief Exchange the batched frames, then the frame, in an ioctl of its own
+    /// \note The batched frames are completed by the next `flush`
+    bool
+    transfer (
+        Frame & frame_
+    ) override;
+
+  private:
+    // Private instance variable(s)
+    int _fd;
+    const bool _owns_fd;
+    const uint32_t _speed_hz;
+    const ioctl_t _ioctl;
+    std::mutex _mutex;
+    Frame * _queue[MAX_QUEUE];  ///< Ring of the frames exchanged (awaiting completion), followed by the batch
+    struct spi_ioc_transfer _transfers[MAX_BATCH];
+    size_t _queue_head;
+    size_t _exchanged_length;
+    size_t _batch_length;
+    bool _completing;
+    std::atomic<uint32_t> _error_count;
+    std::atomic<uint32_t> _message_count;
+
+    // Private method(s)
+
+    /// \brief Exchange the batch, which joins the frames awaiting completion
+    /// \note `_mutex` must be held
+    bool
+    exchangeBatch (
+        void
+    );
+
+    /// \brief Exchange frames in a single ioctl, and mark them failed if it fails
+    /// \note `_mutex` must be held
+    bool
+    exchangeFrames (
+        Frame * const * const frames_,
+        const size_t count_
+    );
+
+    static
+    int
+    systemIoctl (
+        int fd_,
+        unsigned long request_,
+        void * argument_
+    );
+};
+
+#endif // MCP23S17_HOST && __linux__
+
+#endif
+
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
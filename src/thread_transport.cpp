@@ -0,0 +1,119 @@
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
+
+#include "thread_transport.h"
+
+#if defined(MCP23S17_HOST)
+
+thread_transport::thread_transport (
+    spi_bus * const bus_
+) :
+    _bus(bus_),
+    _busy(false),
+    _exchanging(false),
+    _stop(false),
+    _worker(&thread_transport::run, this)
+{}
+
+thread_transport::~thread_transport (
+    void
+) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _queued.notify_one();
+    _worker.join();
+}
+
+void
+thread_transport::flush (
+    void
+) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _drained.wait(lock, [this](){ return (_queue.empty() && !_busy); });
+
+    return;
+}
+
+bool
+thread_transport::submit (
+    Frame & frame_
+) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if ( _stop ) { return false; }
+        _queue.push_back(Entry{ &frame_, false });
+    }
+    _queued.notify_one();
+
+    return true;
+}
+
+bool
+thread_transport::transfer (
+    Frame & frame_
+) {
+    // The bus is taken before the queue, in the order the worker takes them
+    if ( _bus ) { _bus->acquire(); }
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _exchanged.wait(lock, [this](){ return !_exchanging; });
+
+        // The frames already queued are exchanged first, so the chip sees every frame in order
+        for ( Entry & entry : _queue ) {
+            if ( entry.exchanged ) { continue; }
+            exchange(*entry.frame);
+            entry.exchanged = true;
+        }
+        exchange(frame_);
+    }
+    if ( _bus ) { _bus->release(); }
+
+    return true;
+}
+
+void
+thread_transport::run (
+    void
+) {
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    for (;;) {
+        _queued.wait(lock, [this](){ return (_stop || !_queue.empty()); });
+        if ( _queue.empty() ) { break; }
+
+
+        // The bus is taken before the queue, in the order `transfer` takes them
+        if ( _bus ) {
+            lock.unlock();
+            _bus->acquire();
+            lock.lock();
+        }
+
+        // Only the worker removes frames, so the queue cannot have emptied meanwhile
+        const Entry entry(_queue.front());
+        _queue.pop_front();
+        _busy = true;
+        _exchanging = !entry.exchanged;
+
+        // The queue is not needed while the frame is exchanged, so the lock is released
+        lock.unlock();
+        if ( !entry.exchanged ) { exchange(*entry.frame); }
+        if ( _bus ) { _bus->release(); }
+        lock.lock();
+        _exchanging = false;
+        _exchanged.notify_all();
+        lock.unlock();
+        complete(*entry.frame);
+        lock.lock();
+
+        _busy = false;
+        if ( _queue.empty() ) { _drained.notify_all(); }
+    }
+
+    return;
+}
+
+#endif // MCP23S17_HOST
+
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
@@ -0,0 +1,92 @@
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
+
+#ifndef THREAD_TRANSPORT_H
+#define THREAD_TRANSPORT_H
+
+#include "spi_bus.h"
+#include "spi_transport.h"
+
+#if defined(MCP23S17_HOST)
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+/// \brief Asynchronous transport completing frames from a worker thread
+/// \detail `submit` only queues the frame, and a dedicated worker thread
+/// exchanges the queued frames in order and invokes their completion
+/// handlers. The caller never waits on the bus. When the bus is shared
+/// (see `spi_bus`), it is held for each frame exchanged. The frames of the
+/// blocking methods (see `transfer`) are exchanged on the calling thread,
+/// behind every frame already queued.
+/// \note Completion handlers run on the worker thread
+/// \note Host platforms only
+class thread_transport : public spi_transport {
+  public:
+    // Constructor and destructor method(s)
+
+    /// \brief Object Constructor
+    /// \param [in] bus_ The bus shared with other devices and threads
+    explicit
+    thread_transport (
+        spi_bus * const bus_ = nullptr
+    );
+
+    /// \brief Object Destructor
+    /// \note Frames still queued are exchanged before the worker exits
+    ~thread_transport (
+        void
+    );
+
+    // Public method(s)
+
+    /// \brief Wait until every submitted frame has completed
+    void
+    flush (
+        void
+    );
+
+    bool
+    submit (
+        Frame & frame_
+    ) override;
+
+    /// \brief Exchange the queued frames, then the frame, before returning
+    /// \note The queued frames are still completed by the worker, in order
+    bool
+    transfer (
+        Frame & frame_
+    ) override;
+
+  private:
+    // Private definition(s)
+    struct Entry {
+        Frame * frame;
+        bool exchanged;  ///< Exchanged ahead of the worker by `transfer`
+    };
+
+    // Private instance variable(s)
+    spi_bus * const _bus;
+    std::mutex _mutex;
+    std::condition_variable _queued;
+    std::condition_variable _drained;
+    std::condition_variable _exchanged;
+    std::deque<Entry> _queue;
+    bool _busy;
+    bool _exchanging;
+    bool _stop;
+    std::thread _worker;
+
+    // Private method(s)
+    void
+    run (
+        void
+    );
+};
+
+#endif // MCP23S17_HOST
+
+#endif
+
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
@@ -0,0 +1,297 @@
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
+
+#if defined(TESTING)
+#ifndef MOCK_MCP23S17
+#define MOCK_MCP23S17
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "MOCK_wiring.h"
+
+/// \brief Register level simulation of MCP23S17 devices on the mock SPI bus
+/// \detail Each instance answers the transactions addressed to it, honoring
+/// IOCON.HAEN, IOCON.BANK and IOCON.SEQOP. Pin levels are supplied with
+/// `setInputs`, or derived from the outputs with `setWiring` (e.g. a key
+/// matrix), and any change is evaluated by the interrupt-on-change logic.
+/// \note Instances must be created after `MOCK::initMockState()`
+class MOCK_mcp23s17 {
+  public:
+	enum Register : uint8_t {
+		IODIRA = 0, IODIRB, IPOLA, IPOLB, GPINTENA, GPINTENB, DEFVALA, DEFVALB, INTCONA, INTCONB,
+		IOCONA, IOCONB, GPPUA, GPPUB, INTFA, INTFB, INTCAPA, INTCAPB, GPIOA_, GPIOB_, OLATA, OLATB,
+		REGISTER_COUNT,
+	};
+
+	static const uint8_t BANK = 0x80;
+	static const uint8_t SEQOP = 0x20;
+	static const uint8_t HAEN = 0x08;
+
+	std::vector< std::vector<uint8_t> > frames;
+
+	explicit
+	MOCK_mcp23s17 (
+		const uint8_t hw_addr_ = 0
+	) :
+		_hw_addr(hw_addr_),
+		_inputs(0x0000),
+		_wiring(nullptr),
+		_register{ 0xFF, 0xFF },
+		_selected(false),
+		_addressed(false),
+		_read(false),
+		_position(0),
+		_address(0)
+	{
+		devices().push_back(this);
+		SPI._transfer = [](uint8_t byte_){
+			uint8_t miso(0x00);
+			for ( MOCK_mcp23s17 * device : devices() ) { miso |= device->transfer(byte_); }
+			return miso;
+		};
+		MOCK::setDigitalWriteHook([](uint8_t pin_, uint8_t value_){
+			if ( SS != pin_ ) { return; }
+			for ( MOCK_mcp23s17 * device : devices() ) { device->select(LOW == value_); }
+		});
+	}
+
+	~MOCK_mcp23s17 () {
+		devices().erase(std::remove(devices().begin(), devices().end(), this), devices().end());
+	}
+
+	uint8_t
+	getRegister (
+		const Register register_
+	) const {
+		return _register[register_];
+	}
+
+	/// \brief The levels driven by output pins (input pins read as LOW)
+	uint16_t
+	getOutputs (
+		void
+	) const {
+		return (latch() & ~direction());
+	}
+
+	/// \brief The levels present on the pins
+	uint16_t
+	getPins (
+		void
+	) const {
+		const uint16_t inputs(_wiring ? _wiring(getOutputs(), _inputs) : _inputs);
+		return ((inputs & direction()) | getOutputs());
+	}
+
+	/// \brief Apply levels to the input pins, and evaluate interrupts
+	void
+	setInputs (
+		const uint16_t inputs_
+	) {
+		const uint16_t previous(getPins());
+		_inputs = inputs_;
+		evaluate(previous);
+	}
+
+	/// \brief Derive the input levels from the outputs and the applied inputs
+	void
+	setWiring (
+		std::function<uint16_t(uint16_t, uint16_t)> wiring_
+	) {
+		const uint16_t previous(getPins());
+		_wiring = wiring_;
+		evaluate(previous);
+	}
+
+	/// \brief Evaluate the interrupt-on-change logic against previous pin levels
+	void
+	evaluate (
+		const uint16_t previous_
+	) {
+		const uint16_t enabled(pair(GPINTENA));
+		const uint16_t compare(pair(INTCONA));
+		const uint16_t defaults(pair(DEFVALA));
+		uint16_t flags(pair(INTFA));
+
+		const uint16_t current(getPins());
+		const uint16_t triggered(enabled & direction() & ((compare & (current ^ defaults)) | (~compare & (current ^ previous_))));
+
+		for ( unsigned int port = 0 ; port < 2 ; ++port ) {
+			const uint8_t port_triggered(triggered >> (8 * port));
+			if ( !port_triggered ) { continue; }
+			// The capture register only latches the first interrupt until it is cleared
+			if ( !_register[INTFA + port] ) { _register[INTCAPA + port] = (current >> (8 * port)); }
+			flags |= (static_cast<uint16_t>(port_triggered) << (8 * port));
+		}
+		_register[INTFA] = flags;
+		_register[INTFB] = (flags >> 8);
+	}
+
+	bool
+	isInterruptAsserted (
+		void
+	) const {
+		return (_register[INTFA] || _register[INTFB]);
+	}
+
+	uint8_t
+	transfer (
+		const uint8_t byte_
+	) {
+		uint8_t miso(0x00);
+
+		if ( !_selected ) { return 0x00; }
+		if ( _position == 0 ) {
+			const bool hardware_addressing(_register[IOCONA] & HAEN);
+			_addressed = ((byte_ & 0xF0) == 0x40) && (!hardware_addressing || (((byte_ >> 1) & 0x07) == _hw_addr));
+			_read = (byte_ & 0x01);
+			if ( _addressed ) { frames.push_back(std::vector<uint8_t>()); }
+		} else if ( _position == 1 ) {
+			_address = byte_;
+		} else if ( _addressed ) {
+			const int index(registerIndex(_address));
+			if ( index >= 0 ) {
+				if ( _read ) {
+					miso = readRegister(index);
+				} else {
+					writeRegister(index, byte_);
+				}
+			}
+			advance();
+		}
+		if ( _addressed ) { frames.back().push_back(byte_); }
+		++_position;
+
+		return (_addressed ? miso : 0x00);
+	}
+
+  private:
+	const uint8_t _hw_addr;
+	uint16_t _inputs;
+	std::function<uint16_t(uint16_t, uint16_t)> _wiring;
+	uint8_t _register[REGISTER_COUNT];
+	bool _selected;
+	bool _addressed;
+	bool _read;
+	size_t _position;
+	uint8_t _address;
+
+	static
+	std::vector<MOCK_mcp23s17 *> &
+	devices (
+		void
+	) {
+		static std::vector<MOCK_mcp23s17 *> registry;
+		return registry;
+	}
+
+	uint16_t
+	direction (
+		void
+	) const {
+		return pair(IODIRA);
+	}
+
+	uint16_t
+	latch (
+		void
+	) const {
+		return pair(OLATA);
+	}
+
+	uint16_t
+	pair (
+		const Register register_a_
+	) const {
+		return (_register[register_a_] | (_register[register_a_ + 1] << 8));
+	}
+
+	int
+	registerIndex (
+		const uint8_t address_
+	) const {
+		if ( _register[IOCONA] & BANK ) {
+			const uint8_t index(address_ & 0x0F);
+			if ( index > 0x0A || address_ > 0x1A ) { return -1; }
+			return ((index * 2) + (address_ >> 4));
+		}
+		return (( address_ < REGISTER_COUNT ) ? address_ : -1);
+	}
+
+	void
+	advance (
+		void
+	) {
+		if ( _register[IOCONA] & SEQOP ) {
+			// Byte mode: toggle between the A/B pair (BANK = 0), or hold the address (BANK = 1)
+			if ( !(_register[IOCONA] & BANK) ) { _address ^= 0x01; }
+		} else if ( _register[IOCONA] & BANK ) {
+			_address = (( (_address & 0x0F) < 0x0A ) ? (_address + 1) : (_address & 0x10));
+		} else {
+			_address = (( _address < (REGISTER_COUNT - 1) ) ? (_address + 1) : 0);
+		}
+	}
+
+	uint8_t
+	readRegister (
+		const int index_
+	) {
+		switch ( index_ ) {
+		  case GPIOA_:
+		  case GPIOB_:
+			_register[INTFA + (index_ - GPIOA_)] = 0x00;
+			return (getPins() >> (8 * (index_ - GPIOA_)));
+		  case INTCAPA:
+		  case INTCAPB:
+			_register[INTFA + (index_ - INTCAPA)] = 0x00;
+			return _register[index_];
+		  default:
+			return _register[index_];
+		}
+	}
+
+	void
+	select (
+		const bool selected_
+	) {
+		_selected = selected_;
+		_position = 0;
+		_addressed = false;
+	}
+
+	void
+	writeRegister (
+		const int index_,
+		const uint8_t value_
+	) {
+		const uint16_t previous(getPins());
+
+		switch ( index_ ) {
+		  case IOCONA:
+		  case IOCONB:
+			_register[IOCONA] = value_;
+			_register[IOCONB] = value_;
+			break;
+		  case GPIOA_:
+		  case GPIOB_:
+			_register[OLATA + (index_ - GPIOA_)] = value_;
+			break;
+		  case INTFA:
+		  case INTFB:
+		  case INTCAPA:
+		  case INTCAPB:
+			break;
+		  default:
+			_register[index_] = value_;
+			break;
+		}
+		evaluate(previous);
+	}
+};
+
+#endif
+#endif
+
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
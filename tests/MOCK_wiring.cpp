@@ -58,11 +58,13 @@ MOCK_spi::transfer (
 }
 
 namespace {
-	const size_t MAX_CALL_COUNT = 4;
+	const size_t MAX_CALL_COUNT = 8;
 
 	static uint8_t _call_count(0);
 	static uint8_t _pin_latch_value[ARDUINO_PINS] = { 0 };
 	static MOCK::PinTransition _pin_transition[ARDUINO_PINS][MAX_CALL_COUNT] = { static_cast<MOCK::PinTransition>(0) };
+	static std::function<unsigned long(void)> _micros = [](){ return 0UL; };
+	static std::function<void(uint8_t, uint8_t)> _digital_write_hook = [](uint8_t, uint8_t){};
 }
 
 void
@@ -84,6 +86,8 @@ MOCK::initMockState (
 	MOCK_spi::_setClockDivider = [](uint8_t){};
 	MOCK_spi::_setDataMode = [](uint8_t){};
 	MOCK_spi::_transfer = [](uint8_t) -> uint8_t { return 0; };
+	_micros = [](){ return 0UL; };
+	_digital_write_hook = [](uint8_t, uint8_t){};
 }
 
 uint8_t
@@ -108,6 +112,20 @@ MOCK::resetPinTransitions (
 	for ( unsigned int i = 0 ; i < ARDUINO_PINS ; ++i ) for ( unsigned int j = 0 ; j < MAX_CALL_COUNT ; ++j ) { _pin_transition[i][j] = PinTransition::NO_TRANSITION; }
 }
 
+void
+MOCK::setDigitalWriteHook (
+	std::function<void(uint8_t, uint8_t)> hook_
+) {
+	_digital_write_hook = hook_;
+}
+
+void
+MOCK::setMicros (
+	std::function<unsigned long(void)> micros_
+) {
+	_micros = micros_;
+}
+
 namespace MOCK {
 
 void
@@ -115,6 +133,10 @@ setPinLatchValue (
 	const uint8_t pin_,
 	const uint8_t latch_value_
 ) {
+	if ( _call_count >= MAX_CALL_COUNT ) {
+		_pin_latch_value[pin_] = latch_value_;
+		return;
+	}
 	if ( _pin_latch_value[pin_] != latch_value_ ) {
 		_pin_transition[pin_][_call_count] = static_cast<PinTransition>(latch_value_);
 		_pin_latch_value[pin_] = latch_value_;
@@ -132,6 +154,21 @@ digitalWrite (
 	const uint8_t latch_value_
 ) {
 	MOCK::setPinLatchValue(pin_, latch_value_);
+	_digital_write_hook(pin_, latch_value_);
+}
+
+void
+delayMicroseconds (
+	const unsigned int
+) {
+	return;
+}
+
+unsigned long
+micros (
+	void
+) {
+	return _micros();
 }
 
 /* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
@@ -100,6 +100,16 @@ digitalWrite (
 	const uint8_t latch_value_
 );
 
+void
+delayMicroseconds (
+	const unsigned int us_
+);
+
+unsigned long
+micros (
+	void
+);
+
 namespace MOCK {
 
 enum class PinTransition : uint8_t {
@@ -128,6 +138,16 @@ resetPinTransitions (
 	void
 );
 
+void
+setDigitalWriteHook (
+	std::function<void(uint8_t, uint8_t)> hook_
+);
+
+void
+setMicros (
+	std::function<unsigned long(void)> micros_
+);
+
 } // namespace MOCK
 
 #endif
@@ -0,0 +1,120 @@
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
+
+/// \brief Runs `expander_daemon` standalone, against simulated devices
+/// \detail Usage: expander_daemon_simulator [socket path] [device count]
+///
+/// Serves `device count` (1-8, default 1) simulated expanders, at hardware
+/// addresses 0 and up, on the socket (default "/tmp/mcp23s17.sock"), until
+/// SIGINT or SIGTERM. Each simulated device loops its ports back to one
+/// another (the outputs of port A drive the inputs of port B, and vice
+/// versa), so clients can exercise reads, writes and subscriptions
+/// without hardware.
+/// \note Build with `make expander_daemon_simulator UNDER_TEST=expander_daemon DEPENDENCIES="mcp23s17 spi_bus"`
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+
+#include "../expander_daemon.h"
+#include "MOCK_mcp23s17.h"
+#include "MOCK_wiring.h"
+
+#if defined(MCP23S17_HOST) && defined(__linux__)
+
+namespace {
+
+const char * const DEFAULT_SOCKET_PATH = "/tmp/mcp23s17.sock";
+const int SAMPLE_PERIOD_MS = 10;
+
+expander_daemon * daemon_instance = nullptr;
+
+/// \brief Stop the daemon (`expander_daemon::stop` is async-signal-safe)
+void
+onSignal (
+    int
+) {
+    if ( daemon_instance ) { daemon_instance->stop(); }
+}
+
+/// \brief Port A outputs drive port B inputs, and port B outputs drive port A inputs
+uint16_t
+loopback (
+    const uint16_t outputs_,
+    const uint16_t
+) {
+    return static_cast<uint16_t>((outputs_ << 8) | (outputs_ >> 8));
+}
+
+} // namespace
+
+int
+main (
+    int argc_,
+    char ** argv_
+) {
+    const char * const path(( argc_ > 1 ) ? argv_[1] : DEFAULT_SOCKET_PATH);
+    const long count(( argc_ > 2 ) ? std::strtol(argv_[2], nullptr, 10) : 1);
+    MOCK_mcp23s17 * chips[expander_daemon::DEVICE_COUNT] = { nullptr };
+    mcp23s17 * devices[expander_daemon::DEVICE_COUNT] = { nullptr };
+    struct sigaction action;
+    int status(EXIT_SUCCESS);
+
+    if ( count < 1 || count > static_cast<long>(expander_daemon::DEVICE_COUNT) ) {
+        std::fprintf(stderr, "usage: %s [socket path] [device count (1-%u)]\n", argv_[0], static_cast<unsigned int>(expander_daemon::DEVICE_COUNT));
+        return EXIT_FAILURE;
+    }
+
+    // The simulators must exist before the devices, which configure them as they are constructed
+    MOCK::initMockState();
+    for ( long i = 0 ; i < count ; ++i ) {
+        chips[i] = new MOCK_mcp23s17(static_cast<uint8_t>(i));
+        chips[i]->setWiring(loopback);
+        devices[i] = new mcp23s17(static_cast<mcp23s17::HardwareAddress>(i));
+    }
+
+    {
+        expander_daemon daemon(devices, static_cast<size_t>(count));
+
+        if ( !daemon.listen(path) ) {
+            std::fprintf(stderr, "%s: cannot listen on %s\n", argv_[0], path);
+            status = EXIT_FAILURE;
+        } else {
+            daemon_instance = &daemon;
+            action = {};
+            action.sa_handler = onSignal;
+            ::sigemptyset(&action.sa_mask);
+            ::sigaction(SIGINT, &action, nullptr);
+            ::sigaction(SIGTERM, &action, nullptr);
+
+            std::printf("%s: serving %ld simulated device(s) on %s\n", argv_[0], count, path);
+            std::fflush(stdout);
+            daemon.run(SAMPLE_PERIOD_MS);
+
+            // The handlers are restored before the daemon goes out of scope
+            action.sa_handler = SIG_DFL;
+            ::sigaction(SIGINT, &action, nullptr);
+            ::sigaction(SIGTERM, &action, nullptr);
+            daemon_instance = nullptr;
+        }
+    }
+
+    for ( long i = 0 ; i < count ; ++i ) {
+        delete devices[i];
+        delete chips[i];
+    }
+
+    return status;
+}
+
+#else
+
+int
+main (
+    void
+) {
+    return EXIT_FAILURE;
+}
+
+#endif // MCP23S17_HOST && __linux__
+
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
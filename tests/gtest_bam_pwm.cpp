@@ -0,0 +1,142 @@
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+#include <vector>
+
+#include "../bam_pwm.h"
+#include "MOCK_wiring.h"
+
+class TC_bam_pwm : public bam_pwm {
+  public:
+    TC_bam_pwm (
+        mcp23s17 & gpio_x_,
+        const uint16_t pin_mask_,
+        const uint8_t bit_depth_ = MAX_BIT_DEPTH
+    ): bam_pwm(gpio_x_, pin_mask_, bit_depth_)
+    {}
+
+    // Access protected test members
+    using bam_pwm::getBitPlanes;
+};
+
+namespace {
+
+class MockSPIStream : public ::testing::Test {
+  protected:
+    std::vector<uint8_t> _spi_transaction;
+    mcp23s17 * _gpio_x;
+
+    MockSPIStream (
+        void
+    ) :
+        _gpio_x(nullptr)
+    {}
+
+    void SetUp (void) {
+        MOCK::initMockState();
+        SPI._transfer = [&](uint8_t byte_){
+            _spi_transaction.push_back(byte_);
+            return static_cast<uint8_t>(0x00);
+        };
+        _gpio_x = new mcp23s17(mcp23s17::HardwareAddress::HW_ADDR_6);
+    }
+    void TearDown (void) {
+        delete _gpio_x;
+    }
+
+    void ResetSpi (void) {
+        _spi_transaction.clear();
+        MOCK::resetPinTransitions();
+    }
+};
+
+TEST_F(MockSPIStream, analogWrite$WHENCalledTHENTheDutyCycleIsDecomposedIntoTheStagedBitPlanes) {
+    TC_bam_pwm pwm(*_gpio_x, 0xFFFF, 4);
+
+    pwm.analogWrite(9, 0x05);
+    EXPECT_EQ(0x0200, pwm.getBitPlanes(true)[0]);
+    EXPECT_EQ(0x0000, pwm.getBitPlanes(true)[1]);
+    EXPECT_EQ(0x0200, pwm.getBitPlanes(true)[2]);
+    EXPECT_EQ(0x0000, pwm.getBitPlanes(true)[3]);
+    EXPECT_EQ(0x0000, pwm.getBitPlanes(false)[0]);
+}
+
+TEST_F(MockSPIStream, analogWrite$WHENCalledOnAPinOutsideTheMaskTHENNothingIsStaged) {
+    TC_bam_pwm pwm(*_gpio_x, 0x00FF, 4);
+
+    pwm.analogWrite(9, 0x0F);
+    for ( int bit = 0 ; bit < 4 ; ++bit ) {
+        EXPECT_EQ(0x0000, pwm.getBitPlanes(true)[bit]) << "Error at bit <" << bit << ">!";
+    }
+}
+
+TEST_F(MockSPIStream, analogWrite$WHENCalledOnAnInvalidPinTHENNothingIsStaged) {
+    TC_bam_pwm pwm(*_gpio_x, 0xFFFF, 4);
+
+    pwm.analogWrite(mcp23s17::PIN_COUNT, 0x0F);
+    pwm.analogWrite(255, 0x0F);
+    for ( int bit = 0 ; bit < 4 ; ++bit ) {
+        EXPECT_EQ(0x0000, pwm.getBitPlanes(true)[bit]) << "Error at bit <" << bit << ">!";
+    }
+}
+
+TEST_F(MockSPIStream, update$WHENCalledTHENTheWeightOfEachPlaneIsReturnedInTurn) {
+    TC_bam_pwm pwm(*_gpio_x, 0xFFFF, 3);
+
+    EXPECT_EQ(7u, pwm.getFrameLength());
+    EXPECT_EQ(1u, pwm.update());
+    EXPECT_EQ(2u, pwm.update());
+    EXPECT_EQ(4u, pwm.update());
+    EXPECT_EQ(1u, pwm.update());
+}
+
+TEST_F(MockSPIStream, update$WHENAPlaneSpansBothPortsTHENItIsLatchedInOneFourByteTransaction) {
+    TC_bam_pwm pwm(*_gpio_x, 0xFFFF, 2);
+    pwm.begin();
+    pwm.analogWrite(0, 0x01);
+    pwm.analogWrite(15, 0x03);
+    pwm.commit();
+
+    ResetSpi();
+    pwm.update();
+    ASSERT_EQ(4u, _spi_transaction.size());
+    EXPECT_EQ(static_cast<uint8_t>(mcp23s17::ControlRegister::GPIOA_), _spi_transaction[1]);
+    EXPECT_EQ(0x01, _spi_transaction[2]);
+    EXPECT_EQ(0x80, _spi_transaction[3]);
+}
+
+TEST_F(MockSPIStream, update$WHENConsecutivePlanesAreIdenticalTHENNoSPITransactionOccurs) {
+    TC_bam_pwm pwm(*_gpio_x, 0xFFFF, 2);
+    pwm.begin();
+    pwm.analogWrite(3, 0x03);
+    pwm.commit();
+    pwm.update();
+
+    ResetSpi();
+    pwm.update();
+    EXPECT_EQ(0u, _spi_transaction.size());
+}
+
+TEST_F(MockSPIStream, commit$WHENCalledMidFrameTHENTheStagedPlanesArePresentedAtTheNextFrameBoundary) {
+    TC_bam_pwm pwm(*_gpio_x, 0xFFFF, 2);
+    pwm.begin();
+    pwm.update();
+
+    pwm.analogWrite(3, 0x03);
+    pwm.commit();
+    ResetSpi();
+    pwm.update();
+    EXPECT_TRUE(pwm.isCommitPending());
+    EXPECT_EQ(0u, _spi_transaction.size());
+
+    pwm.update();
+    EXPECT_FALSE(pwm.isCommitPending());
+    EXPECT_EQ(0x0008, _gpio_x->getLatchValues());
+    EXPECT_EQ(0x0008, pwm.getBitPlanes(true)[0]);
+}
+
+} // namespace
+
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
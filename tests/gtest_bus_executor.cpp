@@ -0,0 +1,232 @@
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+#include "../bus_executor.h"
+#include "MOCK_wiring.h"
+
+#if defined(MCP23S17_HOST)
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+  #include <sched.h>
+#endif
+
+namespace {
+
+/// \brief A simulated bus, taking a fixed time to exchange each frame
+class MOCK_timed_transport : public spi_transport {
+  public:
+    std::vector< std::vector<uint8_t> > frames;
+    std::vector<std::thread::id> threads;
+    std::vector<int> cpus;
+    bool accept = true;
+    unsigned int frame_us = 0;
+
+    bool
+    submit (
+        Frame & frame_
+    ) override {
+        if ( !accept ) { return false; }
+        std::this_thread::sleep_for(std::chrono::microseconds(frame_us));
+        frames.push_back(std::vector<uint8_t>(frame_.data, (frame_.data + frame_.length)));
+        threads.push_back(std::this_thread::get_id());
+#if defined(__linux__)
+        cpus.push_back(::sched_getcpu());
+#endif
+        complete(frame_);
+        return true;
+    }
+};
+
+/// \brief The hardware address a frame was sent to
+uint8_t
+frameAddress (
+    const std::vector<uint8_t> & frame_
+) {
+    return ((frame_[0] >> 1) & 0x07);
+}
+
+/// \brief Three buses, with two devices each
+class BusExecutor : public ::testing::Test {
+  protected:
+    MOCK_timed_transport _transport[3];
+    mcp23s17_async * _gpio_x[3][2];
+    mcp23s17_async * const * _devices[3];
+    bus_executor::Bus _buses[3];
+
+    void SetUp (void) {
+        MOCK::initMockState();
+        for ( size_t bus = 0 ; bus < 3 ; ++bus ) {
+            _gpio_x[bus][0] = new mcp23s17_async(mcp23s17::HardwareAddress::HW_ADDR_0, _transport[bus]);
+            _gpio_x[bus][1] = new mcp23s17_async(mcp23s17::HardwareAddress::HW_ADDR_1, _transport[bus]);
+            _gpio_x[bus][0]->pinModes(0xFFFF, mcp23s17::PinMode::OUTPUT);
+            _gpio_x[bus][1]->pinModes(0xFFFF, mcp23s17::PinMode::OUTPUT);
+            _buses[bus] = bus_executor::Bus{ &_transport[bus], _gpio_x[bus], 2, -1 };
+        }
+    }
+    void TearDown (void) {
+        for ( size_t bus = 0 ; bus < 3 ; ++bus ) {
+            delete _gpio_x[bus][0];
+            delete _gpio_x[bus][1];
+        }
+    }
+};
+
+TEST_F(BusExecutor, execute$WHENABatchSpansBusesTHENEachBusReceivesOnlyItsOwnWrites) {
+    bus_executor executor(_buses, 3);
+    const bus_executor::Write writes[] = {
+        { 0, 1, 0x1111, 0xFFFF },
+        { 2, 0, 0x2222, 0xFFFF },
+        { 2, 1, 0x3333, 0xFFFF },
+    };
+
+    executor.execute(writes, 3);
+
+    ASSERT_EQ(1u, _transport[0].frames.size());
+    EXPECT_EQ(1, frameAddress(_transport[0].frames[0]));
+    EXPECT_EQ(0u, _transport[1].frames.size());
+    ASSERT_EQ(2u, _transport[2].frames.size());
+    EXPECT_EQ(0, frameAddress(_transport[2].frames[0]));
+    EXPECT_EQ(1, frameAddress(_transport[2].frames[1]));
+    EXPECT_EQ(0x1111, _gpio_x[0][1]->getLatchValues());
+    EXPECT_EQ(0x2222, _gpio_x[2][0]->getLatchValues());
+    EXPECT_EQ(0x3333, _gpio_x[2][1]->getLatchValues());
+}
+
+TEST_F(BusExecutor, execute$WHENADeviceIsWrittenRepeatedlyTHENTheWritesAreMergedIntoOneFrame) {
+    bus_executor executor(_buses, 3);
+    const bus_executor::Write writes[] = {
+        { 1, 0, 0x00FF, 0x00FF },
+        { 1, 0, 0x0000, 0x000F },
+        { 1, 0, 0xFF00, 0x0300 },
+    };
+
+    executor.execute(writes, 3);
+
+    EXPECT_EQ(1u, _transport[1].frames.size());
+    EXPECT_EQ(0x03F0, _gpio_x[1][0]->getLatchValues());
+}
+
+TEST_F(BusExecutor, execute$WHENWritesAreAddressedToUnknownBusesOrDevicesTHENTheyAreIgnored) {
+    bus_executor executor(_buses, 3);
+    const bus_executor::Write writes[] = {
+        { 3, 0, 0xFFFF, 0xFFFF },
+        { 0, 2, 0xFFFF, 0xFFFF },
+    };
+
+    EXPECT_EQ(0u, executor.execute(writes, 2));
+    EXPECT_EQ(0u, _transport[0].frames.size());
+    EXPECT_EQ(0u, executor.getTiming(0).batches);
+}
+
+TEST_F(BusExecutor, execute$WHENBusesAreBusyTHENEachRunsOnItsOwnWorkerConcurrently) {
+    bus_executor executor(_buses, 3);
+    const bus_executor::Write writes[] = {
+        { 0, 0, 0x0001, 0xFFFF }, { 0, 1, 0x0002, 0xFFFF },
+        { 1, 0, 0x0003, 0xFFFF }, { 1, 1, 0x0004, 0xFFFF },
+        { 2, 0, 0x0005, 0xFFFF }, { 2, 1, 0x0006, 0xFFFF },
+    };
+    uint64_t sum_ns(0);
+    uint64_t max_ns(0);
+
+    for ( MOCK_timed_transport & transport : _transport ) { transport.frame_us = 20000; }
+    const uint64_t duration_ns(executor.execute(writes, 6));
+
+    for ( size_t bus = 0 ; bus < 3 ; ++bus ) {
+        const bus_executor::Timing timing(executor.getTiming(bus));
+        EXPECT_EQ(1u, timing.batches);
+        EXPECT_GE(timing.last_ns, 40000000u);
+        sum_ns += timing.last_ns;
+        if ( timing.last_ns > max_ns ) { max_ns = timing.last_ns; }
+
+        ASSERT_EQ(2u, _transport[bus].threads.size());
+        EXPECT_NE(std::this_thread::get_id(), _transport[bus].threads[0]);
+        EXPECT_EQ(_transport[bus].threads[0], _transport[bus].threads[1]);
+    }
+    EXPECT_NE(_transport[0].threads[0], _transport[1].threads[0]);
+    EXPECT_NE(_transport[1].threads[0], _transport[2].threads[0]);
+
+    // The batch follows the slowest bus, rather than the sum of the buses
+    EXPECT_GE(duration_ns, max_ns);
+    EXPECT_LT(duration_ns, ((sum_ns * 2) / 3));
+}
+
+TEST_F(BusExecutor, writeImage$WHENAnImageIsGivenTHENItIsMappedOntoTheDevicesInSystemOrder) {
+    bus_executor executor(_buses, 3);
+    const uint16_t image[] = { 0x0100, 0x0101, 0x0200, 0x0201, 0x0300, 0x0301 };
+    const uint16_t masks[] = { 0xFFFF, 0xFFFF, 0x0000, 0x0000, 0xFFFF, 0x00FF };
+
+    executor.writeImage(image, masks);
+
+    EXPECT_EQ(0x0100, _gpio_x[0][0]->getLatchValues());
+    EXPECT_EQ(0x0101, _gpio_x[0][1]->getLatchValues());
+    EXPECT_EQ(0x0000, _gpio_x[1][0]->getLatchValues());
+    EXPECT_EQ(0x0300, _gpio_x[2][0]->getLatchValues());
+    EXPECT_EQ(0x0001, _gpio_x[2][1]->getLatchValues());
+    EXPECT_EQ(1u, executor.getTiming(0).batches);
+    EXPECT_EQ(0u, executor.getTiming(1).batches);
+    EXPECT_EQ(1u, executor.getTiming(2).batches);
+}
+
+TEST_F(BusExecutor, writeImage$WHENTheTransportRefusesAFrameTHENTheRefusalIsCountedAndTheBatchCompletes) {
+    bus_executor executor(_buses, 3);
+    const uint16_t image[] = { 0x0001, 0x0002, 0x0003, 0x0004, 0x0005, 0x0006 };
+
+    _transport[1].accept = false;
+    executor.writeImage(image);
+
+    EXPECT_EQ(0u, executor.getTiming(0).refused);
+    EXPECT_EQ(2u, executor.getTiming(1).refused);
+    EXPECT_EQ(1u, executor.getTiming(1).batches);
+    EXPECT_EQ(2u, _transport[2].frames.size());
+}
+
+TEST_F(BusExecutor, getTiming$WHENBatchesCompleteTHENTheTimingAccumulates) {
+    bus_executor executor(_buses, 1);
+    const uint16_t first[] = { 0x0001, 0x0002 };
+    const uint16_t second[] = { 0x0003, 0x0004 };
+
+    _transport[0].frame_us = 1000;
+    executor.writeImage(first);
+    executor.writeImage(second);
+    const bus_executor::Timing timing(executor.getTiming(0));
+
+    EXPECT_EQ(2u, timing.batches);
+    EXPECT_GE(timing.max_ns, timing.last_ns);
+    EXPECT_GE(timing.total_ns, (timing.max_ns + 2000000u));
+    EXPECT_EQ(0u, executor.getTiming(1).batches);
+    EXPECT_EQ(1u, executor.getBusCount());
+}
+
+#if defined(__linux__)
+TEST_F(BusExecutor, bus_executor$WHENACpuIsGivenTHENTheWorkerRunsOnThatCpu) {
+    cpu_set_t allowed;
+    int cpu(-1);
+
+    ASSERT_EQ(0, ::sched_getaffinity(0, sizeof(allowed), &allowed));
+    for ( int i = CPU_SETSIZE - 1 ; i >= 0 ; --i ) {
+        if ( CPU_ISSET(i, &allowed) ) { cpu = i; }
+    }
+    ASSERT_GE(cpu, 0);
+    _buses[0].cpu = cpu;
+    bus_executor executor(_buses, 1);
+    const uint16_t image[] = { 0x0001, 0x0002 };
+
+    executor.writeImage(image);
+
+    ASSERT_EQ(2u, _transport[0].cpus.size());
+    EXPECT_EQ(cpu, _transport[0].cpus[0]);
+    EXPECT_EQ(cpu, _transport[0].cpus[1]);
+}
+#endif
+
+} // namespace
+
+#endif // MCP23S17_HOST
+
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
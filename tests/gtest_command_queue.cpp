@@ -0,0 +1,179 @@
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "../command_queue.h"
+#include "../spi_bus.h"
+#include "MOCK_mcp23s17.h"
+#include "MOCK_wiring.h"
+
+namespace {
+
+class MockQueue : public ::testing::Test {
+  protected:
+    MOCK_mcp23s17 * _chip_a;
+    MOCK_mcp23s17 * _chip_b;
+
+    MockQueue (
+        void
+    ) :
+        _chip_a(nullptr),
+        _chip_b(nullptr)
+    {}
+
+    void SetUp (void) {
+        MOCK::initMockState();
+        _chip_a = new MOCK_mcp23s17(1);
+        _chip_b = new MOCK_mcp23s17(2);
+    }
+    void TearDown (void) {
+        delete _chip_b;
+        delete _chip_a;
+    }
+};
+
+TEST_F(MockQueue, drain$WHENManyWritesToOnePortArePendingTHENASingleFrameCarriesTheFinalValue) {
+    command_queue queue;
+    mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_1);
+    gpio_x.pinModes(0xFFFF, mcp23s17::PinMode::OUTPUT);
+
+    for ( unsigned int i = 0 ; i < 50 ; ++i ) {
+        EXPECT_TRUE(queue.digitalWrite(gpio_x, (i % 8), (( i % 3 ) ? mcp23s17::PinLatchValue::HIGH : mcp23s17::PinLatchValue::LOW)));
+    }
+    _chip_a->frames.clear();
+    EXPECT_EQ(50u, queue.drain());
+
+    ASSERT_EQ(1u, _chip_a->frames.size());
+    ASSERT_EQ(3u, _chip_a->frames[0].size());
+    EXPECT_EQ(static_cast<uint8_t>(MOCK_mcp23s17::GPIOA_), _chip_a->frames[0][1]);
+    // Pin p was last written by write 48 + p (p < 2), or 40 + p (p >= 2), which is LOW when divisible by 3
+    EXPECT_EQ(0xDA, _chip_a->frames[0][2]);
+    EXPECT_EQ(0x00DA, _chip_a->getOutputs());
+}
+
+TEST_F(MockQueue, drain$WHENWritesSpanBothPortsTHENTheyAreSentInOneFrame) {
+    command_queue queue;
+    mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_1);
+    gpio_x.pinModes(0xFFFF, mcp23s17::PinMode::OUTPUT);
+
+    queue.digitalWrite(gpio_x, 3, mcp23s17::PinLatchValue::HIGH);
+    queue.digitalWrite(gpio_x, 11, mcp23s17::PinLatchValue::HIGH);
+    _chip_a->frames.clear();
+    queue.drain();
+
+    ASSERT_EQ(1u, _chip_a->frames.size());
+    EXPECT_EQ(4u, _chip_a->frames[0].size());
+    EXPECT_EQ(0x0808, _chip_a->getOutputs());
+}
+
+TEST_F(MockQueue, drain$WHENWritesOverlapTHENLaterWritesTakePrecedencePinByPin) {
+    command_queue queue;
+    mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_1);
+    gpio_x.pinModes(0xFFFF, mcp23s17::PinMode::OUTPUT);
+    gpio_x.digitalWritePorts(0xFFFF);
+
+    queue.digitalWritePorts(gpio_x, 0x0000, 0x00FF);
+    queue.digitalWritePorts(gpio_x, 0x0030, 0x00F0);
+    queue.drain();
+
+    EXPECT_EQ(0xFF30, _chip_a->getOutputs());
+}
+
+TEST_F(MockQueue, drain$WHENSeveralDevicesHavePendingWritesTHENEachReceivesOneFrame) {
+    command_queue queue;
+    mcp23s17 gpio_a(mcp23s17::HardwareAddress::HW_ADDR_1);
+    mcp23s17 gpio_b(mcp23s17::HardwareAddress::HW_ADDR_2);
+    gpio_a.pinModes(0xFFFF, mcp23s17::PinMode::OUTPUT);
+    gpio_b.pinModes(0xFFFF, mcp23s17::PinMode::OUTPUT);
+
+    for ( uint8_t pin = 0 ; pin < 4 ; ++pin ) {
+        queue.digitalWrite(gpio_a, pin, mcp23s17::PinLatchValue::HIGH);
+        queue.digitalWrite(gpio_b, (pin + 8), mcp23s17::PinLatchValue::HIGH);
+    }
+    _chip_a->frames.clear();
+    _chip_b->frames.clear();
+    queue.drain();
+
+    EXPECT_EQ(1u, _chip_a->frames.size());
+    EXPECT_EQ(1u, _chip_b->frames.size());
+    EXPECT_EQ(0x000F, _chip_a->getOutputs());
+    EXPECT_EQ(0x0F00, _chip_b->getOutputs());
+}
+
+TEST_F(MockQueue, digitalWrite$WHENTheQueueIsFullTHENTheWriteIsRefused) {
+    command_queue queue;
+    mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_1);
+    const size_t capacity(command_queue::CAPACITY);
+
+    for ( size_t i = 0 ; i < capacity ; ++i ) {
+        ASSERT_TRUE(queue.digitalWrite(gpio_x, 0, mcp23s17::PinLatchValue::HIGH));
+    }
+    EXPECT_FALSE(queue.digitalWrite(gpio_x, 0, mcp23s17::PinLatchValue::LOW));
+
+    EXPECT_EQ(capacity, queue.drain());
+    EXPECT_TRUE(queue.digitalWrite(gpio_x, 0, mcp23s17::PinLatchValue::LOW));
+}
+
+TEST_F(MockQueue, digitalWrite$WHENThePinIsInvalidTHENTheWriteIsRefused) {
+    command_queue queue;
+    mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_1);
+
+    EXPECT_FALSE(queue.digitalWrite(gpio_x, mcp23s17::PIN_COUNT, mcp23s17::PinLatchValue::HIGH));
+    EXPECT_EQ(0u, queue.drain());
+}
+
+TEST_F(MockQueue, drain$WHENProducersRaceTheConsumerTHENEveryPinSettlesOnItsLastWrite) {
+    command_queue queue;
+    mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_1);
+    gpio_x.pinModes(0xFFFF, mcp23s17::PinMode::OUTPUT);
+    std::vector<std::thread> producers;
+    size_t dequeued(0);
+
+    for ( uint8_t pin = 0 ; pin < 4 ; ++pin ) {
+        producers.push_back(std::thread([&queue, &gpio_x, pin](){
+            for ( unsigned int i = 0 ; i < 2000 ; ++i ) {
+                const mcp23s17::PinLatchValue value(( (i % 2) == (pin % 2) ) ? mcp23s17::PinLatchValue::HIGH : mcp23s17::PinLatchValue::LOW);
+                while ( !queue.digitalWrite(gpio_x, (pin * 4), value) ) { std::this_thread::yield(); }
+            }
+        }));
+    }
+    while ( dequeued < 8000 ) { dequeued += queue.drain(); }
+    for ( std::thread & producer : producers ) { producer.join(); }
+
+    // Each pin ends on write 1999, so the odd pins end HIGH
+    EXPECT_EQ(0x1010, _chip_a->getOutputs());
+    EXPECT_EQ(0x1010, gpio_x.getLatchValues());
+}
+
+TEST_F(MockQueue, bus_owner$WHENWritesAreQueuedTHENTheOwnerSendsThem) {
+    command_queue queue;
+    spi_bus bus;
+    mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_1, &bus);
+    gpio_x.pinModes(0xFFFF, mcp23s17::PinMode::OUTPUT);
+    uint16_t outputs(0x0000);
+
+    {
+        bus_owner owner(queue, 1000);
+        queue.digitalWritePorts(gpio_x, 0x1234);
+        for ( unsigned int i = 0 ; i < 1000 && 0x1234 != outputs ; ++i ) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            bus.acquire();
+            outputs = _chip_a->getOutputs();
+            bus.release();
+        }
+        EXPECT_EQ(0x1234, outputs);
+        queue.digitalWritePorts(gpio_x, 0x4321);
+    }
+
+    // The owner drains once more as it exits
+    EXPECT_EQ(0x4321, _chip_a->getOutputs());
+}
+
+} // namespace
+
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
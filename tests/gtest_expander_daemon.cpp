@@ -0,0 +1,395 @@
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+#include "../expander_daemon.h"
+#include "MOCK_mcp23s17.h"
+#include "MOCK_wiring.h"
+
+#if defined(MCP23S17_HOST) && defined(__linux__)
+
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+typedef expander_daemon::Opcode Opcode;
+typedef expander_daemon::Record Record;
+
+std::string
+socketPath (
+    void
+) {
+    return ("/tmp/mcp23s17_daemon_test_" + std::to_string(::getpid()) + ".sock");
+}
+
+int
+connectClient (
+    void
+) {
+    struct sockaddr_un address;
+    const int fd(::socket(AF_UNIX, (SOCK_SEQPACKET | SOCK_CLOEXEC), 0));
+
+    ::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    ::strncpy(address.sun_path, socketPath().c_str(), (sizeof(address.sun_path) - 1));
+    if ( ::connect(fd, reinterpret_cast<struct sockaddr *>(&address), sizeof(address)) < 0 ) {
+        ::close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+bool
+isReadable (
+    const int fd_,
+    const int timeout_ms_ = 0
+) {
+    struct pollfd descriptor{ fd_, POLLIN, 0 };
+    return (1 == ::poll(&descriptor, 1, timeout_ms_) && (descriptor.revents & POLLIN));
+}
+
+/// \brief Receive one message, and decode its records
+size_t
+receiveRecords (
+    const int fd_,
+    Record * const records_,
+    const size_t max_
+) {
+    uint8_t buffer[expander_daemon::MAX_BATCH * expander_daemon::RECORD_SIZE];
+    const ssize_t length(::recv(fd_, buffer, sizeof(buffer), MSG_DONTWAIT));
+    size_t count(0);
+
+    for ( ssize_t offset = 0 ; offset < length && count < max_ ; offset += expander_daemon::RECORD_SIZE ) {
+        records_[count++] = expander_daemon::decode(buffer + offset);
+    }
+
+    return count;
+}
+
+/// \brief Send the records as one message
+bool
+sendRecords (
+    const int fd_,
+    const Record * const records_,
+    const size_t count_
+) {
+    uint8_t buffer[expander_daemon::MAX_BATCH * expander_daemon::RECORD_SIZE];
+    const size_t length(count_ * expander_daemon::RECORD_SIZE);
+
+    for ( size_t i = 0 ; i < count_ ; ++i ) {
+        expander_daemon::encode(records_[i], (buffer + (i * expander_daemon::RECORD_SIZE)));
+    }
+
+    return (static_cast<ssize_t>(length) == ::send(fd_, buffer, length, MSG_NOSIGNAL));
+}
+
+class ExpanderDaemon : public ::testing::Test {
+  protected:
+    void SetUp (void) {
+        MOCK::initMockState();
+    }
+    void TearDown (void) {
+        ::unlink(socketPath().c_str());
+    }
+};
+
+TEST_F(ExpanderDaemon, encode$WHENARecordIsEncodedTHENTheFieldsAreLittleEndianAndDecodeRestoresThem) {
+    const Record record{ Opcode::WRITE, 3, 0x1234, 0xABCD };
+    uint8_t buffer[expander_daemon::RECORD_SIZE];
+
+    expander_daemon::encode(record, buffer);
+    const Record decoded(expander_daemon::decode(buffer));
+
+    EXPECT_EQ(0x02, buffer[0]);
+    EXPECT_EQ(0x03, buffer[1]);
+    EXPECT_EQ(0x34, buffer[2]);
+    EXPECT_EQ(0x12, buffer[3]);
+    EXPECT_EQ(0xCD, buffer[4]);
+    EXPECT_EQ(0xAB, buffer[5]);
+    EXPECT_TRUE(Opcode::WRITE == decoded.opcode);
+    EXPECT_EQ(3, decoded.device);
+    EXPECT_EQ(0x1234, decoded.values);
+    EXPECT_EQ(0xABCD, decoded.mask);
+}
+
+TEST_F(ExpanderDaemon, listen$WHENThePathIsTooLongTHENFalseIsReturned) {
+    mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_0);
+    mcp23s17 * const devices[] = { &gpio_x };
+    expander_daemon daemon(devices, 1);
+    const std::string path(200, 'x');
+
+    EXPECT_FALSE(daemon.listen(path.c_str()));
+}
+
+TEST_F(ExpanderDaemon, serviceOnce$WHENAClientSendsABatchOfReadsTHENOneMessageAnswersThemInOrder) {
+    MOCK_mcp23s17 chip_0(0);
+    MOCK_mcp23s17 chip_1(1);
+    mcp23s17 gpio_0(mcp23s17::HardwareAddress::HW_ADDR_0);
+    mcp23s17 gpio_1(mcp23s17::HardwareAddress::HW_ADDR_1);
+    mcp23s17 * const devices[] = { &gpio_0, &gpio_1 };
+    expander_daemon daemon(devices, 2);
+    Record responses[4];
+
+    chip_0.setInputs(0x00A5);
+    chip_1.setInputs(0x5A00);
+    ASSERT_TRUE(daemon.listen(socketPath().c_str()));
+    const int client(connectClient());
+    ASSERT_GE(client, 0);
+    daemon.serviceOnce(0);
+
+    const Record requests[] = {
+        { Opcode::READ, 0, 0x0000, 0x00FF },
+        { Opcode::READ, 1, 0x0000, 0xFF00 },
+    };
+    ASSERT_TRUE(sendRecords(client, requests, 2));
+    EXPECT_EQ(2u, daemon.serviceOnce(0));
+
+    ASSERT_EQ(2u, receiveRecords(client, responses, 4));
+    EXPECT_TRUE(Opcode::READ == responses[0].opcode);
+    EXPECT_EQ(0, responses[0].device);
+    EXPECT_EQ(0x00A5, responses[0].values);
+    EXPECT_EQ(1, responses[1].device);
+    EXPECT_EQ(0x5A00, responses[1].values);
+    EXPECT_EQ(0xFF00, responses[1].mask);
+
+    ::close(client);
+}
+
+TEST_F(ExpanderDaemon, serviceOnce$WHENClientsWriteTheSameDeviceTHENTheWritesAreMergedIntoOneFrame) {
+    MOCK_mcp23s17 chip(0);
+    mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_0);
+    mcp23s17 * const devices[] = { &gpio_x };
+    expander_daemon daemon(devices, 1);
+
+    gpio_x.pinModes(0xFFFF, mcp23s17::PinMode::OUTPUT);
+    ASSERT_TRUE(daemon.listen(socketPath().c_str()));
+    const int client_a(connectClient());
+    const int client_b(connectClient());
+    ASSERT_GE(client_a, 0);
+    ASSERT_GE(client_b, 0);
+    daemon.serviceOnce(0);
+
+    const Record write_a[] = {
+        { Opcode::WRITE, 0, 0x00FF, 0x000F },
+        { Opcode::WRITE, 0, 0x0000, 0x0003 },
+    };
+    const Record write_b[] = {
+        { Opcode::WRITE, 0, 0xFF00, 0x0F00 },
+    };
+    ASSERT_TRUE(sendRecords(client_a, write_a, 2));
+    ASSERT_TRUE(sendRecords(client_b, write_b, 1));
+    chip.frames.clear();
+    EXPECT_EQ(3u, daemon.serviceOnce(0));
+
+    EXPECT_EQ(1u, chip.frames.size());
+    EXPECT_EQ(0x0F0C, chip.getOutputs());
+    EXPECT_FALSE(isReadable(client_a));
+    EXPECT_FALSE(isReadable(client_b));
+
+    ::close(client_a);
+    ::close(client_b);
+}
+
+TEST_F(ExpanderDaemon, serviceOnce$WHENAReadFollowsAWriteInTheBatchTHENTheReadObservesTheWrite) {
+    MOCK_mcp23s17 chip(0);
+    mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_0);
+    mcp23s17 * const devices[] = { &gpio_x };
+    expander_daemon daemon(devices, 1);
+    Record responses[2];
+
+    ASSERT_TRUE(daemon.listen(socketPath().c_str()));
+    const int client(connectClient());
+    ASSERT_GE(client, 0);
+    daemon.serviceOnce(0);
+
+    const Record requests[] = {
+        { Opcode::PIN_MODES, 0, static_cast<uint16_t>(mcp23s17::PinMode::OUTPUT), 0x00F0 },
+        { Opcode::WRITE, 0, 0x0030, 0x00F0 },
+        { Opcode::READ, 0, 0x0000, 0x00F0 },
+    };
+    ASSERT_TRUE(sendRecords(client, requests, 3));
+    EXPECT_EQ(3u, daemon.serviceOnce(0));
+
+    EXPECT_EQ(0x0F, chip.getRegister(MOCK_mcp23s17::IODIRA));
+    ASSERT_EQ(1u, receiveRecords(client, responses, 2));
+    EXPECT_TRUE(Opcode::READ == responses[0].opcode);
+    EXPECT_EQ(0x0030, responses[0].values);
+
+    ::close(client);
+}
+
+TEST_F(ExpanderDaemon, serviceOnce$WHENSubscribedPinsChangeTHENEachSubscriberReceivesItsChanges) {
+    MOCK_mcp23s17 chip(0);
+    mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_0);
+    mcp23s17 * const devices[] = { &gpio_x };
+    expander_daemon daemon(devices, 1);
+    Record events[2];
+
+    ASSERT_TRUE(daemon.listen(socketPath().c_str()));
+    const int client_a(connectClient());
+    const int client_b(connectClient());
+    ASSERT_GE(client_a, 0);
+    ASSERT_GE(client_b, 0);
+    daemon.serviceOnce(0);
+
+    const Record subscribe_a{ Opcode::SUBSCRIBE, 0, 0x0000, 0x000F };
+    const Record subscribe_b{ Opcode::SUBSCRIBE, 0, 0x0000, 0x0300 };
+    ASSERT_TRUE(sendRecords(client_a, &subscribe_a, 1));
+    ASSERT_TRUE(sendRecords(client_b, &subscribe_b, 1));
+    daemon.serviceOnce(0);
+    EXPECT_FALSE(isReadable(client_a));
+    EXPECT_FALSE(isReadable(client_b));
+
+    chip.setInputs(0x0201);
+    daemon.serviceOnce(0);
+
+    ASSERT_EQ(1u, receiveRecords(client_a, events, 2));
+    EXPECT_TRUE(Opcode::EVENT == events[0].opcode);
+    EXPECT_EQ(0x0201, events[0].values);
+    EXPECT_EQ(0x0001, events[0].mask);
+    ASSERT_EQ(1u, receiveRecords(client_b, events, 2));
+    EXPECT_EQ(0x0200, events[0].mask);
+
+    // Only the pins of client A change
+    chip.setInputs(0x0209);
+    daemon.serviceOnce(0);
+    ASSERT_EQ(1u, receiveRecords(client_a, events, 2));
+    EXPECT_EQ(0x0008, events[0].mask);
+    EXPECT_FALSE(isReadable(client_b));
+
+    ::close(client_a);
+    ::close(client_b);
+}
+
+TEST_F(ExpanderDaemon, serviceOnce$WHENAClientSubscribesTHENChangesNotYetSampledStillReachTheOtherSubscribers) {
+    MOCK_mcp23s17 chip(0);
+    mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_0);
+    mcp23s17 * const devices[] = { &gpio_x };
+    expander_daemon daemon(devices, 1);
+    Record events[2];
+
+    ASSERT_TRUE(daemon.listen(socketPath().c_str()));
+    const int client_a(connectClient());
+    const int client_b(connectClient());
+    ASSERT_GE(client_a, 0);
+    ASSERT_GE(client_b, 0);
+    daemon.serviceOnce(0);
+
+    const Record subscribe_a{ Opcode::SUBSCRIBE, 0, 0x0000, 0x0001 };
+    ASSERT_TRUE(sendRecords(client_a, &subscribe_a, 1));
+    daemon.serviceOnce(0);
+
+    // Pin 0 changes, and client B subscribes before the change is sampled
+    chip.setInputs(0x0003);
+    const Record subscribe_b{ Opcode::SUBSCRIBE, 0, 0x0000, 0x0002 };
+    ASSERT_TRUE(sendRecords(client_b, &subscribe_b, 1));
+    daemon.serviceOnce(0);
+
+    ASSERT_EQ(1u, receiveRecords(client_a, events, 2));
+    EXPECT_TRUE(Opcode::EVENT == events[0].opcode);
+    EXPECT_EQ(0x0001, events[0].mask);
+    EXPECT_FALSE(isReadable(client_b));
+
+    ::close(client_a);
+    ::close(client_b);
+}
+
+TEST_F(ExpanderDaemon, serviceOnce$WHENASubscriberDisconnectsTHENItsPinsAreNoLongerSampled) {
+    MOCK_mcp23s17 chip(0);
+    mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_0);
+    mcp23s17 * const devices[] = { &gpio_x };
+    expander_daemon daemon(devices, 1);
+
+    ASSERT_TRUE(daemon.listen(socketPath().c_str()));
+    const int client(connectClient());
+    ASSERT_GE(client, 0);
+    daemon.serviceOnce(0);
+
+    const Record subscribe{ Opcode::SUBSCRIBE, 0, 0x0000, 0xFFFF };
+    ASSERT_TRUE(sendRecords(client, &subscribe, 1));
+    daemon.serviceOnce(0);
+    ::close(client);
+    daemon.serviceOnce(0);
+
+    chip.frames.clear();
+    daemon.serviceOnce(0);
+    EXPECT_EQ(0u, chip.frames.size());
+}
+
+TEST_F(ExpanderDaemon, serviceOnce$WHENARecordCannotBeServedTHENAnErrorEchoesIt) {
+    MOCK_mcp23s17 chip(0);
+    mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_0);
+    mcp23s17 * const devices[] = { &gpio_x };
+    expander_daemon daemon(devices, 1);
+    Record responses[4];
+
+    ASSERT_TRUE(daemon.listen(socketPath().c_str()));
+    const int client(connectClient());
+    ASSERT_GE(client, 0);
+    daemon.serviceOnce(0);
+
+    const Record requests[] = {
+        { Opcode::READ, 1, 0x0000, 0xFFFF },
+        { static_cast<Opcode>(0x7E), 0, 0x0000, 0xFFFF },
+        { Opcode::PIN_MODES, 0, 0x0009, 0xFFFF },
+        { Opcode::READ, 0, 0x0000, 0x0001 },
+    };
+    ASSERT_TRUE(sendRecords(client, requests, 4));
+    EXPECT_EQ(1u, daemon.serviceOnce(0));
+
+    ASSERT_EQ(4u, receiveRecords(client, responses, 4));
+    EXPECT_TRUE(Opcode::ERROR == responses[0].opcode);
+    EXPECT_EQ(1, responses[0].device);
+    EXPECT_TRUE(Opcode::ERROR == responses[1].opcode);
+    EXPECT_TRUE(Opcode::ERROR == responses[2].opcode);
+    EXPECT_EQ(0x0009, responses[2].values);
+    EXPECT_TRUE(Opcode::READ == responses[3].opcode);
+
+    // A partial record rejects the whole message
+    const uint8_t partial[] = { 0x01, 0x00, 0x00 };
+    ASSERT_EQ(3, ::send(client, partial, sizeof(partial), MSG_NOSIGNAL));
+    EXPECT_EQ(0u, daemon.serviceOnce(0));
+    ASSERT_EQ(1u, receiveRecords(client, responses, 4));
+    EXPECT_TRUE(Opcode::ERROR == responses[0].opcode);
+
+    ::close(client);
+}
+
+TEST_F(ExpanderDaemon, run$WHENStopIsCalledFromAnotherThreadTHENRunReturns) {
+    MOCK_mcp23s17 chip(0);
+    mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_0);
+    mcp23s17 * const devices[] = { &gpio_x };
+    expander_daemon daemon(devices, 1);
+    Record responses[1];
+
+    chip.setInputs(0x8001);
+    ASSERT_TRUE(daemon.listen(socketPath().c_str()));
+    std::thread loop([&daemon](){ daemon.run(1000); });
+
+    const int client(connectClient());
+    ASSERT_GE(client, 0);
+    const Record request{ Opcode::READ, 0, 0x0000, 0xFFFF };
+    ASSERT_TRUE(sendRecords(client, &request, 1));
+    ASSERT_TRUE(isReadable(client, 5000));
+    ASSERT_EQ(1u, receiveRecords(client, responses, 1));
+    EXPECT_EQ(0x8001, responses[0].values);
+
+    daemon.stop();
+    loop.join();
+    ::close(client);
+}
+
+} // namespace
+
+#endif // MCP23S17_HOST && __linux__
+
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
@@ -0,0 +1,216 @@
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+#include <vector>
+
+#include "../hd44780.h"
+#include "MOCK_wiring.h"
+
+class TC_hd44780 : public hd44780 {
+  public:
+    TC_hd44780 (
+        mcp23s17 & gpio_x_,
+        const uint8_t rs_pin_,
+        const uint8_t enable_pin_,
+        const uint8_t d4_pin_,
+        const uint8_t d5_pin_,
+        const uint8_t d6_pin_,
+        const uint8_t d7_pin_,
+        const uint8_t columns_,
+        const uint8_t rows_
+    ): hd44780(gpio_x_, rs_pin_, enable_pin_, d4_pin_, d5_pin_, d6_pin_, d7_pin_, columns_, rows_)
+    {}
+
+    // Access protected test members
+    using hd44780::getFramebuffer;
+};
+
+namespace {
+
+// Pin assignment (port B): RS => 8, E => 9, D4-D7 => 12-15
+const uint8_t RS = 8;
+const uint8_t E = 9;
+const uint8_t RS_BIT = 0x01;
+const uint8_t E_BIT = 0x02;
+
+// Bytes per IOCON transaction (set as the session opens, restored as it closes)
+const size_t IOCON_FRAME_LENGTH = 3;
+
+// Bytes per byte streamed to a single port (stream header, five samples)
+const size_t BYTE_FRAME_LENGTH = 7;
+
+class MockSPIStream : public ::testing::Test {
+  protected:
+    std::vector<uint8_t> _spi_transaction;
+    mcp23s17 * _gpio_x;
+
+    MockSPIStream (
+        void
+    ) :
+        _gpio_x(nullptr)
+    {}
+
+    void SetUp (void) {
+        MOCK::initMockState();
+        SPI._transfer = [&](uint8_t byte_){
+            _spi_transaction.push_back(byte_);
+            return static_cast<uint8_t>(0x00);
+        };
+        _gpio_x = new mcp23s17(mcp23s17::HardwareAddress::HW_ADDR_6);
+    }
+    void TearDown (void) {
+        delete _gpio_x;
+    }
+
+    void ResetSpi (void) {
+        _spi_transaction.clear();
+        MOCK::resetPinTransitions();
+    }
+};
+
+TEST_F(MockSPIStream, hd44780$WHENObjectIsConstructedTHENTheFramebufferIsBlank) {
+    TC_hd44780 lcd(*_gpio_x, RS, E, 12, 13, 14, 15, 16, 2);
+
+    for ( int i = 0 ; i < hd44780::CELL_COUNT ; ++i ) {
+        EXPECT_EQ(' ', lcd.getFramebuffer()[i]) << "Error at index <" << i << ">!";
+    }
+}
+
+TEST_F(MockSPIStream, write$WHENCalledTHENTheCharacterIsOnlyStoredInTheFramebuffer) {
+    TC_hd44780 lcd(*_gpio_x, RS, E, 12, 13, 14, 15, 16, 2);
+    lcd.begin();
+
+    ResetSpi();
+    EXPECT_EQ(1u, lcd.write('A'));
+    EXPECT_EQ('A', lcd.getFramebuffer()[0]);
+    EXPECT_EQ(0u, _spi_transaction.size());
+}
+
+TEST_F(MockSPIStream, print$WHENCalledPastTheEndOfTheRowTHENTheRemainingCharactersAreDiscarded) {
+    TC_hd44780 lcd(*_gpio_x, RS, E, 12, 13, 14, 15, 16, 2);
+
+    lcd.setCursor(14, 0);
+    EXPECT_EQ(2u, lcd.print("XYZ"));
+    EXPECT_EQ('X', lcd.getFramebuffer()[14]);
+    EXPECT_EQ('Y', lcd.getFramebuffer()[15]);
+    EXPECT_EQ(' ', lcd.getFramebuffer()[16]);
+}
+
+TEST_F(MockSPIStream, refresh$WHENNothingHasChangedTHENNoSPITransactionOccurs) {
+    TC_hd44780 lcd(*_gpio_x, RS, E, 12, 13, 14, 15, 16, 2);
+    lcd.begin();
+
+    ResetSpi();
+    lcd.refresh();
+    EXPECT_EQ(0u, _spi_transaction.size());
+}
+
+TEST_F(MockSPIStream, refresh$WHENACharacterIsWrittenAtTheAddressCounterTHENItIsSentAsOneStreamWithoutACursorCommand) {
+    TC_hd44780 lcd(*_gpio_x, RS, E, 12, 13, 14, 15, 16, 2);
+    lcd.begin();
+    lcd.write('A');
+
+    ResetSpi();
+    lcd.refresh();
+    ASSERT_EQ((IOCON_FRAME_LENGTH + BYTE_FRAME_LENGTH + IOCON_FRAME_LENGTH), _spi_transaction.size());
+    EXPECT_EQ(MOCK::PinTransition::NO_TRANSITION, MOCK::getPinTransition(SS)[6]);
+    EXPECT_EQ(0x19, _spi_transaction[4]);
+    EXPECT_EQ((0x40 | RS_BIT), _spi_transaction[5]);
+    EXPECT_EQ((0x40 | RS_BIT | E_BIT), _spi_transaction[6]);
+    EXPECT_EQ((0x40 | RS_BIT), _spi_transaction[7]);
+    EXPECT_EQ((0x10 | RS_BIT | E_BIT), _spi_transaction[8]);
+    EXPECT_EQ((0x10 | RS_BIT), _spi_transaction[9]);
+}
+
+TEST_F(MockSPIStream, refresh$WHENAdjacentCharactersAreWrittenTHENOnlyOneCursorCommandIsSent) {
+    TC_hd44780 lcd(*_gpio_x, RS, E, 12, 13, 14, 15, 16, 2);
+    lcd.begin();
+    lcd.setCursor(5, 1);
+    lcd.print("AB");
+
+    ResetSpi();
+    lcd.refresh();
+    ASSERT_EQ((IOCON_FRAME_LENGTH + (3 * BYTE_FRAME_LENGTH) + IOCON_FRAME_LENGTH), _spi_transaction.size());
+
+    // Set DDRAM address 0x45 (command => RS LOW)
+    EXPECT_EQ(0xC0, _spi_transaction[5]);
+    EXPECT_EQ(0x50, _spi_transaction[9]);
+
+    // Characters
+    EXPECT_EQ((0x40 | RS_BIT), _spi_transaction[IOCON_FRAME_LENGTH + BYTE_FRAME_LENGTH + 2]);
+    EXPECT_EQ((0x20 | RS_BIT), _spi_transaction[IOCON_FRAME_LENGTH + (2 * BYTE_FRAME_LENGTH) + 6]);
+}
+
+TEST_F(MockSPIStream, refresh$WHENSeveralCharactersAreSentTHENIOCONIsConfiguredOnceAndRestoredOnce) {
+    TC_hd44780 lcd(*_gpio_x, RS, E, 12, 13, 14, 15, 16, 2);
+    lcd.begin();
+    lcd.print("ABC");
+    lcd.setCursor(0, 1);
+    lcd.print("D");
+
+    ResetSpi();
+    lcd.refresh();
+    ASSERT_EQ((IOCON_FRAME_LENGTH + (5 * BYTE_FRAME_LENGTH) + IOCON_FRAME_LENGTH), _spi_transaction.size());
+
+    // IOCON.BANK | IOCON.SEQOP | IOCON.HAEN
+    EXPECT_EQ(0x4C, _spi_transaction[0]);
+    EXPECT_EQ(static_cast<uint8_t>(mcp23s17::ControlRegister::IOCONA), _spi_transaction[1]);
+    EXPECT_EQ(0xA8, _spi_transaction[2]);
+
+    // Each transaction addresses GPIOB (as addressed when IOCON.BANK = 1)
+    for ( size_t i = 0 ; i < 5 ; ++i ) {
+        EXPECT_EQ(0x4C, _spi_transaction[IOCON_FRAME_LENGTH + (i * BYTE_FRAME_LENGTH)]) << "Error at frame <" << i << ">!";
+        EXPECT_EQ(0x19, _spi_transaction[IOCON_FRAME_LENGTH + (i * BYTE_FRAME_LENGTH) + 1]) << "Error at frame <" << i << ">!";
+    }
+
+    // IOCON is restored (as addressed when IOCON.BANK = 1)
+    EXPECT_EQ(0x4C, _spi_transaction[_spi_transaction.size() - 3]);
+    EXPECT_EQ(0x05, _spi_transaction[_spi_transaction.size() - 2]);
+    EXPECT_EQ(0x08, _spi_transaction[_spi_transaction.size() - 1]);
+}
+
+TEST_F(MockSPIStream, hd44780$WHENTheDisplayHasNoColumnsTHENEveryWriteIsRejected) {
+    TC_hd44780 lcd(*_gpio_x, RS, E, 12, 13, 14, 15, 0, 2);
+    lcd.begin();
+
+    ResetSpi();
+    lcd.setCursor(0, 0);
+    EXPECT_EQ(0u, lcd.write('A'));
+    EXPECT_EQ(0u, lcd.print("BC"));
+    lcd.refresh();
+    EXPECT_EQ(0u, _spi_transaction.size());
+}
+
+TEST_F(MockSPIStream, refresh$WHENACharacterIsRewrittenWithTheSameValueTHENNoSPITransactionOccurs) {
+    TC_hd44780 lcd(*_gpio_x, RS, E, 12, 13, 14, 15, 16, 2);
+    lcd.begin();
+    lcd.write('A');
+    lcd.refresh();
+
+    ResetSpi();
+    lcd.setCursor(0, 0);
+    lcd.write('A');
+    lcd.refresh();
+    EXPECT_EQ(0u, _spi_transaction.size());
+}
+
+TEST_F(MockSPIStream, refresh$WHENPinsSpanBothPortsTHENSamplesAreStreamedToGPIOAAndGPIOB) {
+    TC_hd44780 lcd(*_gpio_x, 0, 1, 12, 13, 14, 15, 16, 2);
+    lcd.begin();
+    lcd.write('A');
+
+    ResetSpi();
+    lcd.refresh();
+    ASSERT_EQ(18u, _spi_transaction.size());
+    EXPECT_EQ(static_cast<uint8_t>(mcp23s17::ControlRegister::GPIOA_), _spi_transaction[4]);
+    EXPECT_EQ(0x01, _spi_transaction[5]);
+    EXPECT_EQ(0x40, _spi_transaction[6]);
+    EXPECT_EQ(0x03, _spi_transaction[7]);
+    EXPECT_EQ(0x40, _spi_transaction[8]);
+}
+
+} // namespace
+
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
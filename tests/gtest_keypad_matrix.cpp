@@ -0,0 +1,176 @@
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+#include "../keypad_matrix.h"
+#include "MOCK_mcp23s17.h"
+#include "MOCK_wiring.h"
+
+namespace {
+
+const uint8_t ROWS = 4;
+const uint8_t COLUMNS = 4;
+
+class MockKeypad : public ::testing::Test {
+  protected:
+    MOCK_mcp23s17 * _chip;
+    mcp23s17 * _gpio_x;
+    bool _pressed[ROWS][COLUMNS];
+
+    MockKeypad (
+        void
+    ) :
+        _chip(nullptr),
+        _gpio_x(nullptr),
+        _pressed{ { false } }
+    {}
+
+    void SetUp (void) {
+        MOCK::initMockState();
+        _chip = new MOCK_mcp23s17(6);
+        _gpio_x = new mcp23s17(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+        // Rows on port A, columns (pulled up) on port B
+        _chip->setWiring([&](uint16_t outputs_, uint16_t){
+            uint16_t columns(0xFF00);
+            for ( int row = 0 ; row < ROWS ; ++row ) for ( int column = 0 ; column < COLUMNS ; ++column ) {
+                if ( _pressed[row][column] && !((outputs_ >> row) & 0x01) ) { columns &= ~(1 << (column + 8)); }
+            }
+            return columns;
+        });
+    }
+    void TearDown (void) {
+        delete _gpio_x;
+        delete _chip;
+    }
+
+    void Press (int row_, int column_, bool pressed_ = true) {
+        const uint16_t previous(_chip->getPins());
+        _pressed[row_][column_] = pressed_;
+        _chip->evaluate(previous);
+    }
+};
+
+TEST_F(MockKeypad, begin$WHENCalledTHENRowsAreDrivenLOWAndColumnInterruptsAreArmed) {
+    keypad_matrix keypad(*_gpio_x, mcp23s17::Port::A, ROWS, COLUMNS);
+
+    keypad.begin();
+    EXPECT_TRUE(keypad.isIdle());
+    EXPECT_EQ(0xF0, _chip->getRegister(MOCK_mcp23s17::IODIRA));
+    EXPECT_EQ(0x00, _chip->getRegister(MOCK_mcp23s17::OLATA));
+    EXPECT_EQ(0x0F, _chip->getRegister(MOCK_mcp23s17::GPPUB));
+    EXPECT_EQ(0x0F, _chip->getRegister(MOCK_mcp23s17::GPINTENB));
+    EXPECT_EQ(0x00, _chip->getRegister(MOCK_mcp23s17::INTCONB));
+}
+
+TEST_F(MockKeypad, begin$WHENTheRowLatchesAreHIGHTHENTheyAreClearedInTheFrameThatDrivesTheRows) {
+    keypad_matrix keypad(*_gpio_x, mcp23s17::Port::A, ROWS, COLUMNS);
+
+    _gpio_x->pinModesOutput(0x000F, 0x000F);
+    _gpio_x->pinModes(0x000F, mcp23s17::PinMode::INPUT);
+    _chip->frames.clear();
+    keypad.begin();
+    ASSERT_LE(1u, _chip->frames.size());
+    ASSERT_EQ(5u, _chip->frames[0].size());
+    EXPECT_EQ(static_cast<uint8_t>(mcp23s17::ControlRegister::OLATA), _chip->frames[0][1]);
+    EXPECT_EQ(0x00, _chip->frames[0][2]);  // OLATA
+    EXPECT_EQ(0xF0, _chip->frames[0][4]);  // IODIRA
+}
+
+TEST_F(MockKeypad, scan$WHENAKeyIsPressedWhileIdleTHENTheInterruptIsAsserted) {
+    keypad_matrix keypad(*_gpio_x, mcp23s17::Port::A, ROWS, COLUMNS);
+    keypad.begin();
+
+    _chip->frames.clear();
+    Press(2, 1);
+    EXPECT_TRUE(_chip->isInterruptAsserted());
+    EXPECT_EQ(0u, _chip->frames.size());
+}
+
+TEST_F(MockKeypad, scan$WHENCalledTHENEachRowCostsOneWriteAndOneReadOfThreeBytes) {
+    keypad_matrix keypad(*_gpio_x, mcp23s17::Port::A, ROWS, COLUMNS);
+    keypad_matrix::KeyEvent events[4];
+    keypad.begin();
+    Press(0, 0);
+
+    _chip->frames.clear();
+    keypad.scan(events, 4);
+    ASSERT_LE(static_cast<size_t>(2 * ROWS), _chip->frames.size());
+    for ( size_t i = 0 ; i < (2 * ROWS) ; ++i ) {
+        EXPECT_EQ(3u, _chip->frames[i].size()) << "Error at frame <" << i << ">!";
+    }
+}
+
+TEST_F(MockKeypad, scan$WHENAKeyIsHeldForTheDebounceIntervalTHENAPressedEventIsReported) {
+    keypad_matrix keypad(*_gpio_x, mcp23s17::Port::A, ROWS, COLUMNS, 2);
+    keypad_matrix::KeyEvent events[4];
+    keypad.begin();
+    Press(2, 1);
+
+    EXPECT_EQ(0u, keypad.scan(events, 4));
+    ASSERT_EQ(1u, keypad.scan(events, 4));
+    EXPECT_EQ(2, events[0].row);
+    EXPECT_EQ(1, events[0].column);
+    EXPECT_EQ(keypad_matrix::KeyState::PRESSED, events[0].state);
+    EXPECT_EQ(keypad_matrix::KeyState::PRESSED, keypad.getKeyState(2, 1));
+    EXPECT_FALSE(keypad.isIdle());
+}
+
+TEST_F(MockKeypad, scan$WHENAKeyBouncesTHENNoEventIsReported) {
+    keypad_matrix keypad(*_gpio_x, mcp23s17::Port::A, ROWS, COLUMNS, 2);
+    keypad_matrix::KeyEvent events[4];
+    keypad.begin();
+
+    Press(2, 1);
+    EXPECT_EQ(0u, keypad.scan(events, 4));
+    Press(2, 1, false);
+    EXPECT_EQ(0u, keypad.scan(events, 4));
+    Press(2, 1);
+    EXPECT_EQ(0u, keypad.scan(events, 4));
+}
+
+TEST_F(MockKeypad, scan$WHENSeveralKeysArePressedTHENEachKeyIsReported) {
+    keypad_matrix keypad(*_gpio_x, mcp23s17::Port::A, ROWS, COLUMNS, 1);
+    keypad_matrix::KeyEvent events[4];
+    keypad.begin();
+
+    Press(0, 3);
+    Press(1, 3);
+    Press(3, 0);
+    EXPECT_EQ(3u, keypad.scan(events, 4));
+    EXPECT_EQ(keypad_matrix::KeyState::PRESSED, keypad.getKeyState(0, 3));
+    EXPECT_EQ(keypad_matrix::KeyState::PRESSED, keypad.getKeyState(1, 3));
+    EXPECT_EQ(keypad_matrix::KeyState::PRESSED, keypad.getKeyState(3, 0));
+}
+
+TEST_F(MockKeypad, scan$WHENTheEventBufferIsFullTHENTheRemainingEventsAreReportedNextScan) {
+    keypad_matrix keypad(*_gpio_x, mcp23s17::Port::A, ROWS, COLUMNS, 1);
+    keypad_matrix::KeyEvent events[4];
+    keypad.begin();
+
+    Press(0, 0);
+    Press(3, 3);
+    EXPECT_EQ(1u, keypad.scan(events, 1));
+    EXPECT_EQ(1u, keypad.scan(events, 1));
+    EXPECT_EQ(3, events[0].row);
+}
+
+TEST_F(MockKeypad, scan$WHENAllKeysAreReleasedTHENTheKeypadReturnsToIdle) {
+    keypad_matrix keypad(*_gpio_x, mcp23s17::Port::A, ROWS, COLUMNS, 1);
+    keypad_matrix::KeyEvent events[4];
+    keypad.begin();
+
+    Press(1, 2);
+    ASSERT_EQ(1u, keypad.scan(events, 4));
+    Press(1, 2, false);
+    ASSERT_EQ(1u, keypad.scan(events, 4));
+    EXPECT_EQ(keypad_matrix::KeyState::RELEASED, events[0].state);
+    EXPECT_TRUE(keypad.isIdle());
+    EXPECT_EQ(0x00, _chip->getRegister(MOCK_mcp23s17::OLATA));
+    EXPECT_FALSE(_chip->isInterruptAsserted());
+}
+
+} // namespace
+
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
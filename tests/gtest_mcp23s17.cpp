@@ -3,7 +3,12 @@
 #include "gtest/gtest.h"
 #include "gmock/gmock.h"
 
+#include <chrono>
+#include <thread>
+
 #include "../mcp23s17.h"
+#include "../spi_bus.h"
+#include "MOCK_mcp23s17.h"
 #include "MOCK_wiring.h"
 
 //TODO: Consider 16-bit mode
@@ -779,7 +784,7 @@ TEST_F(MockSPITransfer, digitalWrite$WHENCalledOnPinLessThanEightTHENTheGPIOAReg
 
         ResetSpi();
         gpio_x.digitalWrite(pin, mcp23s17::PinLatchValue::HIGH);
-        EXPECT_EQ(mcp23s17::ControlRegister::GPIOA, static_cast<mcp23s17::ControlRegister>(_spi_transaction[1]));
+        EXPECT_EQ(mcp23s17::ControlRegister::GPIOA_, static_cast<mcp23s17::ControlRegister>(_spi_transaction[1]));
         ASSERT_LT(1, _index);
     }
 }
@@ -793,7 +798,7 @@ TEST_F(MockSPITransfer, digitalWrite$WHENCalledOnPinGreaterThanOrEqualToEightTHE
 
         ResetSpi();
         gpio_x.digitalWrite(pin, mcp23s17::PinLatchValue::HIGH);
-        EXPECT_EQ(mcp23s17::ControlRegister::GPIOB, static_cast<mcp23s17::ControlRegister>(_spi_transaction[1]));
+        EXPECT_EQ(mcp23s17::ControlRegister::GPIOB_, static_cast<mcp23s17::ControlRegister>(_spi_transaction[1]));
         ASSERT_LT(1, _index);
     }
 }
@@ -886,7 +891,7 @@ TEST_F(MockSPITransfer, digitalWrite$WHENPinIsSetOnPortATHENItPersistsOnSubseque
 
     ResetSpi();
     gpio_x.digitalWrite(PIN2, mcp23s17::PinLatchValue::HIGH);
-    EXPECT_EQ((1 << BIT_POSITION1), gpio_x.getControlRegister()[static_cast<uint8_t>(mcp23s17::ControlRegister::GPIOA)]);
+    EXPECT_EQ((1 << BIT_POSITION1), gpio_x.getControlRegister()[static_cast<uint8_t>(mcp23s17::ControlRegister::GPIOA_)]);
     ASSERT_LT(2, _index);
 }
 
@@ -1018,7 +1023,7 @@ TEST_F(MockSPITransfer, digitalRead$WHENCalledOnPinLessThanEightTHENTheGPIOARegi
 
         ResetSpi();
         gpio_x.digitalRead(pin);
-        EXPECT_EQ(mcp23s17::ControlRegister::GPIOA, static_cast<mcp23s17::ControlRegister>(_spi_transaction[1]));
+        EXPECT_EQ(mcp23s17::ControlRegister::GPIOA_, static_cast<mcp23s17::ControlRegister>(_spi_transaction[1]));
         ASSERT_LT(1, _index);
     }
 }
@@ -1032,7 +1037,7 @@ TEST_F(MockSPITransfer, digitalRead$WHENCalledOnPinGreaterThanOrEqualToEightTHEN
 
         ResetSpi();
         gpio_x.digitalRead(pin);
-        EXPECT_EQ(mcp23s17::ControlRegister::GPIOB, static_cast<mcp23s17::ControlRegister>(_spi_transaction[1]));
+        EXPECT_EQ(mcp23s17::ControlRegister::GPIOB_, static_cast<mcp23s17::ControlRegister>(_spi_transaction[1]));
         ASSERT_LT(1, _index);
     }
 }
@@ -1145,15 +1150,17 @@ TEST_F(MockSPITransfer, attachInterrupt$WHENCalledTHENCorrespondingCallbackIsSto
 
     EXPECT_EQ(interrupt_service_routine, gpio_x.getInterruptServiceRoutines()[PIN]);
 }
-/*
+
 TEST_F(MockSPITransfer, attachInterrupt$WHENCalledWithPinGreaterThanOrEqualToPinCountTHENInterruptServiceRoutineArrayIsNotModified) {
     TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
     mcp23s17::isr_t interrupt_service_routine = [](){};
 
     for ( int i = 0 ; i < mcp23s17::PIN_COUNT ; ++i ) {
+        ResetSpi();
         gpio_x.attachInterrupt(i, interrupt_service_routine, mcp23s17::InterruptMode::HIGH);
     }
 
+    ResetSpi();
     for ( int i = mcp23s17::PIN_COUNT ; i < 256 ; ++i ) {
         gpio_x.attachInterrupt(i, interrupt_service_routine, mcp23s17::InterruptMode::HIGH);
         for ( int j = 0 ; j < mcp23s17::PIN_COUNT ; ++j ) {
@@ -1161,7 +1168,7 @@ TEST_F(MockSPITransfer, attachInterrupt$WHENCalledWithPinGreaterThanOrEqualToPin
         }
     }
 }
-
+/*
 TEST_F(MockSPITransfer, attachInterrupt$WHENCalledWithNullFunctionPointerTHENInterruptServiceRoutineArrayIsNotModified) {
     TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
     mcp23s17::isr_t interrupt_service_routine = [](){};
@@ -1557,8 +1564,1250 @@ TEST_F(MockSPITransfer, attachInterrupt$WHENInterruptModeIsSetToChangeOnPortBTHE
     EXPECT_EQ(BitValue::SET, static_cast<BitValue>((_spi_transaction[7] >> BIT_POSITION1) & 0x01));
     ASSERT_LT(7, _index);
 }
-
-//TODO: invokeInterruptServiceRoutine() - Function to call interrupt routines upon interrupt from MCP23S17
+
+TEST_F(MockSPITransfer, attachInterrupt$WHENInterruptModeIsSetToHighTHENTheDefaultValuesOfOtherPinsPersist) {
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+    mcp23s17::isr_t interrupt_service_routine = [](){};
+
+    ResetSpi();
+    gpio_x.watch(0x8001, 0x8001);
+    ResetSpi();
+    gpio_x.attachInterrupt(3, interrupt_service_routine, mcp23s17::InterruptMode::HIGH);
+    EXPECT_EQ(0x09, _spi_transaction[4]);  // DEFVALA
+    EXPECT_EQ(0x80, _spi_transaction[5]);  // DEFVALB
+
+    ResetSpi();
+    gpio_x.attachInterrupt(9, interrupt_service_routine, mcp23s17::InterruptMode::LOW);
+    EXPECT_EQ(0x09, _spi_transaction[4]);  // DEFVALA
+    EXPECT_EQ(0x80, _spi_transaction[5]);  // DEFVALB
+}
+
+TEST_F(MockSPITransfer, attachInterrupt$WHENCalledWithPinGreaterThanOrEqualToPinCountTHENNoSPITransactionOccurs) {
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+    mcp23s17::isr_t interrupt_service_routine = [](){};
+
+    ResetSpi();
+    for ( int i = mcp23s17::PIN_COUNT ; i < 256 ; ++i ) {
+        gpio_x.attachInterrupt(i, interrupt_service_routine, mcp23s17::InterruptMode::HIGH);
+    }
+    EXPECT_EQ(0u, _index);
+}
+
+  /**********************/
+ /* digitalWriteStream */
+/**********************/
+
+TEST_F(MockSPITransfer, digitalWriteStream$WHENCalledWithAnEmptyBufferTHENNoSPITransactionOccurs) {
+    const uint8_t BUFFER[] = { 0x01 };
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    ResetSpi();
+    gpio_x.digitalWriteStream(mcp23s17::Port::A, BUFFER, 0);
+    EXPECT_EQ(0, _index);
+}
+
+TEST_F(MockSPITransfer, digitalWriteStream$WHENCalledTHENTheCallersChipSelectPinIsPulledFromHighToLowAndBackThreeTimes) {
+    const uint8_t BUFFER[] = { 0x01, 0x02, 0x03 };
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    gpio_x.pinModes(0xFFFF, mcp23s17::PinMode::OUTPUT);
+    ResetSpi(11);
+    gpio_x.digitalWriteStream(mcp23s17::Port::A, BUFFER, sizeof(BUFFER));
+    for ( int i = 0 ; i < 6 ; i += 2 ) {
+        EXPECT_EQ(MOCK::PinTransition::HIGH_TO_LOW, MOCK::getPinTransition(SS)[i]) << "Error at index <" << i << ">!";
+        EXPECT_EQ(MOCK::PinTransition::LOW_TO_HIGH, MOCK::getPinTransition(SS)[i + 1]) << "Error at index <" << (i + 1) << ">!";
+    }
+    EXPECT_EQ(MOCK::PinTransition::NO_TRANSITION, MOCK::getPinTransition(SS)[6]);
+}
+
+TEST_F(MockSPITransfer, digitalWriteStream$WHENCalledOnPortATHENIOCONBankAndSeqopAreSetBeforeTheStream) {
+    const uint8_t BUFFER[] = { 0x01, 0x02, 0x03 };
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    gpio_x.pinModes(0xFFFF, mcp23s17::PinMode::OUTPUT);
+    ResetSpi(11);
+    gpio_x.digitalWriteStream(mcp23s17::Port::A, BUFFER, sizeof(BUFFER));
+    EXPECT_EQ((gpio_x.getSpiBusAddress() | static_cast<uint8_t>(mcp23s17::RegisterTransaction::WRITE)), _spi_transaction[0]);
+    EXPECT_EQ(mcp23s17::ControlRegister::IOCONA, static_cast<mcp23s17::ControlRegister>(_spi_transaction[1]));
+    EXPECT_EQ((static_cast<uint8_t>(mcp23s17::IOConfigurationRegister::HAEN) | static_cast<uint8_t>(mcp23s17::IOConfigurationRegister::SEQOP) | static_cast<uint8_t>(mcp23s17::IOConfigurationRegister::BANK)), _spi_transaction[2]);
+}
+
+TEST_F(MockSPITransfer, digitalWriteStream$WHENCalledOnPortATHENEachValueIsSentToTheBankOneGPIOAAddress) {
+    const uint8_t BUFFER[] = { 0x01, 0x02, 0x03 };
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    gpio_x.pinModes(0xFFFF, mcp23s17::PinMode::OUTPUT);
+    ResetSpi(11);
+    gpio_x.digitalWriteStream(mcp23s17::Port::A, BUFFER, sizeof(BUFFER));
+    EXPECT_EQ((gpio_x.getSpiBusAddress() | static_cast<uint8_t>(mcp23s17::RegisterTransaction::WRITE)), _spi_transaction[3]);
+    EXPECT_EQ(0x09, _spi_transaction[4]);
+    EXPECT_EQ(0x01, _spi_transaction[5]);
+    EXPECT_EQ(0x02, _spi_transaction[6]);
+    EXPECT_EQ(0x03, _spi_transaction[7]);
+}
+
+TEST_F(MockSPITransfer, digitalWriteStream$WHENCalledOnPortBTHENEachValueIsSentToTheBankOneGPIOBAddress) {
+    const uint8_t BUFFER[] = { 0x01, 0x02, 0x03 };
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    gpio_x.pinModes(0xFFFF, mcp23s17::PinMode::OUTPUT);
+    ResetSpi(11);
+    gpio_x.digitalWriteStream(mcp23s17::Port::B, BUFFER, sizeof(BUFFER));
+    EXPECT_EQ(0x19, _spi_transaction[4]);
+    EXPECT_EQ(0x01, _spi_transaction[5]);
+    EXPECT_EQ(0x02, _spi_transaction[6]);
+    EXPECT_EQ(0x03, _spi_transaction[7]);
+}
+
+TEST_F(MockSPITransfer, digitalWriteStream$WHENCalledOnAPortTHENTheOriginalIOCONIsRestoredAtTheBankOneAddress) {
+    const uint8_t BUFFER[] = { 0x01, 0x02, 0x03 };
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    gpio_x.pinModes(0xFFFF, mcp23s17::PinMode::OUTPUT);
+    ResetSpi(11);
+    gpio_x.digitalWriteStream(mcp23s17::Port::A, BUFFER, sizeof(BUFFER));
+    EXPECT_EQ((gpio_x.getSpiBusAddress() | static_cast<uint8_t>(mcp23s17::RegisterTransaction::WRITE)), _spi_transaction[8]);
+    EXPECT_EQ(0x05, _spi_transaction[9]);
+    EXPECT_EQ(static_cast<uint8_t>(mcp23s17::IOConfigurationRegister::HAEN), _spi_transaction[10]);
+    EXPECT_EQ(static_cast<uint8_t>(mcp23s17::IOConfigurationRegister::HAEN), gpio_x.getControlRegister()[static_cast<uint8_t>(mcp23s17::ControlRegister::IOCONA)]);
+}
+
+TEST_F(MockSPITransfer, digitalWriteStream$WHENCalledOnAPortTHENTheFinalValueIsCached) {
+    const uint8_t BUFFER[] = { 0x01, 0x02, 0x03 };
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    gpio_x.pinModes(0xFFFF, mcp23s17::PinMode::OUTPUT);
+    ResetSpi(11);
+    gpio_x.digitalWriteStream(mcp23s17::Port::B, BUFFER, sizeof(BUFFER));
+    EXPECT_EQ(0x00, gpio_x.getControlRegister()[static_cast<uint8_t>(mcp23s17::ControlRegister::GPIOA_)]);
+    EXPECT_EQ(0x03, gpio_x.getControlRegister()[static_cast<uint8_t>(mcp23s17::ControlRegister::GPIOB_)]);
+}
+
+TEST_F(MockSPITransfer, digitalWriteStream$WHENCalledOnBothPortsTHENOnlyIOCONSeqopIsSetAndValuesAlternateBetweenGPIOAAndGPIOB) {
+    const uint16_t BUFFER[] = { 0x0201, 0x0403 };
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    gpio_x.pinModes(0xFFFF, mcp23s17::PinMode::OUTPUT);
+    ResetSpi(12);
+    gpio_x.digitalWriteStream(BUFFER, 2);
+    EXPECT_EQ(mcp23s17::ControlRegister::IOCONA, static_cast<mcp23s17::ControlRegister>(_spi_transaction[1]));
+    EXPECT_EQ((static_cast<uint8_t>(mcp23s17::IOConfigurationRegister::HAEN) | static_cast<uint8_t>(mcp23s17::IOConfigurationRegister::SEQOP)), _spi_transaction[2]);
+    EXPECT_EQ(mcp23s17::ControlRegister::GPIOA_, static_cast<mcp23s17::ControlRegister>(_spi_transaction[4]));
+    EXPECT_EQ(0x01, _spi_transaction[5]);
+    EXPECT_EQ(0x02, _spi_transaction[6]);
+    EXPECT_EQ(0x03, _spi_transaction[7]);
+    EXPECT_EQ(0x04, _spi_transaction[8]);
+    EXPECT_EQ(mcp23s17::ControlRegister::IOCONA, static_cast<mcp23s17::ControlRegister>(_spi_transaction[10]));
+    EXPECT_EQ(static_cast<uint8_t>(mcp23s17::IOConfigurationRegister::HAEN), _spi_transaction[11]);
+}
+
+TEST_F(MockSPITransfer, digitalWriteStream$WHENCalledOnBothPortsTHENTheFinalValueIsCached) {
+    const uint16_t BUFFER[] = { 0x0201, 0x0403 };
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    gpio_x.pinModes(0xFFFF, mcp23s17::PinMode::OUTPUT);
+    ResetSpi(12);
+    gpio_x.digitalWriteStream(BUFFER, 2);
+    EXPECT_EQ(0x03, gpio_x.getControlRegister()[static_cast<uint8_t>(mcp23s17::ControlRegister::GPIOA_)]);
+    EXPECT_EQ(0x04, gpio_x.getControlRegister()[static_cast<uint8_t>(mcp23s17::ControlRegister::GPIOB_)]);
+}
+
+TEST_F(MockSPITransfer, digitalWriteStream$WHENPinsAreConfiguredAsINPUTTHENTheirLatchBitsAreNeverUpdated) {
+    const uint8_t PORT_BUFFER[] = { 0xFF, 0xA5 };
+    const uint16_t BUFFER[] = { 0xFFFF, 0x5AA5 };
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+    gpio_x.pinModes(0x0F0F, mcp23s17::PinMode::OUTPUT);
+
+    ResetSpi(11);
+    gpio_x.digitalWriteStream(mcp23s17::Port::A, PORT_BUFFER, sizeof(PORT_BUFFER));
+    EXPECT_EQ(0x0F, _spi_transaction[5]);
+    EXPECT_EQ(0x05, _spi_transaction[6]);
+    EXPECT_EQ(0x05, gpio_x.getControlRegister()[static_cast<uint8_t>(mcp23s17::ControlRegister::GPIOA_)]);
+
+    ResetSpi(12);
+    gpio_x.digitalWriteStream(BUFFER, 2);
+    EXPECT_EQ(0x0F, _spi_transaction[5]);
+    EXPECT_EQ(0x0F, _spi_transaction[6]);
+    EXPECT_EQ(0x05, _spi_transaction[7]);
+    EXPECT_EQ(0x0A, _spi_transaction[8]);
+    EXPECT_EQ(0x0A05, gpio_x.getLatchValues());
+}
+
+TEST_F(MockSPITransfer, digitalWriteStream$WHENTheBufferExceedsAChunkTHENEachChunkIsATransactionOfItsOwn) {
+    uint8_t buffer[mcp23s17::STREAM_CHUNK_LENGTH + 1];
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+    gpio_x.pinModes(0xFFFF, mcp23s17::PinMode::OUTPUT);
+    for ( size_t i = 0 ; i < sizeof(buffer) ; ++i ) { buffer[i] = i; }
+
+    // (IOCON, stream header, samples, IOCON) per chunk
+    ResetSpi(128);
+    gpio_x.digitalWriteStream(mcp23s17::Port::A, buffer, sizeof(buffer));
+    EXPECT_EQ(81u, _index);
+    EXPECT_EQ(0x3F, _spi_transaction[68]);
+    EXPECT_EQ(0x05, _spi_transaction[70]);
+    EXPECT_EQ(0x0A, _spi_transaction[73]);
+    EXPECT_EQ(0x09, _spi_transaction[76]);
+    EXPECT_EQ(0x40, _spi_transaction[77]);
+    EXPECT_EQ(0x40, gpio_x.getControlRegister()[static_cast<uint8_t>(mcp23s17::ControlRegister::GPIOA_)]);
+}
+
+  /*********************/
+ /* digitalReadStream */
+/*********************/
+
+TEST_F(MockSPITransfer, digitalReadStream$WHENCalledWithAnEmptyBufferTHENNoSPITransactionOccurs) {
+    uint8_t buffer[1] = { 0 };
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    ResetSpi();
+    EXPECT_EQ(0u, gpio_x.digitalReadStream(mcp23s17::Port::A, buffer, 0));
+    EXPECT_EQ(0, _index);
+}
+
+TEST_F(MockSPITransfer, digitalReadStream$WHENCalledOnPortBTHENAReadTransactionIsSentToTheBankOneGPIOBAddress) {
+    uint8_t buffer[3] = { 0 };
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    ResetSpi(11);
+    gpio_x.digitalReadStream(mcp23s17::Port::B, buffer, sizeof(buffer));
+    EXPECT_EQ((static_cast<uint8_t>(mcp23s17::IOConfigurationRegister::HAEN) | static_cast<uint8_t>(mcp23s17::IOConfigurationRegister::SEQOP) | static_cast<uint8_t>(mcp23s17::IOConfigurationRegister::BANK)), _spi_transaction[2]);
+    EXPECT_EQ((gpio_x.getSpiBusAddress() | static_cast<uint8_t>(mcp23s17::RegisterTransaction::READ)), _spi_transaction[3]);
+    EXPECT_EQ(0x19, _spi_transaction[4]);
+    EXPECT_EQ(0x05, _spi_transaction[9]);
+    EXPECT_EQ(static_cast<uint8_t>(mcp23s17::IOConfigurationRegister::HAEN), _spi_transaction[10]);
+}
+
+TEST_F(MockSPITransfer, digitalReadStream$WHENCalledOnAPortTHENEachSampleIsStoredInTheCallersBuffer) {
+    uint8_t buffer[3] = { 0 };
+    uint8_t sample(0x10);
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    ResetSpi(11);
+    SPI._transfer = [&](uint8_t byte_){
+        _spi_transaction[_index] = byte_;
+        return (( 5 <= _index++ ) ? sample++ : static_cast<uint8_t>(0x00));
+    };
+    gpio_x.digitalReadStream(mcp23s17::Port::A, buffer, sizeof(buffer));
+    EXPECT_EQ(0x10, buffer[0]);
+    EXPECT_EQ(0x11, buffer[1]);
+    EXPECT_EQ(0x12, buffer[2]);
+}
+
+TEST_F(MockSPITransfer, digitalReadStream$WHENCalledOnBothPortsTHENSamplesAreAssembledFromAlternatingGPIOAAndGPIOBBytes) {
+    uint16_t buffer[2] = { 0 };
+    uint8_t sample(0x01);
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    ResetSpi(12);
+    SPI._transfer = [&](uint8_t byte_){
+        _spi_transaction[_index] = byte_;
+        return (( 5 <= _index++ ) ? sample++ : static_cast<uint8_t>(0x00));
+    };
+    gpio_x.digitalReadStream(buffer, 2);
+    EXPECT_EQ((static_cast<uint8_t>(mcp23s17::IOConfigurationRegister::HAEN) | static_cast<uint8_t>(mcp23s17::IOConfigurationRegister::SEQOP)), _spi_transaction[2]);
+    EXPECT_EQ(mcp23s17::ControlRegister::GPIOA_, static_cast<mcp23s17::ControlRegister>(_spi_transaction[4]));
+    EXPECT_EQ(0x0201, buffer[0]);
+    EXPECT_EQ(0x0403, buffer[1]);
+}
+
+TEST_F(MockSPITransfer, digitalReadStream$WHENCalledTHENTheSamplePeriodIsEstimatedInNanoseconds) {
+    uint8_t buffer[4] = { 0 };
+    unsigned long now_us(1000);
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    ResetSpi(12);
+    MOCK::setMicros([&](){ unsigned long result = now_us; now_us += 6; return result; });
+    EXPECT_EQ(1500u, gpio_x.digitalReadStream(mcp23s17::Port::A, buffer, sizeof(buffer)));
+}
+
+TEST_F(MockSPITransfer, digitalReadStream$WHENTheCaptureExceedsAChunkTHENOnlyTheTimeWithinEachChunkIsCounted) {
+    uint8_t buffer[2 * mcp23s17::STREAM_CHUNK_LENGTH] = { 0 };
+    unsigned long now_us(1000);
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    ResetSpi(160);
+    MOCK::setMicros([&](){ unsigned long result = now_us; now_us += 100; return result; });
+    EXPECT_EQ(1562u, gpio_x.digitalReadStream(mcp23s17::Port::A, buffer, sizeof(buffer)));
+    EXPECT_EQ(144u, _index);
+    EXPECT_EQ(0x0A, _spi_transaction[73]);
+}
+
+  /************/
+ /* shiftOut */
+/************/
+
+TEST_F(MockSPITransfer, shiftOut$WHENCalledOnPinsInInputModeTHENNoSPITransactionOccurs) {
+    const uint8_t DATA_PIN = 0;
+    const uint8_t CLOCK_PIN = 1;
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    ResetSpi();
+    gpio_x.pinMode(DATA_PIN, mcp23s17::PinMode::OUTPUT);
+
+    ResetSpi();
+    gpio_x.shiftOut(DATA_PIN, CLOCK_PIN, MSBFIRST, 0xA5);
+    EXPECT_EQ(0, _index);
+}
+
+TEST_F(MockSPITransfer, shiftOut$WHENAPinIsOutOfRangeTHENNoSPITransactionOccurs) {
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+    gpio_x.pinModes(0xFFFF, mcp23s17::PinMode::OUTPUT);
+
+    ResetSpi();
+    gpio_x.shiftOut(40, 1, MSBFIRST, 0xA5);
+    gpio_x.shiftOut(0, 200, MSBFIRST, 0xA5);
+    EXPECT_EQ(0, _index);
+}
+
+TEST_F(MockSPITransfer, shiftOut$WHENCalledOnPinsFromTheSamePortTHENTheSequenceIsStreamedOneBytePerSample) {
+    const uint8_t DATA_PIN = 8;
+    const uint8_t CLOCK_PIN = 9;
+    const uint8_t VALUE = 0xA5;
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    ResetSpi();
+    gpio_x.pinMode(DATA_PIN, mcp23s17::PinMode::OUTPUT);
+    ResetSpi();
+    gpio_x.pinMode(CLOCK_PIN, mcp23s17::PinMode::OUTPUT);
+
+    ResetSpi(25);
+    gpio_x.shiftOut(DATA_PIN, CLOCK_PIN, MSBFIRST, VALUE);
+    EXPECT_EQ(0x19, _spi_transaction[4]);
+    for ( int bit = 0 ; bit < 8 ; ++bit ) {
+        const uint8_t data = ((VALUE >> (7 - bit)) & 0x01);
+        EXPECT_EQ(data, _spi_transaction[5 + (bit * 2)]) << "Error at bit <" << bit << ">!";
+        EXPECT_EQ((data | 0x02), _spi_transaction[6 + (bit * 2)]) << "Error at bit <" << bit << ">!";
+    }
+    EXPECT_EQ(0x01, _spi_transaction[21]);
+    EXPECT_EQ(0x05, _spi_transaction[23]);
+    EXPECT_EQ(25u, _index);
+}
+
+TEST_F(MockSPITransfer, shiftOut$WHENCalledWithLSBFIRSTTHENTheLeastSignificantBitIsShiftedFirst) {
+    const uint8_t DATA_PIN = 0;
+    const uint8_t CLOCK_PIN = 1;
+    const uint8_t VALUE = 0x01;
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    ResetSpi();
+    gpio_x.pinMode(DATA_PIN, mcp23s17::PinMode::OUTPUT);
+    ResetSpi();
+    gpio_x.pinMode(CLOCK_PIN, mcp23s17::PinMode::OUTPUT);
+
+    ResetSpi(25);
+    gpio_x.shiftOut(DATA_PIN, CLOCK_PIN, LSBFIRST, VALUE);
+    EXPECT_EQ(0x09, _spi_transaction[4]);
+    EXPECT_EQ(0x01, _spi_transaction[5]);
+    EXPECT_EQ(0x03, _spi_transaction[6]);
+    EXPECT_EQ(0x00, _spi_transaction[7]);
+    EXPECT_EQ(0x02, _spi_transaction[8]);
+}
+
+TEST_F(MockSPITransfer, shiftOut$WHENCalledOnPinsFromDifferentPortsTHENTheSequenceAlternatesBetweenGPIOAAndGPIOB) {
+    const uint8_t DATA_PIN = 0;
+    const uint8_t CLOCK_PIN = 8;
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    ResetSpi();
+    gpio_x.pinMode(DATA_PIN, mcp23s17::PinMode::OUTPUT);
+    ResetSpi();
+    gpio_x.pinMode(CLOCK_PIN, mcp23s17::PinMode::OUTPUT);
+
+    ResetSpi(42);
+    gpio_x.shiftOut(DATA_PIN, CLOCK_PIN, MSBFIRST, 0x80);
+    EXPECT_EQ((static_cast<uint8_t>(mcp23s17::IOConfigurationRegister::HAEN) | static_cast<uint8_t>(mcp23s17::IOConfigurationRegister::SEQOP)), _spi_transaction[2]);
+    EXPECT_EQ(mcp23s17::ControlRegister::GPIOA_, static_cast<mcp23s17::ControlRegister>(_spi_transaction[4]));
+    EXPECT_EQ(0x01, _spi_transaction[5]);
+    EXPECT_EQ(0x00, _spi_transaction[6]);
+    EXPECT_EQ(0x01, _spi_transaction[7]);
+    EXPECT_EQ(0x01, _spi_transaction[8]);
+    EXPECT_EQ(0x00, _spi_transaction[9]);
+    EXPECT_EQ(0x00, _spi_transaction[10]);
+    EXPECT_EQ(0x00, _spi_transaction[11]);
+    EXPECT_EQ(0x01, _spi_transaction[12]);
+    EXPECT_EQ(42u, _index);
+}
+
+TEST_F(MockSPITransfer, shiftOut$WHENCalledWithSeveralBytesTHENAllBytesAreShiftedInOneStream) {
+    const uint8_t DATA_PIN = 0;
+    const uint8_t CLOCK_PIN = 1;
+    const uint8_t BUFFER[] = { 0xFF, 0x00, 0xFF };
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    ResetSpi();
+    gpio_x.pinMode(DATA_PIN, mcp23s17::PinMode::OUTPUT);
+    ResetSpi();
+    gpio_x.pinMode(CLOCK_PIN, mcp23s17::PinMode::OUTPUT);
+
+    ResetSpi(57);
+    gpio_x.shiftOut(DATA_PIN, CLOCK_PIN, MSBFIRST, BUFFER, sizeof(BUFFER));
+    EXPECT_EQ(MOCK::PinTransition::NO_TRANSITION, MOCK::getPinTransition(SS)[6]);
+    EXPECT_EQ(0x03, _spi_transaction[20]);
+    EXPECT_EQ(0x00, _spi_transaction[21]);
+    EXPECT_EQ(0x02, _spi_transaction[36]);
+    EXPECT_EQ(0x01, _spi_transaction[37]);
+    EXPECT_EQ(57u, _index);
+}
+
+TEST_F(MockSPITransfer, shiftOut$WHENTheBytesExceedAChunkTHENTheClockIdlesBetweenTransactions) {
+    const uint8_t DATA_PIN = 0;
+    const uint8_t CLOCK_PIN = 1;
+    const uint8_t BUFFER[] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    ResetSpi();
+    gpio_x.pinMode(DATA_PIN, mcp23s17::PinMode::OUTPUT);
+    ResetSpi();
+    gpio_x.pinMode(CLOCK_PIN, mcp23s17::PinMode::OUTPUT);
+
+    // Four bytes (IOCON, stream header, 65 samples, IOCON), then one byte (IOCON, stream header, 17 samples, IOCON)
+    ResetSpi(128);
+    gpio_x.shiftOut(DATA_PIN, CLOCK_PIN, MSBFIRST, BUFFER, sizeof(BUFFER));
+    EXPECT_EQ(98u, _index);
+    EXPECT_EQ(0x01, _spi_transaction[69]);
+    EXPECT_EQ(0x0A, _spi_transaction[74]);
+    EXPECT_EQ(0x01, _spi_transaction[78]);
+    EXPECT_EQ(0x03, _spi_transaction[79]);
+    EXPECT_EQ(0x01, _spi_transaction[94]);
+}
+
+TEST_F(MockSPITransfer, shiftOut$WHENCalledTHENTheFinalLatchValuesAreCachedWithTheClockLOW) {
+    const uint8_t DATA_PIN = 3;
+    const uint8_t CLOCK_PIN = 4;
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    ResetSpi();
+    gpio_x.pinMode(DATA_PIN, mcp23s17::PinMode::OUTPUT);
+    ResetSpi();
+    gpio_x.pinMode(CLOCK_PIN, mcp23s17::PinMode::OUTPUT);
+
+    ResetSpi(25);
+    gpio_x.shiftOut(DATA_PIN, CLOCK_PIN, MSBFIRST, 0x01);
+    EXPECT_EQ((1 << DATA_PIN), gpio_x.getControlRegister()[static_cast<uint8_t>(mcp23s17::ControlRegister::GPIOA_)]);
+}
+
+  /*********************/
+ /* digitalWritePorts */
+/*********************/
+
+TEST_F(MockSPITransfer, digitalWritePorts$WHENAllPinsAreInInputModeTHENNoSPITransactionOccurs) {
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    ResetSpi();
+    gpio_x.digitalWritePorts(0xFFFF);
+    EXPECT_EQ(0, _index);
+}
+
+TEST_F(MockSPITransfer, digitalWritePorts$WHENOnlyPortAChangesTHENASingleRegisterIsWritten) {
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    for ( uint8_t pin = 0 ; pin < mcp23s17::PIN_COUNT ; ++pin ) {
+        ResetSpi();
+        gpio_x.pinMode(pin, mcp23s17::PinMode::OUTPUT);
+    }
+
+    ResetSpi(3);
+    gpio_x.digitalWritePorts(0x0081);
+    EXPECT_EQ((gpio_x.getSpiBusAddress() | static_cast<uint8_t>(mcp23s17::RegisterTransaction::WRITE)), _spi_transaction[0]);
+    EXPECT_EQ(mcp23s17::ControlRegister::GPIOA_, static_cast<mcp23s17::ControlRegister>(_spi_transaction[1]));
+    EXPECT_EQ(0x81, _spi_transaction[2]);
+    EXPECT_EQ(3u, _index);
+}
+
+TEST_F(MockSPITransfer, digitalWritePorts$WHENOnlyPortBChangesTHENASingleRegisterIsWritten) {
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    for ( uint8_t pin = 0 ; pin < mcp23s17::PIN_COUNT ; ++pin ) {
+        ResetSpi();
+        gpio_x.pinMode(pin, mcp23s17::PinMode::OUTPUT);
+    }
+
+    ResetSpi(3);
+    gpio_x.digitalWritePorts(0x8100);
+    EXPECT_EQ(mcp23s17::ControlRegister::GPIOB_, static_cast<mcp23s17::ControlRegister>(_spi_transaction[1]));
+    EXPECT_EQ(0x81, _spi_transaction[2]);
+    EXPECT_EQ(3u, _index);
+}
+
+TEST_F(MockSPITransfer, digitalWritePorts$WHENBothPortsChangeTHENBothRegistersAreWrittenInOneTransaction) {
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    for ( uint8_t pin = 0 ; pin < mcp23s17::PIN_COUNT ; ++pin ) {
+        ResetSpi();
+        gpio_x.pinMode(pin, mcp23s17::PinMode::OUTPUT);
+    }
+
+    ResetSpi(4);
+    gpio_x.digitalWritePorts(0x1881);
+    EXPECT_EQ(MOCK::PinTransition::HIGH_TO_LOW, MOCK::getPinTransition(SS)[0]);
+    EXPECT_EQ(MOCK::PinTransition::LOW_TO_HIGH, MOCK::getPinTransition(SS)[1]);
+    EXPECT_EQ(MOCK::PinTransition::NO_TRANSITION, MOCK::getPinTransition(SS)[2]);
+    EXPECT_EQ(mcp23s17::ControlRegister::GPIOA_, static_cast<mcp23s17::ControlRegister>(_spi_transaction[1]));
+    EXPECT_EQ(0x81, _spi_transaction[2]);
+    EXPECT_EQ(0x18, _spi_transaction[3]);
+    EXPECT_EQ(0x1881, gpio_x.getLatchValues());
+}
+
+TEST_F(MockSPITransfer, digitalWritePorts$WHENCalledWithAMaskTHENUnmaskedAndInputPinsAreNotDisturbed) {
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    for ( uint8_t pin = 0 ; pin < 8 ; ++pin ) {
+        ResetSpi();
+        gpio_x.pinMode(pin, mcp23s17::PinMode::OUTPUT);
+    }
+    ResetSpi();
+    gpio_x.digitalWrite(4, mcp23s17::PinLatchValue::HIGH);
+
+    ResetSpi(3);
+    gpio_x.digitalWritePorts(0xFF0F, 0xFF0F);
+    EXPECT_EQ(mcp23s17::ControlRegister::GPIOA_, static_cast<mcp23s17::ControlRegister>(_spi_transaction[1]));
+    EXPECT_EQ(0x1F, _spi_transaction[2]);
+    EXPECT_EQ(0x001F, gpio_x.getLatchValues());
+}
+
+  /********************/
+ /* digitalReadPorts */
+/********************/
+
+TEST_F(MockSPITransfer, digitalReadPorts$WHENCalledWithAnEmptyMaskTHENNoSPITransactionOccurs) {
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    ResetSpi();
+    EXPECT_EQ(0x0000, gpio_x.digitalReadPorts(0x0000));
+    EXPECT_EQ(0, _index);
+}
+
+TEST_F(MockSPITransfer, digitalReadPorts$WHENCalledForPortATHENASingleRegisterIsRead) {
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    ResetSpi(3);
+    _input_latch_port = 0x5A;
+    EXPECT_EQ(0x005A, gpio_x.digitalReadPorts(0x0001));
+    EXPECT_EQ((gpio_x.getSpiBusAddress() | static_cast<uint8_t>(mcp23s17::RegisterTransaction::READ)), _spi_transaction[0]);
+    EXPECT_EQ(mcp23s17::ControlRegister::GPIOA_, static_cast<mcp23s17::ControlRegister>(_spi_transaction[1]));
+    EXPECT_EQ(3u, _index);
+}
+
+TEST_F(MockSPITransfer, digitalReadPorts$WHENCalledForPortBTHENASingleRegisterIsRead) {
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    ResetSpi(3);
+    _input_latch_port = 0x5A;
+    EXPECT_EQ(0x5A00, gpio_x.digitalReadPorts(0x0100));
+    EXPECT_EQ(mcp23s17::ControlRegister::GPIOB_, static_cast<mcp23s17::ControlRegister>(_spi_transaction[1]));
+    EXPECT_EQ(3u, _index);
+}
+
+TEST_F(MockSPITransfer, digitalReadPorts$WHENCalledForBothPortsTHENBothRegistersAreReadInOneTransaction) {
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    ResetSpi(4);
+    _input_latch_port = 0x5A;
+    SPI._transfer = [&](uint8_t byte_){
+        _spi_transaction[_index] = byte_;
+        return (( 2 == _index++ ) ? static_cast<uint8_t>(0xA5) : _input_latch_port);
+    };
+    EXPECT_EQ(0x5AA5, gpio_x.digitalReadPorts());
+    EXPECT_EQ(MOCK::PinTransition::HIGH_TO_LOW, MOCK::getPinTransition(SS)[0]);
+    EXPECT_EQ(MOCK::PinTransition::LOW_TO_HIGH, MOCK::getPinTransition(SS)[1]);
+    EXPECT_EQ(MOCK::PinTransition::NO_TRANSITION, MOCK::getPinTransition(SS)[2]);
+    EXPECT_EQ(mcp23s17::ControlRegister::GPIOA_, static_cast<mcp23s17::ControlRegister>(_spi_transaction[1]));
+    EXPECT_EQ(4u, _index);
+}
+
+  /*********************/
+ /* serviceInterrupts */
+/*********************/
+
+TEST_F(MockSPITransfer, serviceInterrupts$WHENCalledTHENTheInterruptRegistersAndGPIOAreReadInOneTransaction) {
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    ResetSpi(8);
+    gpio_x.serviceInterrupts();
+    EXPECT_EQ(MOCK::PinTransition::HIGH_TO_LOW, MOCK::getPinTransition(SS)[0]);
+    EXPECT_EQ(MOCK::PinTransition::LOW_TO_HIGH, MOCK::getPinTransition(SS)[1]);
+    EXPECT_EQ(MOCK::PinTransition::NO_TRANSITION, MOCK::getPinTransition(SS)[2]);
+    EXPECT_EQ((gpio_x.getSpiBusAddress() | static_cast<uint8_t>(mcp23s17::RegisterTransaction::READ)), _spi_transaction[0]);
+    EXPECT_EQ(mcp23s17::ControlRegister::INTFA, static_cast<mcp23s17::ControlRegister>(_spi_transaction[1]));
+    EXPECT_EQ(8u, _index);
+}
+
+TEST_F(MockSPITransfer, serviceInterrupts$WHENCalledTHENTheSnapshotIsAssembledFromBothPorts) {
+    const uint8_t DATA[] = { 0x00, 0x00, 0x01, 0x80, 0x11, 0x22, 0x33, 0x44 };
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    ResetSpi(8);
+    SPI._transfer = [&](uint8_t byte_){
+        _spi_transaction[_index] = byte_;
+        return DATA[_index++];
+    };
+    const mcp23s17::InterruptSnapshot snapshot = gpio_x.serviceInterrupts();
+    EXPECT_EQ(0x8001, snapshot.flags);
+    EXPECT_EQ(0x2211, snapshot.capture);
+    EXPECT_EQ(0x4433, snapshot.levels);
+    EXPECT_EQ(0x8001, gpio_x.getInterruptSnapshot().flags);
+}
+
+TEST_F(MockSPITransfer, serviceInterrupts$WHENAPinIsFlaggedTHENOnlyItsCallbackIsInvoked) {
+    const uint8_t DATA[] = { 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00 };
+    static int flagged_count;
+    static int unflagged_count;
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    flagged_count = 0;
+    unflagged_count = 0;
+    ResetSpi();
+    gpio_x.attachInterrupt(10, [](){ ++flagged_count; }, mcp23s17::InterruptMode::CHANGE);
+    ResetSpi();
+    gpio_x.attachInterrupt(2, [](){ ++unflagged_count; }, mcp23s17::InterruptMode::CHANGE);
+
+    ResetSpi(8);
+    SPI._transfer = [&](uint8_t byte_){
+        _spi_transaction[_index] = byte_;
+        return DATA[_index++];
+    };
+    gpio_x.serviceInterrupts();
+    EXPECT_EQ(1, flagged_count);
+    EXPECT_EQ(0, unflagged_count);
+}
+
+  /***********/
+ /* unwatch */
+/***********/
+
+TEST_F(MockSPITransfer, unwatch$WHENCalledTHENOnlyTheWatchedPinsAreDisabled) {
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    ResetSpi();
+    gpio_x.watch(0x0000, 0x0F0F);
+    ResetSpi(3);
+    gpio_x.unwatch(0x000F);
+    EXPECT_EQ(mcp23s17::ControlRegister::GPINTENA, static_cast<mcp23s17::ControlRegister>(_spi_transaction[1]));
+    EXPECT_EQ(0x00, _spi_transaction[2]);
+    EXPECT_EQ(3u, _index);
+    EXPECT_EQ(0x0F, gpio_x.getControlRegister()[static_cast<uint8_t>(mcp23s17::ControlRegister::GPINTENB)]);
+}
+
+TEST_F(MockSPITransfer, unwatch$WHENThePinsAreNotWatchedTHENNoSPITransactionOccurs) {
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    ResetSpi();
+    gpio_x.unwatch(0xFFFF);
+    EXPECT_EQ(0u, _index);
+}
+
+  /*********/
+ /* watch */
+/*********/
+
+TEST_F(MockSPITransfer, watch$WHENCalledTHENTheInterruptRegistersAreWrittenInOneTransaction) {
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    ResetSpi(8);
+    gpio_x.watch(0x8421, 0xF00F);
+    EXPECT_EQ(MOCK::PinTransition::HIGH_TO_LOW, MOCK::getPinTransition(SS)[0]);
+    EXPECT_EQ(MOCK::PinTransition::LOW_TO_HIGH, MOCK::getPinTransition(SS)[1]);
+    EXPECT_EQ(MOCK::PinTransition::NO_TRANSITION, MOCK::getPinTransition(SS)[2]);
+    EXPECT_EQ((gpio_x.getSpiBusAddress() | static_cast<uint8_t>(mcp23s17::RegisterTransaction::WRITE)), _spi_transaction[0]);
+    EXPECT_EQ(mcp23s17::ControlRegister::GPINTENA, static_cast<mcp23s17::ControlRegister>(_spi_transaction[1]));
+    EXPECT_EQ(0x0F, _spi_transaction[2]);  // GPINTENA
+    EXPECT_EQ(0xF0, _spi_transaction[3]);  // GPINTENB
+    EXPECT_EQ(0x01, _spi_transaction[4]);  // DEFVALA
+    EXPECT_EQ(0x80, _spi_transaction[5]);  // DEFVALB
+    EXPECT_EQ(0x0F, _spi_transaction[6]);  // INTCONA
+    EXPECT_EQ(0xF0, _spi_transaction[7]);  // INTCONB
+    EXPECT_EQ(8u, _index);
+}
+
+TEST_F(MockSPITransfer, watch$WHENModeIsREACHTHENTheComplementOfThePatternIsLoaded) {
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    ResetSpi(8);
+    gpio_x.watch(0x8421, 0xF00F, mcp23s17::WatchMode::REACH);
+    EXPECT_EQ(0x0E, _spi_transaction[4]);  // DEFVALA
+    EXPECT_EQ(0x70, _spi_transaction[5]);  // DEFVALB
+}
+
+TEST_F(MockSPITransfer, watch$WHENOtherPinsHaveInterruptsAttachedTHENTheirConfigurationIsRetained) {
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    ResetSpi();
+    gpio_x.attachInterrupt(12, nullptr, mcp23s17::InterruptMode::CHANGE);
+    ResetSpi(8);
+    gpio_x.watch(0x0003, 0x0003);
+    EXPECT_EQ(0x03, _spi_transaction[2]);  // GPINTENA
+    EXPECT_EQ(0x10, _spi_transaction[3]);  // GPINTENB
+    EXPECT_EQ(0x03, _spi_transaction[6]);  // INTCONA
+    EXPECT_EQ(0x00, _spi_transaction[7]);  // INTCONB
+    EXPECT_EQ(0x03, gpio_x.getControlRegister()[static_cast<uint8_t>(mcp23s17::ControlRegister::DEFVALA)]);
+}
+
+TEST_F(MockSPITransfer, watch$WHENCalledWithAnEmptyMaskTHENNoSPITransactionOccurs) {
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    ResetSpi();
+    gpio_x.watch(0xFFFF, 0x0000);
+    EXPECT_EQ(0u, _index);
+}
+
+TEST(Watch, watch$WHENTheInputsLeaveThePatternTHENTheInterruptIsAsserted) {
+    MOCK::initMockState();
+    MOCK_mcp23s17 chip(6);
+    mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    chip.setInputs(0x0500);
+    gpio_x.watch(0x0500, 0x0F00);
+    chip.frames.clear();
+    chip.setInputs(0x05F0);
+    EXPECT_FALSE(chip.isInterruptAsserted());
+    EXPECT_EQ(0u, chip.frames.size());
+    chip.setInputs(0x0700);
+    EXPECT_TRUE(chip.isInterruptAsserted());
+    EXPECT_EQ(0x0200, gpio_x.serviceInterrupts().flags);
+}
+
+  /********************/
+ /* attachInterrupts */
+/********************/
+
+TEST_F(MockSPITransfer, attachInterrupts$WHENCalledWithAMaskTHENTheFinalImagesAreWrittenInOneTransaction) {
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    ResetSpi(8);
+    gpio_x.attachInterrupts(0xFFFF, nullptr, mcp23s17::InterruptMode::CHANGE);
+    EXPECT_EQ(MOCK::PinTransition::HIGH_TO_LOW, MOCK::getPinTransition(SS)[0]);
+    EXPECT_EQ(MOCK::PinTransition::LOW_TO_HIGH, MOCK::getPinTransition(SS)[1]);
+    EXPECT_EQ(MOCK::PinTransition::NO_TRANSITION, MOCK::getPinTransition(SS)[2]);
+    EXPECT_EQ(mcp23s17::ControlRegister::GPINTENA, static_cast<mcp23s17::ControlRegister>(_spi_transaction[1]));
+    EXPECT_EQ(0xFF, _spi_transaction[2]);  // GPINTENA
+    EXPECT_EQ(0xFF, _spi_transaction[3]);  // GPINTENB
+    EXPECT_EQ(0x00, _spi_transaction[6]);  // INTCONA
+    EXPECT_EQ(0x00, _spi_transaction[7]);  // INTCONB
+    EXPECT_EQ(8u, _index);
+}
+
+TEST_F(MockSPITransfer, attachInterrupts$WHENCalledWithAMaskTHENTheCallbackIsStoredForEachPin) {
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+    const mcp23s17::isr_t isr = [](){};
+
+    ResetSpi(8);
+    gpio_x.attachInterrupts(0x8001, isr, mcp23s17::InterruptMode::FALLING);
+    EXPECT_EQ(isr, gpio_x.getInterruptServiceRoutines()[0]);
+    EXPECT_EQ(nullptr, gpio_x.getInterruptServiceRoutines()[1]);
+    EXPECT_EQ(isr, gpio_x.getInterruptServiceRoutines()[15]);
+    EXPECT_EQ(0x01, _spi_transaction[6]);  // INTCONA
+    EXPECT_EQ(0x80, _spi_transaction[7]);  // INTCONB
+}
+
+TEST_F(MockSPITransfer, attachInterrupts$WHENConfiguredPerPinTHENEachPinReceivesItsOwnMode) {
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+    const mcp23s17::InterruptConfiguration configurations[] = {
+        { 1, nullptr, mcp23s17::InterruptMode::CHANGE },
+        { 2, nullptr, mcp23s17::InterruptMode::HIGH },
+        { 9, nullptr, mcp23s17::InterruptMode::LOW },
+        { 16, nullptr, mcp23s17::InterruptMode::HIGH },
+    };
+
+    ResetSpi(8);
+    gpio_x.attachInterrupts(configurations, (sizeof(configurations) / sizeof(configurations[0])));
+    EXPECT_EQ(0x06, _spi_transaction[2]);  // GPINTENA
+    EXPECT_EQ(0x02, _spi_transaction[3]);  // GPINTENB
+    EXPECT_EQ(0x04, _spi_transaction[4]);  // DEFVALA
+    EXPECT_EQ(0x00, _spi_transaction[5]);  // DEFVALB
+    EXPECT_EQ(0x04, _spi_transaction[6]);  // INTCONA
+    EXPECT_EQ(0x02, _spi_transaction[7]);  // INTCONB
+    EXPECT_EQ(8u, _index);
+}
+
+TEST_F(MockSPITransfer, attachInterrupts$WHENPinsAreAlreadyAttachedTHENTheirConfigurationIsRetained) {
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    ResetSpi();
+    gpio_x.attachInterrupt(12, nullptr, mcp23s17::InterruptMode::RISING);
+    ResetSpi(8);
+    gpio_x.attachInterrupts(0x0003, nullptr, mcp23s17::InterruptMode::CHANGE);
+    EXPECT_EQ(0x03, _spi_transaction[2]);  // GPINTENA
+    EXPECT_EQ(0x10, _spi_transaction[3]);  // GPINTENB
+    EXPECT_EQ(0x10, _spi_transaction[7]);  // INTCONB
+}
+
+TEST_F(MockSPITransfer, attachInterrupts$WHENNoPinIsValidTHENNoSPITransactionOccurs) {
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    ResetSpi();
+    gpio_x.attachInterrupts(0x0000, nullptr, mcp23s17::InterruptMode::CHANGE);
+    gpio_x.attachInterrupts(nullptr, 4);
+    EXPECT_EQ(0u, _index);
+}
+
+TEST_F(MockSPITransfer, attachInterrupts$WHENAConfigurationNamesAnOutOfRangePinTHENItIsIgnored) {
+    const mcp23s17::InterruptConfiguration CONFIGURATIONS[] = {
+        { 40, nullptr, mcp23s17::InterruptMode::CHANGE },
+        { 2, nullptr, mcp23s17::InterruptMode::CHANGE },
+    };
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    ResetSpi(8);
+    gpio_x.attachInterrupts(CONFIGURATIONS, 2);
+    EXPECT_EQ(0x04, _spi_transaction[2]);  // GPINTENA
+    EXPECT_EQ(0x00, _spi_transaction[3]);  // GPINTENB
+}
+
+  /********************/
+ /* detachInterrupts */
+/********************/
+
+TEST_F(MockSPITransfer, detachInterrupts$WHENCalledTHENTheCallbacksAreCleared) {
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    ResetSpi(8);
+    gpio_x.attachInterrupts(0x00FF, [](){}, mcp23s17::InterruptMode::CHANGE);
+    ResetSpi();
+    gpio_x.detachInterrupts(0x000F);
+    for ( uint8_t pin = 0 ; pin < 4 ; ++pin ) {
+        EXPECT_EQ(nullptr, gpio_x.getInterruptServiceRoutines()[pin]) << "Error at pin <" << static_cast<int>(pin) << ">!";
+    }
+    EXPECT_NE(nullptr, gpio_x.getInterruptServiceRoutines()[4]);
+}
+
+TEST_F(MockSPITransfer, detachInterrupts$WHENPinsSpanBothPortsTHENGPINTENIsWrittenInOneTransaction) {
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    ResetSpi(8);
+    gpio_x.attachInterrupts(0xFFFF, nullptr, mcp23s17::InterruptMode::CHANGE);
+    ResetSpi(4);
+    gpio_x.detachInterrupts(0x0FF0);
+    EXPECT_EQ(mcp23s17::ControlRegister::GPINTENA, static_cast<mcp23s17::ControlRegister>(_spi_transaction[1]));
+    EXPECT_EQ(0x0F, _spi_transaction[2]);
+    EXPECT_EQ(0xF0, _spi_transaction[3]);
+    EXPECT_EQ(4u, _index);
+}
+
+  /*******************/
+ /* detachInterrupt */
+/*******************/
+
+TEST_F(MockSPITransfer, detachInterrupt$WHENCalledTHENTheCallbackIsCleared) {
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    ResetSpi();
+    gpio_x.attachInterrupt(5, [](){}, mcp23s17::InterruptMode::CHANGE);
+    ResetSpi();
+    gpio_x.detachInterrupt(5);
+    EXPECT_EQ(nullptr, gpio_x.getInterruptServiceRoutines()[5]);
+}
+
+TEST_F(MockSPITransfer, detachInterrupt$WHENPinIsOnPortATHENOnlyGPINTENAIsWritten) {
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    ResetSpi(8);
+    gpio_x.attachInterrupts(0x0303, nullptr, mcp23s17::InterruptMode::CHANGE);
+    ResetSpi(3);
+    gpio_x.detachInterrupt(1);
+    EXPECT_EQ(MOCK::PinTransition::HIGH_TO_LOW, MOCK::getPinTransition(SS)[0]);
+    EXPECT_EQ(MOCK::PinTransition::LOW_TO_HIGH, MOCK::getPinTransition(SS)[1]);
+    EXPECT_EQ(MOCK::PinTransition::NO_TRANSITION, MOCK::getPinTransition(SS)[2]);
+    EXPECT_EQ((gpio_x.getSpiBusAddress() | static_cast<uint8_t>(mcp23s17::RegisterTransaction::WRITE)), _spi_transaction[0]);
+    EXPECT_EQ(mcp23s17::ControlRegister::GPINTENA, static_cast<mcp23s17::ControlRegister>(_spi_transaction[1]));
+    EXPECT_EQ(0x01, _spi_transaction[2]);
+    EXPECT_EQ(3u, _index);
+}
+
+TEST_F(MockSPITransfer, detachInterrupt$WHENPinIsOnPortBTHENOnlyGPINTENBIsWritten) {
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    ResetSpi(8);
+    gpio_x.attachInterrupts(0x0303, nullptr, mcp23s17::InterruptMode::CHANGE);
+    ResetSpi(3);
+    gpio_x.detachInterrupt(9);
+    EXPECT_EQ(mcp23s17::ControlRegister::GPINTENB, static_cast<mcp23s17::ControlRegister>(_spi_transaction[1]));
+    EXPECT_EQ(0x01, _spi_transaction[2]);
+    EXPECT_EQ(3u, _index);
+}
+
+TEST_F(MockSPITransfer, detachInterrupt$WHENCalledTHENINTCONAndDEFVALAreLeftUntouched) {
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    ResetSpi();
+    gpio_x.attachInterrupt(3, nullptr, mcp23s17::InterruptMode::HIGH);
+    ResetSpi(3);
+    gpio_x.detachInterrupt(3);
+    EXPECT_EQ(0x00, gpio_x.getControlRegister()[static_cast<uint8_t>(mcp23s17::ControlRegister::GPINTENA)]);
+    EXPECT_EQ(0x08, gpio_x.getControlRegister()[static_cast<uint8_t>(mcp23s17::ControlRegister::DEFVALA)]);
+    EXPECT_EQ(0x08, gpio_x.getControlRegister()[static_cast<uint8_t>(mcp23s17::ControlRegister::INTCONA)]);
+    EXPECT_EQ(3u, _index);
+}
+
+TEST_F(MockSPITransfer, detachInterrupt$WHENPinIsNotAttachedTHENNoSPITransactionOccurs) {
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    ResetSpi();
+    gpio_x.detachInterrupt(7);
+    gpio_x.detachInterrupt(mcp23s17::PIN_COUNT);
+    EXPECT_EQ(0u, _index);
+}
+
+TEST_F(MockSPITransfer, detachInterrupt$WHENReattachedTHENThePinInterruptsAgain) {
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    ResetSpi();
+    gpio_x.attachInterrupt(3, nullptr, mcp23s17::InterruptMode::CHANGE);
+    ResetSpi();
+    gpio_x.detachInterrupt(3);
+    ResetSpi();
+    gpio_x.attachInterrupt(3, nullptr, mcp23s17::InterruptMode::CHANGE);
+    EXPECT_EQ(0x08, gpio_x.getControlRegister()[static_cast<uint8_t>(mcp23s17::ControlRegister::GPINTENA)]);
+}
+
+  /************/
+ /* pinModes */
+/************/
+
+TEST_F(MockSPITransfer, pinModes$WHENAllPinsAreSetToOUTPUTTHENIODIRIsWrittenInOneTransaction) {
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    ResetSpi(4);
+    gpio_x.pinModes(0xFFFF, mcp23s17::PinMode::OUTPUT);
+    EXPECT_EQ(MOCK::PinTransition::HIGH_TO_LOW, MOCK::getPinTransition(SS)[0]);
+    EXPECT_EQ(MOCK::PinTransition::LOW_TO_HIGH, MOCK::getPinTransition(SS)[1]);
+    EXPECT_EQ(MOCK::PinTransition::NO_TRANSITION, MOCK::getPinTransition(SS)[2]);
+    EXPECT_EQ(mcp23s17::ControlRegister::IODIRA, static_cast<mcp23s17::ControlRegister>(_spi_transaction[1]));
+    EXPECT_EQ(0x00, _spi_transaction[2]);
+    EXPECT_EQ(0x00, _spi_transaction[3]);
+    EXPECT_EQ(4u, _index);
+}
+
+TEST_F(MockSPITransfer, pinModes$WHENAllPinsAreSetToINPUTPULLUPTHENOnlyGPPUIsWritten) {
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    ResetSpi(4);
+    gpio_x.pinModes(0xFFFF, mcp23s17::PinMode::INPUT_PULLUP);
+    EXPECT_EQ(mcp23s17::ControlRegister::GPPUA, static_cast<mcp23s17::ControlRegister>(_spi_transaction[1]));
+    EXPECT_EQ(0xFF, _spi_transaction[2]);
+    EXPECT_EQ(0xFF, _spi_transaction[3]);
+    EXPECT_EQ(4u, _index);
+}
+
+TEST_F(MockSPITransfer, pinModes$WHENBothRegistersChangeTHENAtMostTwoTransactionsOccur) {
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    ResetSpi(8);
+    gpio_x.pinModes(0xFFFF, mcp23s17::PinMode::OUTPUT);
+    ResetSpi(8);
+    gpio_x.pinModes(0x0F0F, mcp23s17::PinMode::INPUT_PULLUP);
+    EXPECT_EQ(MOCK::PinTransition::HIGH_TO_LOW, MOCK::getPinTransition(SS)[0]);
+    EXPECT_EQ(MOCK::PinTransition::LOW_TO_HIGH, MOCK::getPinTransition(SS)[1]);
+    EXPECT_EQ(MOCK::PinTransition::HIGH_TO_LOW, MOCK::getPinTransition(SS)[2]);
+    EXPECT_EQ(MOCK::PinTransition::LOW_TO_HIGH, MOCK::getPinTransition(SS)[3]);
+    EXPECT_EQ(MOCK::PinTransition::NO_TRANSITION, MOCK::getPinTransition(SS)[4]);
+    EXPECT_EQ(0x0F, gpio_x.getControlRegister()[static_cast<uint8_t>(mcp23s17::ControlRegister::IODIRA)]);
+    EXPECT_EQ(0x0F, gpio_x.getControlRegister()[static_cast<uint8_t>(mcp23s17::ControlRegister::IODIRB)]);
+    EXPECT_EQ(0x0F, gpio_x.getControlRegister()[static_cast<uint8_t>(mcp23s17::ControlRegister::GPPUA)]);
+    EXPECT_EQ(0x0F, gpio_x.getControlRegister()[static_cast<uint8_t>(mcp23s17::ControlRegister::GPPUB)]);
+    EXPECT_EQ(8u, _index);
+}
+
+TEST_F(MockSPITransfer, pinModes$WHENOnlyOnePortChangesTHENASingleRegisterIsWritten) {
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    ResetSpi(3);
+    gpio_x.pinModes(0x3000, mcp23s17::PinMode::OUTPUT);
+    EXPECT_EQ(mcp23s17::ControlRegister::IODIRB, static_cast<mcp23s17::ControlRegister>(_spi_transaction[1]));
+    EXPECT_EQ(0xCF, _spi_transaction[2]);
+    EXPECT_EQ(3u, _index);
+}
+
+TEST_F(MockSPITransfer, pinModes$WHENTheModesAreAlreadySetTHENNoSPITransactionOccurs) {
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    ResetSpi();
+    gpio_x.pinModes(0xFFFF, mcp23s17::PinMode::INPUT);
+    EXPECT_EQ(0u, _index);
+}
+
+TEST_F(MockSPITransfer, pinModes$WHENGivenAModeArrayTHENEachPinReceivesItsOwnMode) {
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+    const mcp23s17::PinMode modes[] = {
+        mcp23s17::PinMode::OUTPUT,
+        mcp23s17::PinMode::INPUT,
+        mcp23s17::PinMode::INPUT_PULLUP,
+        mcp23s17::PinMode::OUTPUT,
+        mcp23s17::PinMode::OUTPUT,
+        mcp23s17::PinMode::OUTPUT,
+        mcp23s17::PinMode::OUTPUT,
+        mcp23s17::PinMode::OUTPUT,
+        mcp23s17::PinMode::INPUT_PULLUP,
+    };
+
+    ResetSpi(8);
+    gpio_x.pinModes(modes, (sizeof(modes) / sizeof(modes[0])));
+    EXPECT_EQ(0x06, gpio_x.getControlRegister()[static_cast<uint8_t>(mcp23s17::ControlRegister::IODIRA)]);
+    EXPECT_EQ(0xFF, gpio_x.getControlRegister()[static_cast<uint8_t>(mcp23s17::ControlRegister::IODIRB)]);
+    EXPECT_EQ(0x04, gpio_x.getControlRegister()[static_cast<uint8_t>(mcp23s17::ControlRegister::GPPUA)]);
+    EXPECT_EQ(0x01, gpio_x.getControlRegister()[static_cast<uint8_t>(mcp23s17::ControlRegister::GPPUB)]);
+    EXPECT_EQ(7u, _index);
+}
+
+  /******************/
+ /* pinModesOutput */
+/******************/
+
+TEST_F(MockSPITransfer, pinModesOutput$WHENBothPortsChangeTHENLatchesPrecedeDirectionsInOneTransaction) {
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    ResetSpi(6);
+    gpio_x.pinModesOutput(0x0101, 0x0100);
+    EXPECT_EQ(MOCK::PinTransition::HIGH_TO_LOW, MOCK::getPinTransition(SS)[0]);
+    EXPECT_EQ(MOCK::PinTransition::LOW_TO_HIGH, MOCK::getPinTransition(SS)[1]);
+    EXPECT_EQ(MOCK::PinTransition::NO_TRANSITION, MOCK::getPinTransition(SS)[2]);
+    EXPECT_EQ((gpio_x.getSpiBusAddress() | static_cast<uint8_t>(mcp23s17::RegisterTransaction::WRITE)), _spi_transaction[0]);
+    EXPECT_EQ(mcp23s17::ControlRegister::OLATB, static_cast<mcp23s17::ControlRegister>(_spi_transaction[1]));
+    EXPECT_EQ(0x01, _spi_transaction[2]);  // OLATB
+    EXPECT_EQ(0xFE, _spi_transaction[3]);  // IODIRA
+    EXPECT_EQ(0xFE, _spi_transaction[4]);  // IODIRB
+    EXPECT_EQ(5u, _index);
+}
+
+TEST_F(MockSPITransfer, pinModesOutput$WHENEveryRegisterChangesTHENTheFrameBeginsAtOLATA) {
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    ResetSpi(6);
+    gpio_x.pinModesOutput(0xFFFF, 0x8001);
+    EXPECT_EQ(mcp23s17::ControlRegister::OLATA, static_cast<mcp23s17::ControlRegister>(_spi_transaction[1]));
+    EXPECT_EQ(0x01, _spi_transaction[2]);  // OLATA
+    EXPECT_EQ(0x80, _spi_transaction[3]);  // OLATB
+    EXPECT_EQ(0x00, _spi_transaction[4]);  // IODIRA
+    EXPECT_EQ(0x00, _spi_transaction[5]);  // IODIRB
+    EXPECT_EQ(6u, _index);
+    EXPECT_EQ(0x8001, gpio_x.getLatchValues());
+}
+
+TEST_F(MockSPITransfer, pinModesOutput$WHENTheLatchIsUnchangedTHENOnlyTheDirectionIsWritten) {
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    ResetSpi(3);
+    gpio_x.pinModeOutput(2, mcp23s17::PinLatchValue::LOW);
+    EXPECT_EQ(mcp23s17::ControlRegister::IODIRA, static_cast<mcp23s17::ControlRegister>(_spi_transaction[1]));
+    EXPECT_EQ(0xFB, _spi_transaction[2]);
+    EXPECT_EQ(3u, _index);
+}
+
+TEST_F(MockSPITransfer, pinModesOutput$WHENThePinIsAlreadyAnOutputTHENOnlyTheLatchIsWritten) {
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    ResetSpi();
+    gpio_x.pinMode(2, mcp23s17::PinMode::OUTPUT);
+    ResetSpi(3);
+    gpio_x.pinModeOutput(2, mcp23s17::PinLatchValue::HIGH);
+    EXPECT_EQ(mcp23s17::ControlRegister::OLATA, static_cast<mcp23s17::ControlRegister>(_spi_transaction[1]));
+    EXPECT_EQ(0x04, _spi_transaction[2]);
+    EXPECT_EQ(3u, _index);
+}
+
+TEST_F(MockSPITransfer, pinModesOutput$WHENNothingChangesTHENNoSPITransactionOccurs) {
+    TC_mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    ResetSpi(6);
+    gpio_x.pinModesOutput(0x00F0, 0x0030);
+    ResetSpi();
+    gpio_x.pinModesOutput(0x00F0, 0x0030);
+    gpio_x.pinModeOutput(mcp23s17::PIN_COUNT, mcp23s17::PinLatchValue::HIGH);
+    EXPECT_EQ(0u, _index);
+}
+
+TEST(PinModesOutput, pinModesOutput$WHENAPinBecomesAnOutputTHENItNeverDrivesAStaleValue) {
+    MOCK::initMockState();
+    MOCK_mcp23s17 chip(6);
+    mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    gpio_x.pinModesOutput(0x0300, 0x0200);
+    ASSERT_EQ(2u, chip.frames.size());
+    EXPECT_EQ(0xFC, chip.getRegister(MOCK_mcp23s17::IODIRB));
+    EXPECT_EQ(0x02, chip.getRegister(MOCK_mcp23s17::OLATB));
+    EXPECT_EQ(0xFF, chip.getRegister(MOCK_mcp23s17::IODIRA));
+    EXPECT_EQ(0x0200, chip.getOutputs());
+}
+
+  /*******************/
+ /* CriticalSection */
+/*******************/
+
+mcp23s17 * isr_gpio_x = nullptr;
+
+void
+driveOutputFromIsr (
+    void
+) {
+    isr_gpio_x->digitalWrite(0, mcp23s17::PinLatchValue::HIGH);
+}
+
+TEST(CriticalSection, digitalWrite$WHENCalledFromConcurrentThreadsTHENTheCacheAndTheChipAgree) {
+    MOCK::initMockState();
+    MOCK_mcp23s17 chip(6);
+    mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+    gpio_x.pinModes(0xFFFF, mcp23s17::PinMode::OUTPUT);
+
+    auto toggle = [&gpio_x](const uint8_t pin_){
+        for ( unsigned int i = 0 ; i < 500 ; ++i ) {
+            gpio_x.digitalWrite(pin_, mcp23s17::PinLatchValue::HIGH);
+            gpio_x.digitalWrite(pin_, mcp23s17::PinLatchValue::LOW);
+        }
+        gpio_x.digitalWrite(pin_, mcp23s17::PinLatchValue::HIGH);
+    };
+    std::thread first(toggle, 1);
+    std::thread second(toggle, 2);
+    std::thread third(toggle, 12);
+    first.join();
+    second.join();
+    third.join();
+
+    EXPECT_EQ(0x1006, gpio_x.getLatchValues());
+    EXPECT_EQ(0x1006, chip.getOutputs());
+}
+
+TEST(CriticalSection, serviceInterrupts$WHENACallbackDrivesTheSameDeviceTHENTheWriteReachesTheChip) {
+    MOCK::initMockState();
+    MOCK_mcp23s17 chip(6);
+    mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+    isr_gpio_x = &gpio_x;
+    gpio_x.pinMode(0, mcp23s17::PinMode::OUTPUT);
+    gpio_x.pinMode(8, mcp23s17::PinMode::INPUT);
+    gpio_x.attachInterrupt(8, driveOutputFromIsr, mcp23s17::InterruptMode::CHANGE);
+
+    chip.setInputs(0x0100);
+    EXPECT_EQ(0x0100, gpio_x.serviceInterrupts().flags);
+    EXPECT_EQ(0x0001, chip.getOutputs());
+    isr_gpio_x = nullptr;
+}
+
+TEST(CriticalSection, pinModes$WHENAThreadConfiguresPinsWhileAnotherDrivesOutputsTHENNoUpdateIsLost) {
+    MOCK::initMockState();
+    MOCK_mcp23s17 chip(6);
+    mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+    gpio_x.pinModes(0x00FF, mcp23s17::PinMode::OUTPUT);
+
+    std::thread configure([&gpio_x](){
+        for ( unsigned int i = 0 ; i < 500 ; ++i ) {
+            gpio_x.pinModes(0xFF00, mcp23s17::PinMode::INPUT_PULLUP);
+            gpio_x.pinModes(0xFF00, mcp23s17::PinMode::INPUT);
+        }
+    });
+    for ( unsigned int i = 0 ; i < 500 ; ++i ) {
+        gpio_x.digitalWritePorts(0x0055);
+        gpio_x.digitalWritePorts(0x00AA);
+    }
+    configure.join();
+
+    EXPECT_EQ(0x00AA, chip.getOutputs());
+    EXPECT_EQ(0xFF, chip.getRegister(MOCK_mcp23s17::IODIRB));
+    EXPECT_EQ(0x00, chip.getRegister(MOCK_mcp23s17::IODIRA));
+    EXPECT_EQ(0x00, chip.getRegister(MOCK_mcp23s17::GPPUB));
+}
+
+  /**************/
+ /* waitForAny */
+/**************/
+
+TEST(WaitForAny, waitForPin$WHENThePinIsAlreadyAtTheLevelTHENItReturnsWithoutWaiting) {
+    MOCK::initMockState();
+    MOCK_mcp23s17 chip(6);
+    mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    chip.setInputs(0x0008);
+    chip.frames.clear();
+    EXPECT_TRUE(gpio_x.waitForPin(3, mcp23s17::PinLatchValue::HIGH, 60000));
+
+    // Arm, sample and restore
+    EXPECT_EQ(3u, chip.frames.size());
+    EXPECT_EQ(0x00, chip.getRegister(MOCK_mcp23s17::GPINTENA));
+}
+
+TEST(WaitForAny, waitForPin$WHENTheTimeoutExpiresTHENFalseIsReturnedWithoutPollingTheBus) {
+    MOCK::initMockState();
+    MOCK_mcp23s17 chip(6);
+    mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+
+    chip.frames.clear();
+    const std::chrono::steady_clock::time_point start(std::chrono::steady_clock::now());
+    EXPECT_FALSE(gpio_x.waitForPin(3, mcp23s17::PinLatchValue::HIGH, 50));
+
+    EXPECT_GE((std::chrono::steady_clock::now() - start), std::chrono::milliseconds(50));
+    EXPECT_EQ(3u, chip.frames.size());
+}
+
+TEST(WaitForAny, waitForPin$WHENThePinIsAnOutputTHENFalseIsReturnedWithoutASPITransaction) {
+    MOCK::initMockState();
+    MOCK_mcp23s17 chip(6);
+    mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+    gpio_x.pinMode(3, mcp23s17::PinMode::OUTPUT);
+
+    chip.frames.clear();
+    EXPECT_FALSE(gpio_x.waitForPin(3, mcp23s17::PinLatchValue::HIGH, 60000));
+    EXPECT_EQ(0u, chip.frames.size());
+    EXPECT_FALSE(gpio_x.waitForPin(16, mcp23s17::PinLatchValue::HIGH, 60000));
+    EXPECT_FALSE(gpio_x.waitForPin(40, mcp23s17::PinLatchValue::HIGH, 60000));
+}
+
+TEST(WaitForAny, waitForPin$WHENTheInterruptIsServicedByAnotherThreadTHENTheCallerWakes) {
+    MOCK::initMockState();
+    MOCK_mcp23s17 chip(6);
+    spi_bus bus;
+    mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6, &bus);
+
+    chip.frames.clear();
+    // Stands in for the handler monitoring INT (the simulator is only touched while holding the bus)
+    std::thread dispatcher([&chip, &bus, &gpio_x](){
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        bus.acquire();
+        chip.setInputs(0x0400);
+        if ( chip.isInterruptAsserted() ) { gpio_x.serviceInterrupts(); }
+        bus.release();
+    });
+    const bool reached(gpio_x.waitForPin(10, mcp23s17::PinLatchValue::HIGH, 60000));
+    dispatcher.join();
+
+    EXPECT_TRUE(reached);
+    EXPECT_GE(4u, chip.frames.size());
+    EXPECT_EQ(0x00, chip.getRegister(MOCK_mcp23s17::GPINTENB));
+}
+
+TEST(WaitForAny, waitForAny$WHENALevelIsHeldBrieflyTHENItIsRecognizedFromTheCapture) {
+    MOCK::initMockState();
+    MOCK_mcp23s17 chip(6);
+    spi_bus bus;
+    mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6, &bus);
+
+    chip.setInputs(0x00FF);
+    std::thread dispatcher([&chip, &bus, &gpio_x](){
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        bus.acquire();
+        chip.setInputs(0x00FB);
+        chip.setInputs(0x00FF);
+        if ( chip.isInterruptAsserted() ) { gpio_x.serviceInterrupts(); }
+        bus.release();
+    });
+    const uint16_t matched(gpio_x.waitForAny(0x0006, 0x0000, 60000));
+    dispatcher.join();
+
+    EXPECT_EQ(0x0004, matched);
+}
+
+TEST(WaitForAny, waitForAny$WHENPinsHaveInterruptsAttachedTHENTheirConfigurationIsRestored) {
+    MOCK::initMockState();
+    MOCK_mcp23s17 chip(6);
+    mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_6);
+    gpio_x.attachInterrupt(1, nullptr, mcp23s17::InterruptMode::RISING);
+    gpio_x.attachInterrupt(9, nullptr, mcp23s17::InterruptMode::CHANGE);
+
+    EXPECT_EQ(0x0000, gpio_x.waitForAny(0x0202, 0x0202, 0));
+
+    EXPECT_EQ(0x02, chip.getRegister(MOCK_mcp23s17::GPINTENA));
+    EXPECT_EQ(0x02, chip.getRegister(MOCK_mcp23s17::GPINTENB));
+    EXPECT_EQ(0x00, chip.getRegister(MOCK_mcp23s17::DEFVALA));
+    EXPECT_EQ(0x02, chip.getRegister(MOCK_mcp23s17::INTCONA));
+    EXPECT_EQ(0x00, chip.getRegister(MOCK_mcp23s17::INTCONB));
+}
+
 } // namespace
 /*
 int main (int argc, char *argv[]) {
@@ -0,0 +1,222 @@
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+#include <chrono>
+#include <future>
+#include <thread>
+
+#include "../mcp23s17_async.h"
+#include "../thread_transport.h"
+#include "MOCK_mcp23s17.h"
+#include "MOCK_wiring.h"
+
+namespace {
+
+/// \brief Holds every frame until released, like a busy DMA channel
+class MOCK_deferred_transport : public spi_transport {
+  public:
+    std::vector<Frame *> queue;
+    bool accept = true;
+
+    bool
+    submit (
+        Frame & frame_
+    ) override {
+        if ( !accept ) { return false; }
+        queue.push_back(&frame_);
+        return true;
+    }
+
+    void
+    release (
+        void
+    ) {
+        std::vector<Frame *> frames;
+        frames.swap(queue);
+        for ( Frame * frame : frames ) {
+            exchange(*frame);
+            complete(*frame);
+        }
+    }
+};
+
+class MockAsync : public ::testing::Test {
+  protected:
+    MOCK_mcp23s17 * _chip;
+
+    MockAsync (
+        void
+    ) :
+        _chip(nullptr)
+    {}
+
+    void SetUp (void) {
+        MOCK::initMockState();
+        _chip = new MOCK_mcp23s17(2);
+    }
+    void TearDown (void) {
+        delete _chip;
+    }
+};
+
+TEST_F(MockAsync, digitalWritePortsAsync$WHENTheTransportIsBusyTHENTheCallerDoesNotWaitOnTheBus) {
+    MOCK_deferred_transport transport;
+    mcp23s17_async gpio_x(mcp23s17::HardwareAddress::HW_ADDR_2, transport);
+    mcp23s17_async::Operation operation;
+    gpio_x.pinModes(0xFFFF, mcp23s17::PinMode::OUTPUT);
+
+    _chip->frames.clear();
+    EXPECT_TRUE(gpio_x.digitalWritePortsAsync(operation, 0x1234));
+    EXPECT_FALSE(operation.isComplete());
+    EXPECT_EQ(0u, _chip->frames.size());
+    EXPECT_EQ(0x1234, gpio_x.getLatchValues());
+
+    transport.release();
+    EXPECT_TRUE(operation.isComplete());
+    EXPECT_EQ(0x1234, _chip->getOutputs());
+}
+
+TEST_F(MockAsync, digitalWritePortsAsync$WHENTheOperationIsInFlightTHENItCannotBeReissued) {
+    MOCK_deferred_transport transport;
+    mcp23s17_async gpio_x(mcp23s17::HardwareAddress::HW_ADDR_2, transport);
+    mcp23s17_async::Operation operation;
+    gpio_x.pinModes(0xFFFF, mcp23s17::PinMode::OUTPUT);
+
+    EXPECT_TRUE(gpio_x.digitalWritePortsAsync(operation, 0x0001));
+    EXPECT_FALSE(gpio_x.digitalWritePortsAsync(operation, 0x0002));
+    transport.release();
+    EXPECT_EQ(0x0001, _chip->getOutputs());
+}
+
+TEST_F(MockAsync, digitalWritePortsAsync$WHENSeveralOperationsAreQueuedTHENEachBuildsOnThePrevious) {
+    MOCK_deferred_transport transport;
+    mcp23s17_async gpio_x(mcp23s17::HardwareAddress::HW_ADDR_2, transport);
+    mcp23s17_async::Operation operations[3];
+    gpio_x.pinModes(0xFFFF, mcp23s17::PinMode::OUTPUT);
+
+    gpio_x.digitalWriteAsync(operations[0], 0, mcp23s17::PinLatchValue::HIGH);
+    gpio_x.digitalWriteAsync(operations[1], 9, mcp23s17::PinLatchValue::HIGH);
+    gpio_x.digitalWriteAsync(operations[2], 0, mcp23s17::PinLatchValue::LOW);
+    transport.release();
+    EXPECT_EQ(0x0200, _chip->getOutputs());
+}
+
+TEST_F(MockAsync, digitalWritePortsAsync$WHENNothingChangesTHENTheOperationCompletesWithoutAFrame) {
+    static int callback_count;
+    MOCK_deferred_transport transport;
+    mcp23s17_async gpio_x(mcp23s17::HardwareAddress::HW_ADDR_2, transport);
+    mcp23s17_async::Operation operation;
+
+    callback_count = 0;
+    EXPECT_TRUE(gpio_x.digitalWritePortsAsync(operation, 0x0000, 0xFFFF, [](mcp23s17_async::Operation &, void *){ ++callback_count; }));
+    EXPECT_TRUE(operation.isComplete());
+    EXPECT_EQ(1, callback_count);
+    EXPECT_EQ(0u, transport.queue.size());
+}
+
+TEST_F(MockAsync, digitalWritePortsAsync$WHENTheTransportRefusesTheFrameTHENTheCacheIsRolledBack) {
+    MOCK_deferred_transport transport;
+    mcp23s17_async gpio_x(mcp23s17::HardwareAddress::HW_ADDR_2, transport);
+    mcp23s17_async::Operation operation;
+    gpio_x.pinModes(0xFFFF, mcp23s17::PinMode::OUTPUT);
+    gpio_x.digitalWritePorts(0x00F0);
+
+    transport.accept = false;
+    EXPECT_FALSE(gpio_x.digitalWritePortsAsync(operation, 0xFF00));
+    EXPECT_TRUE(operation.isComplete());
+    EXPECT_EQ(0x00F0, gpio_x.getLatchValues());
+
+    // The refused write no longer blocks the next one
+    transport.accept = true;
+    EXPECT_TRUE(gpio_x.digitalWritePortsAsync(operation, 0xFF00));
+    EXPECT_EQ(0xFF00, gpio_x.getLatchValues());
+}
+
+TEST_F(MockAsync, digitalWritePortsAsync$WHENTheTransportCompletesInlineTHENTheCallbackRunsOutsideTheCriticalSection) {
+    struct Context {
+        mcp23s17_async * gpio_x;
+        bool device_available;
+        std::future<void> probe;
+    };
+    blocking_transport transport;
+    mcp23s17_async gpio_x(mcp23s17::HardwareAddress::HW_ADDR_2, transport);
+    mcp23s17_async::Operation operation;
+    Context context{ &gpio_x, false, std::future<void>() };
+    gpio_x.pinModes(0xFFFF, mcp23s17::PinMode::OUTPUT);
+
+    EXPECT_TRUE(gpio_x.digitalWritePortsAsync(operation, 0x00FF, 0xFFFF, [](mcp23s17_async::Operation &, void * context_){
+        Context & context(*static_cast<Context *>(context_));
+
+        // Another thread can only use the device while it is not held
+        context.probe = std::async(std::launch::async, [&context](){ context.gpio_x->digitalReadPorts(0x0001); });
+        context.device_available = (std::future_status::ready == context.probe.wait_for(std::chrono::seconds(1)));
+    }, &context));
+    context.probe.wait();
+    EXPECT_TRUE(context.device_available);
+    EXPECT_EQ(0x00FF, _chip->getOutputs());
+}
+
+TEST_F(MockAsync, digitalReadPortsAsync$WHENCompleteTHENTheCallbackReceivesThePortValues) {
+    static uint16_t port_values;
+    blocking_transport transport;
+    mcp23s17_async gpio_x(mcp23s17::HardwareAddress::HW_ADDR_2, transport);
+    mcp23s17_async::Operation operation;
+
+    port_values = 0;
+    _chip->setInputs(0xBEEF);
+    EXPECT_TRUE(gpio_x.digitalReadPortsAsync(operation, 0xFFFF, [](mcp23s17_async::Operation & operation_, void *){ port_values = operation_.getPortValues(); }));
+    EXPECT_TRUE(operation.isComplete());
+    EXPECT_EQ(0xBEEF, port_values);
+}
+
+TEST_F(MockAsync, serviceInterruptsAsync$WHENCompleteTHENTheSnapshotIsAvailable) {
+    MOCK_deferred_transport transport;
+    mcp23s17_async gpio_x(mcp23s17::HardwareAddress::HW_ADDR_2, transport);
+    mcp23s17_async::Operation operation;
+    gpio_x.attachInterrupts(0x0101, nullptr, mcp23s17::InterruptMode::CHANGE);
+
+    _chip->setInputs(0x0100);
+    EXPECT_TRUE(gpio_x.serviceInterruptsAsync(operation));
+    transport.release();
+    EXPECT_EQ(0x0100, operation.getInterruptSnapshot().flags);
+    EXPECT_EQ(0x0100, gpio_x.getInterruptSnapshot().levels);
+    EXPECT_FALSE(_chip->isInterruptAsserted());
+}
+
+TEST_F(MockAsync, thread_transport$WHENOperationsAreSubmittedTHENTheyCompleteInOrderOnTheWorker) {
+    thread_transport transport;
+    mcp23s17_async gpio_x(mcp23s17::HardwareAddress::HW_ADDR_2, transport);
+    mcp23s17_async::Operation operations[8];
+    gpio_x.pinModes(0x00FF, mcp23s17::PinMode::OUTPUT);
+
+    for ( uint8_t i = 0 ; i < 8 ; ++i ) {
+        EXPECT_TRUE(gpio_x.digitalWritePortsAsync(operations[i], (1 << i), 0x00FF));
+    }
+    transport.flush();
+    for ( uint8_t i = 0 ; i < 8 ; ++i ) {
+        EXPECT_TRUE(operations[i].isComplete()) << "Error at operation <" << static_cast<int>(i) << ">!";
+    }
+    EXPECT_EQ(0x0080, _chip->getOutputs());
+}
+
+TEST_F(MockAsync, thread_transport$WHENBlockingAndAsynchronousWritesAreMixedTHENTheChipFollowsTheCache) {
+    thread_transport transport;
+    mcp23s17_async gpio_x(mcp23s17::HardwareAddress::HW_ADDR_2, transport);
+    mcp23s17_async::Operation operation;
+    gpio_x.pinModes(0x00FF, mcp23s17::PinMode::OUTPUT);
+
+    for ( unsigned int i = 0 ; i < 256 ; ++i ) {
+        ASSERT_TRUE(gpio_x.digitalWritePortsAsync(operation, (i & 0x01), 0x0001));
+        gpio_x.digitalWrite(1, (( i & 0x02 ) ? mcp23s17::PinLatchValue::HIGH : mcp23s17::PinLatchValue::LOW));
+
+        // Once the operation completes, nothing is left in flight
+        while ( !operation.isComplete() ) { std::this_thread::yield(); }
+        ASSERT_EQ(gpio_x.getLatchValues(), _chip->getOutputs()) << "Diverged at <" << i << ">!";
+    }
+}
+
+} // namespace
+
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
@@ -0,0 +1,212 @@
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+#include "../mcp23s17_coroutine.h"
+#include "MOCK_mcp23s17.h"
+#include "MOCK_wiring.h"
+
+#if !defined(__cpp_impl_coroutine)
+#error "gtest_mcp23s17_coroutine requires C++20 coroutines (make selects -std=c++20 for UNDER_TEST=mcp23s17_coroutine)"
+#endif
+
+#if defined(MCP23S17_HOST) && defined(__cpp_impl_coroutine)
+
+namespace {
+
+/// \brief Holds every frame until released, like a busy DMA channel
+class MOCK_deferred_transport : public spi_transport {
+  public:
+    std::vector<Frame *> queue;
+
+    bool
+    submit (
+        Frame & frame_
+    ) override {
+        queue.push_back(&frame_);
+        return true;
+    }
+
+    void
+    release (
+        void
+    ) {
+        std::vector<Frame *> frames;
+        frames.swap(queue);
+        for ( Frame * frame : frames ) {
+            exchange(*frame);
+            complete(*frame);
+        }
+    }
+};
+
+coroutine_task
+readPorts (
+    mcp23s17_coroutine & gpio_,
+    uint16_t & result_,
+    bool & done_
+) {
+    result_ = co_await gpio_.digitalReadPorts();
+    done_ = true;
+}
+
+coroutine_task
+toggle (
+    mcp23s17_coroutine & gpio_,
+    const uint8_t pin_,
+    unsigned int & count_
+) {
+    for ( unsigned int i = 0 ; i < 3 ; ++i ) {
+        co_await gpio_.digitalWrite(pin_, mcp23s17::PinLatchValue::HIGH);
+        co_await gpio_.digitalWrite(pin_, mcp23s17::PinLatchValue::LOW);
+        ++count_;
+    }
+}
+
+coroutine_task
+serviceOnSignal (
+    mcp23s17_coroutine & gpio_,
+    interrupt_signal & signal_,
+    mcp23s17::InterruptSnapshot & snapshot_,
+    bool & done_
+) {
+    co_await signal_.wait();
+    snapshot_ = co_await gpio_.serviceInterrupts();
+    done_ = true;
+}
+
+coroutine_task
+waitForSignal (
+    interrupt_signal & signal_,
+    bool & done_
+) {
+    co_await signal_.wait();
+    done_ = true;
+}
+
+class MockCoroutine : public ::testing::Test {
+  protected:
+    MOCK_mcp23s17 * _chip;
+
+    MockCoroutine (
+        void
+    ) :
+        _chip(nullptr)
+    {}
+
+    void SetUp (void) {
+        MOCK::initMockState();
+        _chip = new MOCK_mcp23s17(2);
+    }
+    void TearDown (void) {
+        delete _chip;
+    }
+};
+
+TEST_F(MockCoroutine, digitalReadPorts$WHENTheFrameIsInFlightTHENTheCoroutineIsSuspendedUntilItCompletes) {
+    MOCK_deferred_transport transport;
+    mcp23s17_async gpio_x(mcp23s17::HardwareAddress::HW_ADDR_2, transport);
+    mcp23s17_coroutine gpio(gpio_x);
+    uint16_t result(0x0000);
+    bool done(false);
+
+    _chip->setInputs(0xA55A);
+    readPorts(gpio, result, done);
+    EXPECT_FALSE(done);
+    EXPECT_EQ(1u, transport.queue.size());
+
+    transport.release();
+    EXPECT_TRUE(done);
+    EXPECT_EQ(0xA55A, result);
+}
+
+TEST_F(MockCoroutine, digitalReadPorts$WHENTheTransportCompletesImmediatelyTHENTheCoroutineDoesNotSuspend) {
+    blocking_transport transport;
+    mcp23s17_async gpio_x(mcp23s17::HardwareAddress::HW_ADDR_2, transport);
+    mcp23s17_coroutine gpio(gpio_x);
+    uint16_t result(0x0000);
+    bool done(false);
+
+    _chip->setInputs(0x1234);
+    readPorts(gpio, result, done);
+    EXPECT_TRUE(done);
+    EXPECT_EQ(0x1234, result);
+}
+
+TEST_F(MockCoroutine, digitalWrite$WHENAwaitedInALoopTHENEachWriteReachesTheChipInOrder) {
+    MOCK_deferred_transport transport;
+    mcp23s17_async gpio_x(mcp23s17::HardwareAddress::HW_ADDR_2, transport);
+    mcp23s17_coroutine gpio(gpio_x);
+    unsigned int count(0);
+    gpio_x.pinModes(0xFFFF, mcp23s17::PinMode::OUTPUT);
+
+    toggle(gpio, 9, count);
+    for ( unsigned int i = 0 ; i < 6 ; ++i ) {
+        EXPECT_EQ(1u, transport.queue.size());
+        _chip->frames.clear();
+        transport.release();
+        ASSERT_EQ(1u, _chip->frames.size());
+        EXPECT_EQ((( i % 2 ) ? 0x00 : 0x02), _chip->frames[0].back());
+    }
+    EXPECT_EQ(3u, count);
+    EXPECT_TRUE(transport.queue.empty());
+}
+
+TEST_F(MockCoroutine, digitalReadPorts$WHENASchedulerIsGivenTHENTheCoroutineResumesOnlyWhenTheSchedulerIsPolled) {
+    MOCK_deferred_transport transport;
+    mcp23s17_async gpio_x(mcp23s17::HardwareAddress::HW_ADDR_2, transport);
+    coroutine_scheduler scheduler;
+    mcp23s17_coroutine gpio(gpio_x, &scheduler);
+    uint16_t result(0x0000);
+    bool done(false);
+
+    _chip->setInputs(0x00FF);
+    readPorts(gpio, result, done);
+    transport.release();
+    EXPECT_FALSE(done);
+
+    EXPECT_EQ(1u, scheduler.poll());
+    EXPECT_TRUE(done);
+    EXPECT_EQ(0x00FF, result);
+}
+
+TEST_F(MockCoroutine, serviceInterrupts$WHENTheSignalIsNotifiedTHENTheCoroutineResolvesTheSnapshot) {
+    blocking_transport transport;
+    mcp23s17_async gpio_x(mcp23s17::HardwareAddress::HW_ADDR_2, transport);
+    mcp23s17_coroutine gpio(gpio_x);
+    interrupt_signal signal;
+    mcp23s17::InterruptSnapshot snapshot{ 0, 0, 0 };
+    bool done(false);
+    gpio_x.pinModes(0x0010, mcp23s17::PinMode::INPUT);
+    gpio_x.watch(0x0000, 0x0010);
+
+    serviceOnSignal(gpio, signal, snapshot, done);
+    EXPECT_FALSE(done);
+
+    _chip->setInputs(0x0010);
+    signal.notify();
+    EXPECT_TRUE(done);
+    EXPECT_EQ(0x0010, snapshot.flags);
+}
+
+TEST_F(MockCoroutine, wait$WHENTheSignalWasNotifiedBeforeTheWaitTHENTheNotificationIsNotLost) {
+    interrupt_signal signal;
+    bool first(false);
+    bool second(false);
+
+    signal.notify();
+    waitForSignal(signal, first);
+    EXPECT_TRUE(first);
+
+    waitForSignal(signal, second);
+    EXPECT_FALSE(second);
+    signal.notify();
+    EXPECT_TRUE(second);
+}
+
+} // namespace
+
+#endif // MCP23S17_HOST && __cpp_impl_coroutine
+
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
@@ -0,0 +1,200 @@
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+#include "../pin_event_source.h"
+#include "MOCK_mcp23s17.h"
+#include "MOCK_wiring.h"
+
+#if defined(MCP23S17_HOST) && defined(__linux__)
+
+#include <poll.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+namespace {
+
+unsigned long now_us = 0;
+
+unsigned long
+testClock (
+    void
+) {
+    return now_us;
+}
+
+bool
+isReadable (
+    const int fd_
+) {
+    struct pollfd descriptor{ fd_, POLLIN, 0 };
+    return (1 == ::poll(&descriptor, 1, 0) && (descriptor.revents & POLLIN));
+}
+
+class PinEventSource : public ::testing::Test {
+  protected:
+    void SetUp (void) {
+        now_us = 1000;
+    }
+};
+
+TEST_F(PinEventSource, update$WHENCalledForTheFirstTimeTHENTheLevelsAreTheBaseline) {
+    pin_event_source source(0xFFFF, 0, testClock);
+    pin_event_source::Event events[4];
+
+    source.update(static_cast<uint16_t>(0x00F0));
+
+    EXPECT_FALSE(isReadable(source.getFd()));
+    EXPECT_EQ(0u, source.read(events, 4));
+}
+
+TEST_F(PinEventSource, update$WHENAPinChangesTHENTheDescriptorIsReadableUntilTheEventIsRead) {
+    pin_event_source source(0xFFFF, 0, testClock);
+    pin_event_source::Event events[4];
+
+    source.update(static_cast<uint16_t>(0x0000));
+    now_us = 1500;
+    source.update(static_cast<uint16_t>(0x0200));
+
+    ASSERT_GE(source.getFd(), 0);
+    EXPECT_TRUE(isReadable(source.getFd()));
+    ASSERT_EQ(1u, source.read(events, 4));
+    EXPECT_EQ(9, events[0].pin);
+    EXPECT_EQ(1, events[0].level);
+    EXPECT_EQ(1500u, events[0].timestamp_us);
+    EXPECT_FALSE(isReadable(source.getFd()));
+}
+
+TEST_F(PinEventSource, read$WHENManyEventsArePendingTHENTheyAreCollectedInBatchesOldestFirst) {
+    pin_event_source source(0xFFFF, 0, testClock);
+    pin_event_source::Event events[3];
+
+    source.update(static_cast<uint16_t>(0x0000));
+    source.update(static_cast<uint16_t>(0x001F));
+
+    ASSERT_EQ(3u, source.read(events, 3));
+    EXPECT_EQ(0, events[0].pin);
+    EXPECT_EQ(2, events[2].pin);
+    EXPECT_TRUE(isReadable(source.getFd()));
+    ASSERT_EQ(2u, source.read(events, 3));
+    EXPECT_EQ(4, events[1].pin);
+    EXPECT_FALSE(isReadable(source.getFd()));
+}
+
+TEST_F(PinEventSource, update$WHENAPinIsNotWatchedTHENItsChangesAreIgnored) {
+    pin_event_source source(0x00FF, 0, testClock);
+    pin_event_source::Event events[4];
+
+    source.update(static_cast<uint16_t>(0x0000));
+    source.update(static_cast<uint16_t>(0xFF00));
+
+    EXPECT_EQ(0u, source.read(events, 4));
+}
+
+TEST_F(PinEventSource, update$WHENAPinBouncesWithinTheDebouncePeriodTHENOnlyTheFirstChangeIsReported) {
+    pin_event_source source(0xFFFF, 5000, testClock);
+    pin_event_source::Event events[4];
+
+    source.update(static_cast<uint16_t>(0x0000));
+    source.update(static_cast<uint16_t>(0x0001));
+    now_us += 100;
+    source.update(static_cast<uint16_t>(0x0000));
+    now_us += 100;
+    source.update(static_cast<uint16_t>(0x0001));
+
+    EXPECT_EQ(1u, source.read(events, 4));
+    EXPECT_EQ(-1, source.getTimeoutMs());
+}
+
+TEST_F(PinEventSource, getTimeoutMs$WHENAChangeIsHeldOffTHENTheNextSampleReportsItOnceThePeriodElapses) {
+    pin_event_source source(0xFFFF, 5000, testClock);
+    pin_event_source::Event events[4];
+
+    source.update(static_cast<uint16_t>(0x0000));
+    source.update(static_cast<uint16_t>(0x0001));
+    ASSERT_EQ(1u, source.read(events, 4));
+    now_us += 1500;
+    source.update(static_cast<uint16_t>(0x0000));
+
+    EXPECT_EQ(0u, source.read(events, 4));
+    EXPECT_EQ(4, source.getTimeoutMs());
+
+    now_us += 3500;
+    EXPECT_EQ(0, source.getTimeoutMs());
+    source.update(static_cast<uint16_t>(0x0000));
+    ASSERT_EQ(1u, source.read(events, 4));
+    EXPECT_EQ(0, events[0].level);
+    EXPECT_EQ(-1, source.getTimeoutMs());
+}
+
+TEST_F(PinEventSource, update$WHENTheSnapshotShowsAPinThatChangedBackTHENBothChangesAreReported) {
+    pin_event_source source(0xFFFF, 0, testClock);
+    pin_event_source::Event events[4];
+
+    source.update(static_cast<uint16_t>(0x0000));
+    source.update(mcp23s17::InterruptSnapshot{ 0x0010, 0x0010, 0x0000 });
+
+    ASSERT_EQ(2u, source.read(events, 4));
+    EXPECT_EQ(1, events[0].level);
+    EXPECT_EQ(0, events[1].level);
+}
+
+TEST_F(PinEventSource, update$WHENTheFirstInputIsASnapshotTHENItsLevelsAreTheBaseline) {
+    pin_event_source source(0xFFFF, 0, testClock);
+    pin_event_source::Event events[4];
+
+    source.update(mcp23s17::InterruptSnapshot{ 0x0010, 0x0010, 0x0001 });
+    source.update(static_cast<uint16_t>(0x0001));
+
+    EXPECT_FALSE(isReadable(source.getFd()));
+    EXPECT_EQ(0u, source.read(events, 4));
+}
+
+TEST_F(PinEventSource, update$WHENTheQueueIsFullTHENNewEventsAreDroppedAndCounted) {
+    pin_event_source source(0xFFFF, 0, testClock);
+    pin_event_source::Event events[pin_event_source::CAPACITY];
+    const size_t capacity(pin_event_source::CAPACITY);
+
+    source.update(static_cast<uint16_t>(0x0000));
+    for ( size_t i = 0 ; i < (capacity + 2) ; ++i ) {
+        source.update(static_cast<uint16_t>(( i % 2 ) ? 0x0000 : 0x0001));
+    }
+
+    EXPECT_EQ(2u, source.getDroppedCount());
+    EXPECT_EQ(capacity, source.read(events, capacity));
+}
+
+TEST_F(PinEventSource, getFd$WHENRegisteredWithEpollTHENInterruptsFromTheChipWakeTheLoop) {
+    MOCK::initMockState();
+    MOCK_mcp23s17 chip(2);
+    mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_2);
+    pin_event_source source(0x00FF, 0, testClock);
+    pin_event_source::Event events[8];
+    struct epoll_event ready;
+    struct epoll_event registration;
+    const int epoll_fd(::epoll_create1(EPOLL_CLOEXEC));
+    registration.events = EPOLLIN;
+    registration.data.fd = source.getFd();
+    ASSERT_EQ(0, ::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, source.getFd(), &registration));
+
+    gpio_x.attachInterrupts(0x00FF, nullptr, mcp23s17::InterruptMode::CHANGE);
+    source.update(gpio_x.digitalReadPorts());
+    EXPECT_EQ(0, ::epoll_wait(epoll_fd, &ready, 1, 0));
+
+    chip.setInputs(0x0042);
+    ASSERT_TRUE(chip.isInterruptAsserted());
+    source.update(gpio_x.serviceInterrupts());
+    ASSERT_EQ(1, ::epoll_wait(epoll_fd, &ready, 1, 0));
+    EXPECT_EQ(source.getFd(), ready.data.fd);
+    EXPECT_EQ(2u, source.read(events, 8));
+    EXPECT_EQ(0, ::epoll_wait(epoll_fd, &ready, 1, 0));
+
+    ::close(epoll_fd);
+}
+
+} // namespace
+
+#endif // MCP23S17_HOST && __linux__
+
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
@@ -0,0 +1,109 @@
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+#include "../pin_group.h"
+#include "MOCK_mcp23s17.h"
+#include "MOCK_wiring.h"
+
+namespace {
+
+class MockPinGroup : public ::testing::Test {
+  protected:
+    MOCK_mcp23s17 * _chip;
+    mcp23s17 * _gpio_x;
+
+    MockPinGroup (
+        void
+    ) :
+        _chip(nullptr),
+        _gpio_x(nullptr)
+    {}
+
+    void SetUp (void) {
+        MOCK::initMockState();
+        _chip = new MOCK_mcp23s17(0);
+        _gpio_x = new mcp23s17(mcp23s17::HardwareAddress::HW_ADDR_0);
+    }
+    void TearDown (void) {
+        delete _gpio_x;
+        delete _chip;
+    }
+};
+
+TEST_F(MockPinGroup, pin_group$WHENConstructedTHENInvalidAndRepeatedPinsAreIgnored) {
+    const uint8_t PINS[] = { 4, 5, 4, 16, 6 };
+    pin_group group(*_gpio_x, PINS, (sizeof(PINS) / sizeof(PINS[0])));
+
+    EXPECT_EQ(3, group.getWidth());
+    EXPECT_EQ(0x0070, group.getPinMask());
+}
+
+TEST_F(MockPinGroup, pinMode$WHENCalledTHENEveryPinOfTheGroupIsConfigured) {
+    const uint8_t PINS[] = { 6, 7, 8, 9 };
+    pin_group group(*_gpio_x, PINS, (sizeof(PINS) / sizeof(PINS[0])));
+
+    group.pinMode(mcp23s17::PinMode::OUTPUT);
+    EXPECT_EQ(0x3F, _chip->getRegister(MOCK_mcp23s17::IODIRA));
+    EXPECT_EQ(0xFC, _chip->getRegister(MOCK_mcp23s17::IODIRB));
+}
+
+TEST_F(MockPinGroup, write$WHENTheGroupSpansBothPortsTHENTheValueIsWrittenInOneTransaction) {
+    const uint8_t PINS[] = { 6, 7, 8, 9 };
+    pin_group group(*_gpio_x, PINS, (sizeof(PINS) / sizeof(PINS[0])));
+    group.pinMode(mcp23s17::PinMode::OUTPUT);
+
+    _chip->frames.clear();
+    group.write(0x0A);
+    ASSERT_EQ(1u, _chip->frames.size());
+    EXPECT_EQ(4u, _chip->frames[0].size());
+    EXPECT_EQ(0x0280, _chip->getOutputs());
+}
+
+TEST_F(MockPinGroup, write$WHENThePinsAreOutOfOrderTHENEachBitReachesItsPin) {
+    const uint8_t PINS[] = { 3, 2, 1, 0, 15, 8 };
+    pin_group group(*_gpio_x, PINS, (sizeof(PINS) / sizeof(PINS[0])));
+    group.pinMode(mcp23s17::PinMode::OUTPUT);
+
+    group.write(0x31);  // 0b110001
+    EXPECT_EQ(0x8108, _chip->getOutputs());
+    group.write(0x0E);  // 0b001110
+    EXPECT_EQ(0x0007, _chip->getOutputs());
+}
+
+TEST_F(MockPinGroup, write$WHENOtherPinsAreOutputsTHENTheirLatchesAreRetained) {
+    const uint8_t PINS[] = { 0, 1, 2, 3 };
+    pin_group group(*_gpio_x, PINS, (sizeof(PINS) / sizeof(PINS[0])));
+    _gpio_x->pinModes(0x00FF, mcp23s17::PinMode::OUTPUT);
+    _gpio_x->digitalWrite(7, mcp23s17::PinLatchValue::HIGH);
+
+    group.write(0xF5);
+    EXPECT_EQ(0x0085, _chip->getOutputs());
+}
+
+TEST_F(MockPinGroup, write$WHENTheValueIsUnchangedTHENNoSPITransactionOccurs) {
+    const uint8_t PINS[] = { 0, 1, 2, 3 };
+    pin_group group(*_gpio_x, PINS, (sizeof(PINS) / sizeof(PINS[0])));
+    group.pinMode(mcp23s17::PinMode::OUTPUT);
+    group.write(0x05);
+
+    _chip->frames.clear();
+    group.write(0x05);
+    EXPECT_EQ(0u, _chip->frames.size());
+}
+
+TEST_F(MockPinGroup, read$WHENCalledTHENTheFieldIsGatheredFromASingleTransaction) {
+    const uint8_t PINS[] = { 14, 15, 0, 1, 2, 3 };
+    pin_group group(*_gpio_x, PINS, (sizeof(PINS) / sizeof(PINS[0])));
+
+    _chip->setInputs(0x800D);
+    _chip->frames.clear();
+    EXPECT_EQ(0x36, group.read());  // 0b110110
+    ASSERT_EQ(1u, _chip->frames.size());
+    EXPECT_EQ(4u, _chip->frames[0].size());
+}
+
+} // namespace
+
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
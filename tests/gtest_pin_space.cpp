@@ -0,0 +1,146 @@
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+#include "../pin_space.h"
+#include "MOCK_mcp23s17.h"
+#include "MOCK_wiring.h"
+
+namespace {
+
+class MockPinSpace : public ::testing::Test {
+  protected:
+    MOCK_mcp23s17 * _chip[pin_space::DEVICE_COUNT];
+    mcp23s17 * _gpio_x[pin_space::DEVICE_COUNT];
+
+    MockPinSpace (
+        void
+    ) :
+        _chip{ nullptr },
+        _gpio_x{ nullptr }
+    {}
+
+    // Every block of 16 pins is populated, except block 5
+    void SetUp (void) {
+        MOCK::initMockState();
+        for ( uint8_t device = 0 ; device < pin_space::DEVICE_COUNT ; ++device ) {
+            if ( 5 == device ) { continue; }
+            _chip[device] = new MOCK_mcp23s17(device);
+        }
+        for ( uint8_t device = 0 ; device < pin_space::DEVICE_COUNT ; ++device ) {
+            if ( 5 == device ) { continue; }
+            _gpio_x[device] = new mcp23s17(static_cast<mcp23s17::HardwareAddress>(device));
+        }
+    }
+    void TearDown (void) {
+        for ( uint8_t device = 0 ; device < pin_space::DEVICE_COUNT ; ++device ) {
+            delete _gpio_x[device];
+            delete _chip[device];
+        }
+    }
+
+    void ClearFrames (void) {
+        for ( MOCK_mcp23s17 * chip : _chip ) { if ( chip ) { chip->frames.clear(); } }
+    }
+    size_t FrameCount (void) {
+        size_t count(0);
+        for ( MOCK_mcp23s17 * chip : _chip ) { if ( chip ) { count += chip->frames.size(); } }
+        return count;
+    }
+};
+
+TEST_F(MockPinSpace, pinMode$WHENCalledTHENThePinOfTheOwningDeviceIsConfigured) {
+    pin_space pins(_gpio_x, pin_space::DEVICE_COUNT);
+
+    pins.pinMode(((3 * 16) + 9), mcp23s17::PinMode::OUTPUT);
+    EXPECT_EQ(0xFD, _chip[3]->getRegister(MOCK_mcp23s17::IODIRB));
+    EXPECT_EQ(0xFF, _chip[2]->getRegister(MOCK_mcp23s17::IODIRB));
+}
+
+TEST_F(MockPinSpace, digitalWrite$WHENCalledTHENThePinOfTheOwningDeviceIsDriven) {
+    pin_space pins(_gpio_x, pin_space::DEVICE_COUNT);
+    pins.pinMode(127, mcp23s17::PinMode::OUTPUT);
+
+    pins.digitalWrite(127, mcp23s17::PinLatchValue::HIGH);
+    EXPECT_EQ(0x8000, _chip[7]->getOutputs());
+    EXPECT_TRUE(pins.getLatchImage().test(127));
+}
+
+TEST_F(MockPinSpace, digitalRead$WHENCalledTHENThePinOfTheOwningDeviceIsRead) {
+    pin_space pins(_gpio_x, pin_space::DEVICE_COUNT);
+
+    _chip[4]->setInputs(0x0004);
+    EXPECT_EQ(mcp23s17::PinLatchValue::HIGH, pins.digitalRead((4 * 16) + 2));
+    EXPECT_EQ(mcp23s17::PinLatchValue::LOW, pins.digitalRead((4 * 16) + 3));
+    EXPECT_EQ(mcp23s17::PinLatchValue::LOW, pins.digitalRead((5 * 16) + 2));
+}
+
+TEST_F(MockPinSpace, write$WHENASinglePortChangesTHENOnlyThatPortIsSent) {
+    pin_space pins(_gpio_x, pin_space::DEVICE_COUNT);
+    pin_space::PinImage image = { { 0 } };
+    for ( uint8_t pin = 0 ; pin < pin_space::PIN_COUNT ; ++pin ) { pins.pinMode(pin, mcp23s17::PinMode::OUTPUT); }
+
+    ClearFrames();
+    image.set((6 * 16) + 12);
+    pins.write(image);
+    ASSERT_EQ(1u, FrameCount());
+    ASSERT_EQ(1u, _chip[6]->frames.size());
+    EXPECT_EQ(3u, _chip[6]->frames[0].size());
+    EXPECT_EQ(0x1000, _chip[6]->getOutputs());
+}
+
+TEST_F(MockPinSpace, write$WHENSeveralDevicesChangeTHENEachChangedDeviceReceivesOneTransaction) {
+    pin_space pins(_gpio_x, pin_space::DEVICE_COUNT);
+    pin_space::PinImage image = { { 0 } };
+    for ( uint8_t pin = 0 ; pin < pin_space::PIN_COUNT ; ++pin ) { pins.pinMode(pin, mcp23s17::PinMode::OUTPUT); }
+
+    ClearFrames();
+    image.set(0);
+    image.set(15);
+    image.set((1 * 16) + 3);
+    image.set((7 * 16) + 8);
+    image.set((5 * 16) + 1);  // Absent device
+    pins.write(image);
+    EXPECT_EQ(3u, FrameCount());
+    EXPECT_EQ(0x8001, _chip[0]->getOutputs());
+    EXPECT_EQ(0x0008, _chip[1]->getOutputs());
+    EXPECT_EQ(0x0100, _chip[7]->getOutputs());
+}
+
+TEST_F(MockPinSpace, write$WHENTheImageIsUnchangedTHENNoSPITransactionOccurs) {
+    pin_space pins(_gpio_x, pin_space::DEVICE_COUNT);
+    pin_space::PinImage image = { { 0xFFFFFFFF, 0x00000000, 0x12345678, 0x9ABCDEF0 } };
+    for ( uint8_t pin = 0 ; pin < pin_space::PIN_COUNT ; ++pin ) { pins.pinMode(pin, mcp23s17::PinMode::OUTPUT); }
+    pins.write(image);
+
+    ClearFrames();
+    pins.write(image);
+    EXPECT_EQ(0u, FrameCount());
+}
+
+TEST_F(MockPinSpace, write$WHENPinsAreInputsTHENTheyAreIgnored) {
+    pin_space pins(_gpio_x, pin_space::DEVICE_COUNT);
+    pin_space::PinImage image = { { 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF } };
+
+    ClearFrames();
+    pins.write(image);
+    EXPECT_EQ(0u, FrameCount());
+}
+
+TEST_F(MockPinSpace, read$WHENCalledTHENEveryDeviceIsReadInOneTransaction) {
+    pin_space pins(_gpio_x, pin_space::DEVICE_COUNT);
+
+    _chip[0]->setInputs(0xA5A5);
+    _chip[3]->setInputs(0x0180);
+    ClearFrames();
+    const pin_space::PinImage image = pins.read();
+    EXPECT_EQ(7u, FrameCount());
+    EXPECT_EQ(0x0000A5A5u, image.word[0]);
+    EXPECT_EQ(0x01800000u, image.word[1]);
+    EXPECT_EQ(0u, image.word[2]);
+}
+
+} // namespace
+
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
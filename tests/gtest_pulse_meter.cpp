@@ -0,0 +1,169 @@
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+#include "../pulse_meter.h"
+#include "MOCK_mcp23s17.h"
+#include "MOCK_wiring.h"
+
+namespace {
+
+unsigned long clock_ticks(0);
+
+unsigned long
+mockClock (
+    void
+) {
+    return clock_ticks;
+}
+
+class MockPulses : public ::testing::Test {
+  protected:
+    MOCK_mcp23s17 * _chip;
+    mcp23s17 * _gpio_x;
+
+    MockPulses (
+        void
+    ) :
+        _chip(nullptr),
+        _gpio_x(nullptr)
+    {}
+
+    void SetUp (void) {
+        MOCK::initMockState();
+        clock_ticks = 0;
+        _chip = new MOCK_mcp23s17(0);
+        _gpio_x = new mcp23s17(mcp23s17::HardwareAddress::HW_ADDR_0);
+    }
+    void TearDown (void) {
+        delete _gpio_x;
+        delete _chip;
+    }
+
+    // Drive a square wave on a pin, servicing after each edge
+    void Pulse (pulse_meter & meter_, uint8_t pin_, unsigned long high_, unsigned long low_, int count_) {
+        for ( int i = 0 ; i < count_ ; ++i ) {
+            _chip->setInputs(_chip->getPins() | (1 << pin_));
+            meter_.service();
+            clock_ticks += high_;
+            _chip->setInputs(_chip->getPins() & ~(1 << pin_));
+            meter_.service();
+            clock_ticks += low_;
+        }
+    }
+};
+
+TEST_F(MockPulses, attach$WHENCalledTHENThePinInterruptsOnChange) {
+    pulse_meter meter(*_gpio_x, mockClock);
+
+    EXPECT_TRUE(meter.attach(10, mcp23s17::PinMode::INPUT_PULLUP));
+    EXPECT_EQ(0x04, _chip->getRegister(MOCK_mcp23s17::GPPUB));
+    EXPECT_EQ(0x04, _chip->getRegister(MOCK_mcp23s17::GPINTENB));
+    EXPECT_EQ(0x00, _chip->getRegister(MOCK_mcp23s17::INTCONB));
+}
+
+TEST_F(MockPulses, attach$WHENTheModeIsNotAnInputTHENFalseIsReturned) {
+    pulse_meter meter(*_gpio_x, mockClock);
+
+    EXPECT_FALSE(meter.attach(3, mcp23s17::PinMode::OUTPUT));
+    EXPECT_FALSE(meter.attach(mcp23s17::PIN_COUNT));
+}
+
+TEST_F(MockPulses, service$WHENPulsesArriveTHENEdgesPeriodAndPulseWidthAreMeasured) {
+    pulse_meter meter(*_gpio_x, mockClock);
+    meter.attach(3);
+
+    Pulse(meter, 3, 300, 700, 4);
+    EXPECT_EQ(8u, meter.getEdgeCount(3));
+    EXPECT_EQ(1000u, meter.getPeriod(3));
+    EXPECT_EQ(300u, meter.getPulseWidth(3));
+    EXPECT_FLOAT_EQ(1000.0f, meter.getFrequency(3));
+}
+
+TEST_F(MockPulses, service$WHENThePeriodChangesTHENTheFrequencyIsAMovingAverage) {
+    pulse_meter meter(*_gpio_x, mockClock);
+    meter.attach(3);
+
+    Pulse(meter, 3, 500, 500, (pulse_meter::AVERAGE_LENGTH + 1));
+    Pulse(meter, 3, 1000, 1000, (pulse_meter::AVERAGE_LENGTH / 2));
+    EXPECT_EQ(2000u, meter.getPeriod(3));
+    EXPECT_EQ(((5 * 1000u) + (3 * 2000u)) / pulse_meter::AVERAGE_LENGTH, meter.getAveragePeriod(3));
+}
+
+TEST_F(MockPulses, service$WHENSeveralPinsPulseTHENEachPinIsMeasuredIndependently) {
+    pulse_meter meter(*_gpio_x, mockClock);
+    meter.attach(1);
+    meter.attach(12);
+
+    Pulse(meter, 1, 100, 100, 3);
+    Pulse(meter, 12, 250, 250, 2);
+    EXPECT_EQ(6u, meter.getEdgeCount(1));
+    EXPECT_EQ(200u, meter.getPeriod(1));
+    EXPECT_EQ(4u, meter.getEdgeCount(12));
+    EXPECT_EQ(500u, meter.getPeriod(12));
+}
+
+TEST_F(MockPulses, service$WHENTwoEdgesOccurBeforeServiceTHENBothAreCountedButNotTimed) {
+    pulse_meter meter(*_gpio_x, mockClock);
+    meter.attach(3);
+    Pulse(meter, 3, 300, 700, 2);
+
+    _chip->setInputs(0x0008);
+    _chip->setInputs(0x0000);
+    meter.service();
+    EXPECT_EQ(6u, meter.getEdgeCount(3));
+    EXPECT_EQ(300u, meter.getPulseWidth(3));
+}
+
+TEST_F(MockPulses, service$WHENAPinChangesAfterAnotherPinOfItsPortLatchedINTCAPTHENTheEdgeIsTimed) {
+    pulse_meter meter(*_gpio_x, mockClock);
+    meter.attach(3);
+    meter.attach(5);
+    Pulse(meter, 5, 300, 700, 1);
+
+    // Pin 3 latches INTCAP, then pin 5 rises before service
+    _chip->setInputs(0x0008);
+    _chip->setInputs(0x0028);
+    meter.service();
+    EXPECT_EQ(1u, meter.getEdgeCount(3));
+    EXPECT_EQ(3u, meter.getEdgeCount(5));
+    EXPECT_EQ(1000u, meter.getPeriod(5));
+}
+
+TEST_F(MockPulses, attach$WHENAnotherPinOfThePortComparesAgainstDEFVALTHENItsConfigurationIsKept) {
+    pulse_meter meter(*_gpio_x, mockClock);
+    _gpio_x->pinMode(4, mcp23s17::PinMode::INPUT);
+    _gpio_x->attachInterrupt(4, nullptr, mcp23s17::InterruptMode::HIGH);
+
+    meter.attach(3);
+    EXPECT_EQ(0x18, _chip->getRegister(MOCK_mcp23s17::GPINTENA));
+    EXPECT_EQ(0x10, _chip->getRegister(MOCK_mcp23s17::DEFVALA));
+    EXPECT_EQ(0x10, _chip->getRegister(MOCK_mcp23s17::INTCONA));
+}
+
+TEST_F(MockPulses, detach$WHENCalledTHENThePinIsNoLongerMeasured) {
+    pulse_meter meter(*_gpio_x, mockClock);
+    meter.attach(3);
+    Pulse(meter, 3, 300, 700, 1);
+
+    meter.detach(3);
+    EXPECT_EQ(0x00, _chip->getRegister(MOCK_mcp23s17::GPINTENA));
+    Pulse(meter, 3, 300, 700, 1);
+    EXPECT_EQ(2u, meter.getEdgeCount(3));
+}
+
+TEST_F(MockPulses, reset$WHENCalledTHENTheMeasurementsAreCleared) {
+    pulse_meter meter(*_gpio_x, mockClock);
+    meter.attach(3);
+    Pulse(meter, 3, 300, 700, 2);
+
+    meter.reset(3);
+    EXPECT_EQ(0u, meter.getEdgeCount(3));
+    EXPECT_EQ(0u, meter.getPeriod(3));
+    EXPECT_FLOAT_EQ(0.0f, meter.getFrequency(3));
+}
+
+} // namespace
+
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
@@ -0,0 +1,138 @@
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+#include "../quadrature_decoder.h"
+#include "MOCK_mcp23s17.h"
+#include "MOCK_wiring.h"
+
+namespace {
+
+// Gray code sequence of channel A (bit 0) and channel B (bit 1)
+const uint16_t SEQUENCE[4] = { 0x00, 0x01, 0x03, 0x02 };
+
+class MockEncoder : public ::testing::Test {
+  protected:
+    MOCK_mcp23s17 * _chip;
+    mcp23s17 * _gpio_x;
+    unsigned long _micros;
+
+    MockEncoder (
+        void
+    ) :
+        _chip(nullptr),
+        _gpio_x(nullptr),
+        _micros(0)
+    {}
+
+    void SetUp (void) {
+        MOCK::initMockState();
+        MOCK::setMicros([&](){ return _micros; });
+        _chip = new MOCK_mcp23s17(0);
+        _gpio_x = new mcp23s17(mcp23s17::HardwareAddress::HW_ADDR_0);
+    }
+    void TearDown (void) {
+        delete _gpio_x;
+        delete _chip;
+    }
+
+    // Encoder 0 on pins 0/1, encoder 1 on pins 8/9
+    void Turn (quadrature_decoder & decoder_, int steps_, int encoder_ = 0) {
+        const unsigned int shift(8 * encoder_);
+        for ( int i = 0 ; i < (steps_ < 0 ? -steps_ : steps_) ; ++i ) {
+            const uint16_t state((_chip->getPins() >> shift) & 0x03);
+            int index(0);
+            while ( SEQUENCE[index] != state ) { ++index; }
+            index = ((index + (steps_ < 0 ? 3 : 1)) % 4);
+            _chip->setInputs((_chip->getPins() & ~(0x03 << shift)) | (SEQUENCE[index] << shift));
+            decoder_.service();
+        }
+    }
+};
+
+TEST_F(MockEncoder, attach$WHENCalledTHENPinsArePulledUpWithInterruptOnChange) {
+    quadrature_decoder decoder(*_gpio_x);
+
+    EXPECT_TRUE(decoder.attach(0, 0, 1));
+    EXPECT_EQ(0x03, _chip->getRegister(MOCK_mcp23s17::GPPUA));
+    EXPECT_EQ(0x03, _chip->getRegister(MOCK_mcp23s17::GPINTENA));
+    EXPECT_EQ(0x00, _chip->getRegister(MOCK_mcp23s17::INTCONA));
+}
+
+TEST_F(MockEncoder, attach$WHENTheEncoderIndexIsOutOfRangeTHENFalseIsReturned) {
+    quadrature_decoder decoder(*_gpio_x);
+
+    EXPECT_FALSE(decoder.attach(quadrature_decoder::MAX_ENCODERS, 0, 1));
+    EXPECT_FALSE(decoder.attach(0, 3, 3));
+}
+
+TEST_F(MockEncoder, service$WHENTurnedClockwiseTHENTheCountIncreases) {
+    quadrature_decoder decoder(*_gpio_x);
+    decoder.attach(0, 0, 1);
+
+    Turn(decoder, 10);
+    EXPECT_EQ(10, decoder.getCount(0));
+    EXPECT_EQ(0u, decoder.getSkipCount(0));
+}
+
+TEST_F(MockEncoder, service$WHENTurnedCounterClockwiseTHENTheCountDecreases) {
+    quadrature_decoder decoder(*_gpio_x);
+    decoder.attach(0, 0, 1);
+
+    Turn(decoder, -7);
+    EXPECT_EQ(-7, decoder.getCount(0));
+}
+
+TEST_F(MockEncoder, service$WHENCalledTHENASingleTransactionUpdatesEveryEncoder) {
+    quadrature_decoder decoder(*_gpio_x);
+    decoder.attach(0, 0, 1);
+    decoder.attach(1, 8, 9);
+
+    _chip->setInputs(SEQUENCE[1] | (SEQUENCE[3] << 8));
+    _chip->frames.clear();
+    decoder.service();
+    EXPECT_EQ(1u, _chip->frames.size());
+    EXPECT_EQ(1, decoder.getCount(0));
+    EXPECT_EQ(-1, decoder.getCount(1));
+    EXPECT_FALSE(_chip->isInterruptAsserted());
+}
+
+TEST_F(MockEncoder, service$WHENTwoEdgesOccurBeforeServiceTHENBothAreCounted) {
+    quadrature_decoder decoder(*_gpio_x);
+    decoder.attach(0, 0, 1);
+
+    // INTCAP holds the first edge, GPIO holds the second
+    _chip->setInputs(SEQUENCE[1]);
+    _chip->setInputs(SEQUENCE[2]);
+    decoder.service();
+    EXPECT_EQ(2, decoder.getCount(0));
+    EXPECT_EQ(0u, decoder.getSkipCount(0));
+}
+
+TEST_F(MockEncoder, service$WHENBothChannelsChangeTHENASkipIsCounted) {
+    quadrature_decoder decoder(*_gpio_x);
+    decoder.attach(0, 0, 1);
+
+    // Both channels change while the interrupt is masked by a pending flag
+    _chip->setInputs(SEQUENCE[1]);
+    _chip->setInputs(SEQUENCE[2]);
+    _chip->setInputs(SEQUENCE[3]);
+    decoder.service();
+    EXPECT_EQ(1u, decoder.getSkipCount(0));
+}
+
+TEST_F(MockEncoder, getRate$WHENTheRateWindowElapsesTHENCountsPerSecondAreReported) {
+    quadrature_decoder decoder(*_gpio_x);
+    decoder.attach(0, 0, 1);
+    decoder.service();
+
+    Turn(decoder, 50);
+    _micros = quadrature_decoder::RATE_WINDOW_US;
+    decoder.service();
+    EXPECT_EQ(500, decoder.getRate(0));
+}
+
+} // namespace
+
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
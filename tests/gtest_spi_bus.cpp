@@ -0,0 +1,195 @@
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "../mcp23s17_async.h"
+#include "../spi_bus.h"
+#include "../thread_transport.h"
+#include "MOCK_mcp23s17.h"
+#include "MOCK_wiring.h"
+
+namespace {
+
+class MockBus : public ::testing::Test {
+  protected:
+    MOCK_mcp23s17 * _chip_a;
+    MOCK_mcp23s17 * _chip_b;
+
+    MockBus (
+        void
+    ) :
+        _chip_a(nullptr),
+        _chip_b(nullptr)
+    {}
+
+    void SetUp (void) {
+        MOCK::initMockState();
+        _chip_a = new MOCK_mcp23s17(1);
+        _chip_b = new MOCK_mcp23s17(2);
+    }
+    void TearDown (void) {
+        delete _chip_b;
+        delete _chip_a;
+    }
+
+    /// \brief Every frame addressed to the chip is a complete GPIO write
+    /// (a single port, or both ports beginning at GPIOA)
+    void
+    expectWellFormedWrites (
+        const MOCK_mcp23s17 & chip_,
+        const size_t first_frame_
+    ) {
+        for ( size_t i = first_frame_ ; i < chip_.frames.size() ; ++i ) {
+            const std::vector<uint8_t> & frame(chip_.frames[i]);
+            if ( 4u == frame.size() ) {
+                EXPECT_EQ(static_cast<uint8_t>(MOCK_mcp23s17::GPIOA_), frame[1]) << "frame " << i;
+            } else {
+                ASSERT_EQ(3u, frame.size()) << "frame " << i;
+                EXPECT_TRUE(static_cast<uint8_t>(MOCK_mcp23s17::GPIOA_) == frame[1] || static_cast<uint8_t>(MOCK_mcp23s17::GPIOB_) == frame[1]) << "frame " << i;
+            }
+        }
+    }
+};
+
+TEST(SpiBus, acquire$WHENUncontendedTHENTheAcquisitionIsCountedWithoutContention) {
+    spi_bus bus;
+
+    bus.acquire();
+    bus.release();
+
+    const spi_bus::Statistics statistics(bus.getStatistics());
+    EXPECT_EQ(1u, statistics.acquisitions);
+    EXPECT_EQ(0u, statistics.contentions);
+    EXPECT_EQ(0u, statistics.wait_time_ns);
+}
+
+TEST(SpiBus, acquire$WHENTheOwnerAcquiresAgainTHENItDoesNotDeadlockAndIsCountedOnce) {
+    spi_bus bus;
+
+    bus.acquire();
+    bus.acquire();
+    bus.release();
+    bus.release();
+
+    EXPECT_EQ(1u, bus.getStatistics().acquisitions);
+}
+
+TEST(SpiBus, acquire$WHENAnotherThreadHoldsTheBusTHENTheWaitAndHoldTimesAreRecorded) {
+    spi_bus bus;
+
+    bus.acquire();
+    std::thread waiter([&bus](){
+        bus.acquire();
+        bus.release();
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    bus.release();
+    waiter.join();
+
+    const spi_bus::Statistics statistics(bus.getStatistics());
+    EXPECT_EQ(2u, statistics.acquisitions);
+    EXPECT_EQ(1u, statistics.contentions);
+    EXPECT_LT(0u, statistics.wait_time_ns);
+    EXPECT_LE(20000000u, statistics.max_hold_time_ns);
+    EXPECT_LE(statistics.max_hold_time_ns, statistics.hold_time_ns);
+}
+
+TEST(SpiBus, acquire$WHENThreadsQueueForTheBusTHENTheyAreServedInArrivalOrder) {
+    spi_bus bus;
+    std::vector<int> order;
+
+    bus.acquire();
+    std::thread first([&bus, &order](){
+        bus.acquire();
+        order.push_back(1);
+        bus.release();
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    std::thread second([&bus, &order](){
+        bus.acquire();
+        order.push_back(2);
+        bus.release();
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    bus.release();
+    first.join();
+    second.join();
+
+    ASSERT_EQ(2u, order.size());
+    EXPECT_EQ(1, order[0]);
+    EXPECT_EQ(2, order[1]);
+}
+
+TEST(SpiBus, resetStatistics$WHENCalledTHENEveryStatisticIsCleared) {
+    spi_bus bus;
+
+    bus.acquire();
+    bus.release();
+    bus.resetStatistics();
+
+    const spi_bus::Statistics statistics(bus.getStatistics());
+    EXPECT_EQ(0u, statistics.acquisitions);
+    EXPECT_EQ(0u, statistics.hold_time_ns);
+    EXPECT_EQ(0u, statistics.max_hold_time_ns);
+}
+
+TEST_F(MockBus, digitalWritePorts$WHENDevicesOnTheBusAreDrivenFromThreadsTHENFramesNeverInterleave) {
+    spi_bus bus;
+    mcp23s17 gpio_a(mcp23s17::HardwareAddress::HW_ADDR_1, &bus);
+    mcp23s17 gpio_b(mcp23s17::HardwareAddress::HW_ADDR_2, &bus);
+    gpio_a.pinModes(0xFFFF, mcp23s17::PinMode::OUTPUT);
+    gpio_b.pinModes(0xFFFF, mcp23s17::PinMode::OUTPUT);
+    const size_t first_frame_a(_chip_a->frames.size());
+    const size_t first_frame_b(_chip_b->frames.size());
+
+    auto count = [](mcp23s17 & gpio_x_, const uint16_t seed_){
+        for ( uint16_t i = 1 ; i <= 500 ; ++i ) { gpio_x_.digitalWritePorts(static_cast<uint16_t>((seed_ ^ i) | 0x8080)); }
+    };
+    std::thread thread_a(count, std::ref(gpio_a), 0x0000);
+    std::thread thread_b(count, std::ref(gpio_b), 0x5A5A);
+    thread_a.join();
+    thread_b.join();
+
+    expectWellFormedWrites(*_chip_a, first_frame_a);
+    expectWellFormedWrites(*_chip_b, first_frame_b);
+    EXPECT_EQ(gpio_a.getLatchValues(), _chip_a->getOutputs());
+    EXPECT_EQ(gpio_b.getLatchValues(), _chip_b->getOutputs());
+    EXPECT_LE(1000u, bus.getStatistics().acquisitions);
+}
+
+TEST_F(MockBus, submit$WHENTheTransportSharesTheBusTHENItsFramesNeverInterleaveWithBlockingFrames) {
+    spi_bus bus;
+    thread_transport transport(&bus);
+    mcp23s17_async gpio_a(mcp23s17::HardwareAddress::HW_ADDR_1, transport, &bus);
+    mcp23s17 gpio_b(mcp23s17::HardwareAddress::HW_ADDR_2, &bus);
+    mcp23s17_async::Operation operations[4];
+    gpio_a.pinModes(0xFFFF, mcp23s17::PinMode::OUTPUT);
+    gpio_b.pinModes(0xFFFF, mcp23s17::PinMode::OUTPUT);
+    const size_t first_frame_a(_chip_a->frames.size());
+    const size_t first_frame_b(_chip_b->frames.size());
+
+    std::thread blocking([&gpio_b](){
+        for ( uint16_t i = 1 ; i <= 500 ; ++i ) { gpio_b.digitalWritePorts(static_cast<uint16_t>(i | 0x8080)); }
+    });
+    for ( uint16_t i = 1 ; i <= 500 ; ++i ) {
+        mcp23s17_async::Operation & operation(operations[i % 4]);
+        while ( !operation.isComplete() ) { std::this_thread::yield(); }
+        gpio_a.digitalWritePortsAsync(operation, static_cast<uint16_t>(~i | 0x8080));
+    }
+    blocking.join();
+    transport.flush();
+
+    expectWellFormedWrites(*_chip_a, first_frame_a);
+    expectWellFormedWrites(*_chip_b, first_frame_b);
+    EXPECT_EQ(gpio_a.getLatchValues(), _chip_a->getOutputs());
+    EXPECT_EQ(gpio_b.getLatchValues(), _chip_b->getOutputs());
+}
+
+} // namespace
+
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
@@ -0,0 +1,341 @@
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+#include <thread>
+#include <vector>
+
+#include "../mcp23s17_async.h"
+#include "../spidev_transport.h"
+#include "MOCK_mcp23s17.h"
+#include "MOCK_wiring.h"
+
+#if defined(MCP23S17_HOST) && defined(__linux__)
+
+namespace {
+
+/// \brief Stand-in for the spidev driver, which plays each message on the mock bus
+struct MOCK_spidev {
+    static unsigned int messages;
+    static bool fail;
+    static std::vector<struct spi_ioc_transfer> transfers;
+
+    static
+    int
+    ioctl (
+        int,
+        unsigned long request_,
+        void * argument_
+    ) {
+        // Only SPI_IOC_MESSAGE(n) is played, configuration requests succeed
+        if ( SPI_IOC_MAGIC != _IOC_TYPE(request_) || 0 != _IOC_NR(request_) ) { return 0; }
+        ++messages;
+        if ( fail ) { return -1; }
+
+        const size_t count(_IOC_SIZE(request_) / sizeof(struct spi_ioc_transfer));
+        struct spi_ioc_transfer * const message(static_cast<struct spi_ioc_transfer *>(argument_));
+        transfers.assign(message, (message + count));
+
+        ::digitalWrite(SS, LOW);
+        for ( size_t i = 0 ; i < count ; ++i ) {
+            const uint8_t * const tx(reinterpret_cast<const uint8_t *>(message[i].tx_buf));
+            uint8_t * const rx(reinterpret_cast<uint8_t *>(message[i].rx_buf));
+            for ( size_t j = 0 ; j < message[i].len ; ++j ) { rx[j] = ::SPI.transfer(tx[j]); }
+            if ( message[i].cs_change && (i + 1) < count ) {
+                ::digitalWrite(SS, HIGH);
+                ::digitalWrite(SS, LOW);
+            }
+        }
+        ::digitalWrite(SS, HIGH);
+
+        return static_cast<int>(count);
+    }
+
+    static
+    void
+    reset (
+        void
+    ) {
+        messages = 0;
+        fail = false;
+        transfers.clear();
+    }
+};
+
+unsigned int MOCK_spidev::messages = 0;
+bool MOCK_spidev::fail = false;
+std::vector<struct spi_ioc_transfer> MOCK_spidev::transfers;
+
+unsigned int isr_calls = 0;
+
+void
+countingIsr (
+    void
+) {
+    ++isr_calls;
+}
+
+class MockSpidev : public ::testing::Test {
+  protected:
+    MOCK_mcp23s17 * _chip;
+
+    MockSpidev (
+        void
+    ) :
+        _chip(nullptr)
+    {}
+
+    void SetUp (void) {
+        MOCK::initMockState();
+        MOCK_spidev::reset();
+        isr_calls = 0;
+        _chip = new MOCK_mcp23s17(2);
+    }
+    void TearDown (void) {
+        delete _chip;
+    }
+};
+
+TEST_F(MockSpidev, flush$WHENSeveralFramesAreBatchedTHENTheyAreExchangedInASingleIoctl) {
+    spidev_transport transport(3, 10000000, MOCK_spidev::ioctl);
+    mcp23s17_async gpio_x(mcp23s17::HardwareAddress::HW_ADDR_2, transport);
+    mcp23s17_async::Operation operations[3];
+    gpio_x.pinModes(0xFFFF, mcp23s17::PinMode::OUTPUT);
+    const uint32_t message_count(transport.getMessageCount());
+
+    MOCK_spidev::messages = 0;
+    _chip->frames.clear();
+    EXPECT_TRUE(gpio_x.digitalWritePortsAsync(operations[0], 0x0001));
+    EXPECT_TRUE(gpio_x.digitalWritePortsAsync(operations[1], 0x0100));
+    EXPECT_TRUE(gpio_x.digitalWritePortsAsync(operations[2], 0x0102));
+    EXPECT_EQ(0u, MOCK_spidev::messages);
+    EXPECT_FALSE(operations[2].isComplete());
+
+    EXPECT_TRUE(transport.flush());
+    EXPECT_EQ(1u, MOCK_spidev::messages);
+    EXPECT_EQ((message_count + 1), transport.getMessageCount());
+    EXPECT_EQ(3u, _chip->frames.size());
+    EXPECT_TRUE(operations[2].isComplete());
+    EXPECT_EQ(0x0102, _chip->getOutputs());
+}
+
+TEST_F(MockSpidev, flush$WHENSeveralFramesAreBatchedTHENChipSelectIsReleasedBetweenFramesOnly) {
+    spidev_transport transport(3, 4000000, MOCK_spidev::ioctl);
+    mcp23s17_async gpio_x(mcp23s17::HardwareAddress::HW_ADDR_2, transport);
+    mcp23s17_async::Operation operations[3];
+    gpio_x.pinModes(0xFFFF, mcp23s17::PinMode::OUTPUT);
+
+    gpio_x.digitalWritePortsAsync(operations[0], 0x0001);
+    gpio_x.digitalWritePortsAsync(operations[1], 0x0003);
+    gpio_x.digitalWritePortsAsync(operations[2], 0x0007);
+    transport.flush();
+
+    ASSERT_EQ(3u, MOCK_spidev::transfers.size());
+    EXPECT_EQ(1, MOCK_spidev::transfers[0].cs_change);
+    EXPECT_EQ(1, MOCK_spidev::transfers[1].cs_change);
+    EXPECT_EQ(0, MOCK_spidev::transfers[2].cs_change);
+    EXPECT_EQ(3u, MOCK_spidev::transfers[0].len);
+    EXPECT_EQ(4000000u, MOCK_spidev::transfers[0].speed_hz);
+    EXPECT_EQ(8, MOCK_spidev::transfers[0].bits_per_word);
+}
+
+TEST_F(MockSpidev, flush$WHENAReadIsBatchedTHENTheReceivedBytesCompleteTheOperation) {
+    spidev_transport transport(3, 10000000, MOCK_spidev::ioctl);
+    mcp23s17_async gpio_x(mcp23s17::HardwareAddress::HW_ADDR_2, transport);
+    mcp23s17_async::Operation operation;
+
+    _chip->setInputs(0xBEEF);
+    gpio_x.digitalReadPortsAsync(operation);
+    transport.poll();
+
+    EXPECT_TRUE(operation.isComplete());
+    EXPECT_EQ(0xBEEF, operation.getPortValues());
+}
+
+TEST_F(MockSpidev, submit$WHENTheBatchIsFullTHENItIsExchangedBeforeTheNextFrameIsBatched) {
+    spidev_transport transport(3, 10000000, MOCK_spidev::ioctl);
+    mcp23s17_async gpio_x(mcp23s17::HardwareAddress::HW_ADDR_2, transport);
+    mcp23s17_async::Operation operations[spidev_transport::MAX_BATCH + 1];
+    gpio_x.pinModes(0xFFFF, mcp23s17::PinMode::OUTPUT);
+
+    MOCK_spidev::messages = 0;
+    for ( uint16_t i = 0 ; i <= spidev_transport::MAX_BATCH ; ++i ) {
+        EXPECT_TRUE(gpio_x.digitalWritePortsAsync(operations[i], static_cast<uint16_t>(i + 1)));
+    }
+    EXPECT_EQ(1u, MOCK_spidev::messages);
+    EXPECT_EQ(static_cast<uint16_t>(spidev_transport::MAX_BATCH), _chip->getOutputs());
+    EXPECT_FALSE(operations[0].isComplete());
+
+    transport.flush();
+    EXPECT_EQ(2u, MOCK_spidev::messages);
+    EXPECT_TRUE(operations[spidev_transport::MAX_BATCH].isComplete());
+    EXPECT_EQ((spidev_transport::MAX_BATCH + 1), _chip->getOutputs());
+}
+
+TEST_F(MockSpidev, submit$WHENTheQueueIsFullTHENTheFrameIsRefusedUntilFlushed) {
+    spidev_transport transport(3, 10000000, MOCK_spidev::ioctl);
+    mcp23s17_async gpio_x(mcp23s17::HardwareAddress::HW_ADDR_2, transport);
+    mcp23s17_async::Operation operations[spidev_transport::MAX_QUEUE + 1];
+
+    for ( size_t i = 0 ; i < spidev_transport::MAX_QUEUE ; ++i ) {
+        EXPECT_TRUE(gpio_x.digitalReadPortsAsync(operations[i]));
+    }
+    EXPECT_FALSE(gpio_x.digitalReadPortsAsync(operations[spidev_transport::MAX_QUEUE]));
+
+    transport.flush();
+    EXPECT_TRUE(operations[spidev_transport::MAX_QUEUE - 1].isComplete());
+    EXPECT_TRUE(gpio_x.digitalReadPortsAsync(operations[spidev_transport::MAX_QUEUE]));
+}
+
+TEST_F(MockSpidev, flush$WHENTheIoctlFailsTHENTheFramesAreCompletedAndTheErrorIsCounted) {
+    spidev_transport transport(3, 10000000, MOCK_spidev::ioctl);
+    mcp23s17_async gpio_x(mcp23s17::HardwareAddress::HW_ADDR_2, transport);
+    mcp23s17_async::Operation operation;
+
+    MOCK_spidev::fail = true;
+    _chip->setInputs(0xBEEF);
+    gpio_x.digitalReadPortsAsync(operation);
+    EXPECT_FALSE(transport.flush());
+
+    EXPECT_TRUE(operation.isComplete());
+    EXPECT_TRUE(operation.isFailed());
+    EXPECT_EQ(0x0000, operation.getPortValues());
+    EXPECT_EQ(1u, transport.getErrorCount());
+}
+
+TEST_F(MockSpidev, flush$WHENTheIoctlFailsTHENNoInterruptServiceRoutineIsInvoked) {
+    spidev_transport transport(3, 10000000, MOCK_spidev::ioctl);
+    mcp23s17_async gpio_x(mcp23s17::HardwareAddress::HW_ADDR_2, transport);
+    mcp23s17_async::Operation operation;
+    gpio_x.attachInterrupt(1, countingIsr, mcp23s17::InterruptMode::CHANGE);
+
+    // The bytes echoed by a failed ioctl would decode as INTF = 0x0E0E
+    MOCK_spidev::fail = true;
+    gpio_x.serviceInterruptsAsync(operation);
+    EXPECT_FALSE(transport.flush());
+
+    EXPECT_TRUE(operation.isFailed());
+    EXPECT_EQ(0x0000, operation.getInterruptSnapshot().flags);
+    EXPECT_EQ(0x0000, gpio_x.getInterruptSnapshot().flags);
+    EXPECT_EQ(0u, isr_calls);
+}
+
+TEST_F(MockSpidev, serviceInterrupts$WHENTheIoctlFailsTHENNoInterruptServiceRoutineIsInvoked) {
+    spidev_transport transport(3, 10000000, MOCK_spidev::ioctl);
+    mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_2, transport);
+    gpio_x.attachInterrupt(1, countingIsr, mcp23s17::InterruptMode::CHANGE);
+
+    MOCK_spidev::fail = true;
+    EXPECT_EQ(0x0000, gpio_x.serviceInterrupts().flags);
+    EXPECT_EQ(0u, isr_calls);
+}
+
+TEST_F(MockSpidev, flush$WHENAWriteFailsTHENTheNextWriteSendsBothPorts) {
+    spidev_transport transport(3, 10000000, MOCK_spidev::ioctl);
+    mcp23s17_async gpio_x(mcp23s17::HardwareAddress::HW_ADDR_2, transport);
+    mcp23s17_async::Operation operation;
+    gpio_x.pinModes(0xFFFF, mcp23s17::PinMode::OUTPUT);
+
+    MOCK_spidev::fail = true;
+    gpio_x.digitalWritePortsAsync(operation, 0x0001);
+    transport.flush();
+    EXPECT_TRUE(operation.isFailed());
+
+    // The cache already holds the value, but the chip does not
+    MOCK_spidev::fail = false;
+    _chip->frames.clear();
+    EXPECT_TRUE(gpio_x.digitalWritePortsAsync(operation, 0x0001));
+    transport.flush();
+
+    EXPECT_FALSE(operation.isFailed());
+    ASSERT_EQ(1u, _chip->frames.size());
+    EXPECT_EQ(4u, _chip->frames[0].size());
+    EXPECT_EQ(0x0001, _chip->getOutputs());
+}
+
+TEST_F(MockSpidev, mcp23s17$WHENConstructedOverTheTransportTHENSPIIsNeverTouched) {
+    spidev_transport transport(3, 10000000, MOCK_spidev::ioctl);
+    mcp23s17 gpio_x(mcp23s17::HardwareAddress::HW_ADDR_2, transport);
+    const uint8_t samples[] = { 0x01, 0x02 };
+
+    EXPECT_FALSE(SPI._has_begun);
+    EXPECT_EQ(static_cast<uint8_t>(MOCK_mcp23s17::HAEN), _chip->getRegister(MOCK_mcp23s17::IOCONA));
+
+    gpio_x.pinModes(0xFFFF, mcp23s17::PinMode::OUTPUT);
+    gpio_x.digitalWritePorts(0x1234);
+    EXPECT_EQ(0x1234, _chip->getOutputs());
+
+    // Streams hold chip select across a session, which spidev cannot express
+    MOCK_spidev::messages = 0;
+    EXPECT_FALSE(gpio_x.isStreamCapable());
+    gpio_x.digitalWriteStream(mcp23s17::Port::A, samples, sizeof(samples));
+    EXPECT_EQ(0u, MOCK_spidev::messages);
+    EXPECT_EQ(0x1234, _chip->getOutputs());
+}
+
+TEST_F(MockSpidev, transfer$WHENFramesAreBatchedTHENTheyAreExchangedFirst) {
+    spidev_transport transport(3, 10000000, MOCK_spidev::ioctl);
+    mcp23s17_async gpio_x(mcp23s17::HardwareAddress::HW_ADDR_2, transport);
+    mcp23s17_async::Operation operation;
+    gpio_x.pinModes(0xFFFF, mcp23s17::PinMode::OUTPUT);
+
+    _chip->frames.clear();
+    gpio_x.digitalWritePortsAsync(operation, 0x0001);
+    gpio_x.digitalWritePorts(0x0101);
+
+    ASSERT_EQ(2u, _chip->frames.size());
+    EXPECT_EQ(0x01, _chip->frames[0][2]);
+    EXPECT_EQ(static_cast<uint8_t>(MOCK_mcp23s17::GPIOB_), _chip->frames[1][1]);
+    EXPECT_EQ(0x0101, _chip->getOutputs());
+    EXPECT_FALSE(operation.isComplete());
+
+    transport.flush();
+    EXPECT_TRUE(operation.isComplete());
+}
+
+TEST_F(MockSpidev, flush$WHENSeveralThreadsSubmitAndFlushTHENEveryOperationCompletes) {
+    spidev_transport transport(3, 10000000, MOCK_spidev::ioctl);
+    MOCK_mcp23s17 chip_3(3);
+    mcp23s17_async gpio_2(mcp23s17::HardwareAddress::HW_ADDR_2, transport);
+    mcp23s17_async gpio_3(mcp23s17::HardwareAddress::HW_ADDR_3, transport);
+    gpio_2.pinModes(0xFFFF, mcp23s17::PinMode::OUTPUT);
+    gpio_3.pinModes(0xFFFF, mcp23s17::PinMode::OUTPUT);
+
+    const auto writer = [&transport](mcp23s17_async * gpio_x_){
+        mcp23s17_async::Operation operation;
+        for ( uint16_t i = 1 ; i <= 200 ; ++i ) {
+            while ( !gpio_x_->digitalWritePortsAsync(operation, i) ) { transport.flush(); }
+            transport.flush();
+        }
+        while ( !operation.isComplete() ) { transport.flush(); }
+    };
+    std::thread thread_2(writer, &gpio_2);
+    std::thread thread_3(writer, &gpio_3);
+    thread_2.join();
+    thread_3.join();
+
+    EXPECT_EQ(200, _chip->getOutputs());
+    EXPECT_EQ(200, chip_3.getOutputs());
+}
+
+TEST_F(MockSpidev, flush$WHENNothingIsBatchedTHENNoIoctlIsIssued) {
+    spidev_transport transport(3, 10000000, MOCK_spidev::ioctl);
+
+    EXPECT_TRUE(transport.flush());
+    EXPECT_EQ(0u, MOCK_spidev::messages);
+}
+
+TEST(Spidev, spidev_transport$WHENTheDeviceCannotBeOpenedTHENFramesAreRefused) {
+    spidev_transport transport("/nonexistent/spidev0.0");
+    spi_transport::Frame frame{ { 0 }, 1, nullptr, nullptr, false };
+
+    EXPECT_FALSE(transport.isOpen());
+    EXPECT_FALSE(transport.submit(frame));
+}
+
+} // namespace
+
+#endif // MCP23S17_HOST && __linux__
+
+/* Created and copyrighted by Zachary J. Fields. Offered as open source under the MIT License (MIT). */